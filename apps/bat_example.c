@@ -15,7 +15,7 @@
 static GeneratorState GeneratorState_create_x(const GeneratorInfo *gi,
     const CallerAPI *intf)
 {
-    GeneratorState obj;
+    GeneratorState obj = {0};
     obj.gi = gi;
     obj.state = gi->create(gi, intf);
     obj.intf = intf;
@@ -48,6 +48,7 @@ void print_help(void)
     "generator_lib: name of dynamic library with PRNG or special mode name.\n"
     "  Special modes names:\n"
     "  - stdin32, stdin64  Get random sequence from stdin\n"
+    "  - file32:path, file64:path  Get random sequence from the binary file\n"
     "  - list              Print list of tests in the battery\n"
     "Optional keys\n"
     "  --filter=name Apply pre-defined filter to the generator output\n"
@@ -59,10 +60,27 @@ void print_help(void)
     "                   generation.\n"
     "  --maxlen_log2=n  Limit the binary output to the 2^n floats (12 <= n <= 63)\n"
     "  --report-brief Show only failures in the report\n"
+    "  --report-format=fmt Save the machine-readable report (json, csv)\n"
+    "  --report-file=name  File for the report (default: smokerand_report.json/csv)\n"
     "  --seed=data Use the user supplied string (data) as a seed\n"
     "  --testid=id     Run only the test with the given numeric id\n"
     "  --testname=name Run only the test with the given name\n"
+    "  --mem-limit=size Memory budget for simultaneously running tests in\n"
+    "              the multithreaded mode, MiB (or with K, M, G suffix); the default\n"
+    "              is 3/4 of physical RAM\n"
     "  --nthreads  Run battery in multithreaded mode (default number of threads)\n"
+    "  --pin-threads Pin worker threads to CPU cores interleaved between NUMA\n"
+    "              nodes; test buffers are allocated on the local node\n"
+    "  --pipeline  Run simple stream tests (frequency, gap, Hamming weights, mod3)\n"
+    "              simultaneously on the same generator output; useful for slow\n"
+    "              generators but gives different p-values; at most n tests\n"
+    "              from --threads=n share one pass of the generator\n"
+    "  --progressive=n  Run tests with 2^n times smaller samples, then double\n"
+    "              them until the battery sizes; stop after the first failure\n"
+    "  --fail-pvalue=p  Failure p-value threshold for --progressive (default 1e-10)\n"
+    "  --split=n   Split samples of additive tests (monobit, mod3, gap, sumcollector,\n"
+    "              unit sphere) into n substreams processed in parallel by idle\n"
+    "              worker threads (see --threads)\n"
     "  --threads=n Run battery in multithreaded mode using n threads\n"
     "\n";
 
@@ -103,13 +121,21 @@ GeneratorFilter GeneratorFilter_from_name(const char *name)
 
 typedef struct {
     unsigned int nthreads; ///< From `--threads` or `--nthreads` keys.
-    unsigned int nthreads_from_seed; ///< From base64 seed (`seed=_` key)
     unsigned int testid; ///< Test identifier obtained from the `--testid` key
     const char *testname; ///< Test name obtained from the `--testname` key
     const char *bat_param;
     unsigned int maxlen_log2; ///< log2(len) for stdout length in bytes
     GeneratorFilter filter;
     ReportType report_type;
+    ReportFormat report_format; ///< From the `--report-format` key
+    const char *report_file; ///< From the `--report-file` key
+    int pipeline; ///< From the `--pipeline` key
+    unsigned int progressive; ///< From the `--progressive` key
+    double fail_pvalue; ///< From the `--fail-pvalue` key
+    unsigned int nsplits; ///< From the `--split` key
+    size_t mem_limit; ///< From the `--mem-limit` key, bytes (0 - default)
+    int pin_threads; ///< From the `--pin-threads` key
+    int static_schedule; ///< 1 - fixed tests for each thread (shared input)
 } SmokeRandSettings;
 
 /**
@@ -179,6 +205,8 @@ static BatteryExitCode process_argument(SmokeRandSettings *obj,
 DEFINE_NUMARG_CALLBACK(nthreads, "nthreads", argval > 0)
 DEFINE_NUMARG_CALLBACK(testid, "testid", argval > 0)
 DEFINE_NUMARG_CALLBACK(maxlen_log2, "maxlen_log2", 12 <= argval || argval <= 63)
+DEFINE_NUMARG_CALLBACK(progressive, "progressive", argval > 0 && argval <= 20)
+DEFINE_NUMARG_CALLBACK(nsplits, "split", argval > 0 && argval <= NTHREADS_MAX)
 
 
 static BatteryExitCode SmokeRandSettings_numarg_load(SmokeRandSettings *obj,
@@ -188,6 +216,8 @@ static BatteryExitCode SmokeRandSettings_numarg_load(SmokeRandSettings *obj,
         {"nthreads", nthreads_callback},
         {"testid",   testid_callback},
         {"maxlen_log2", maxlen_log2_callback},
+        {"progressive", progressive_callback},
+        {"split",       nsplits_callback},
         {NULL, NULL}
     };
     return process_argument(obj, args, argname, argvalue);
@@ -206,6 +236,32 @@ static inline int char_to_hex_digit(char c)
     }
 }
 
+/**
+ * @brief Converts the memory size string (e.g. `512`, `512M`, `16G`)
+ * to bytes. The number without suffix is in MiB.
+ * @return Number of bytes or 0 in the case of invalid input.
+ */
+static size_t parse_mem_size(const char *str)
+{
+    char *endptr;
+    const unsigned long long val = strtoull(str, &endptr, 10);
+    unsigned int shl;
+    if (endptr == str || val == 0) {
+        return 0;
+    }
+    switch (*endptr) {
+    case 'K': case 'k': shl = 10; endptr++; break;
+    case 'G': case 'g': shl = 30; endptr++; break;
+    case 'M': case 'm': shl = 20; endptr++; break;
+    case '\0': shl = 20; break;
+    default: return 0;
+    }
+    if (*endptr != '\0' || val > (SIZE_MAX >> shl)) {
+        return 0;
+    }
+    return (size_t) (val << shl);
+}
+
 static BatteryExitCode SmokeRandSettings_txtarg_load(SmokeRandSettings *obj,
     const char *argname, const char *argvalue)
 {
@@ -235,7 +291,10 @@ static BatteryExitCode SmokeRandSettings_txtarg_load(SmokeRandSettings *obj,
                 fprintf(stderr, "Invalid format of number of threads in the _ seed\n");
                 return BATTERY_ERROR;
             }
-            obj->nthreads_from_seed = (unsigned int) (d1 * 16 + d0);
+            if (d1 != 0 || d0 != 0) {
+                fprintf(stderr, "Warning: number of threads in the _ seed is "
+                    "ignored (results don't depend on it)\n");
+            }
             if (!set_entropy_base64_seed(argvalue + 4)) {
                 return BATTERY_ERROR;
             }
@@ -246,6 +305,36 @@ static BatteryExitCode SmokeRandSettings_txtarg_load(SmokeRandSettings *obj,
     } else if (!strcmp(argname, "testname")) {
         obj->testname = argvalue;
         return BATTERY_PASSED;
+    } else if (!strcmp(argname, "report-format")) {
+        if (!strcmp(argvalue, "json")) {
+            obj->report_format = REPORT_FORMAT_JSON;
+        } else if (!strcmp(argvalue, "csv")) {
+            obj->report_format = REPORT_FORMAT_CSV;
+        } else if (!strcmp(argvalue, "text")) {
+            obj->report_format = REPORT_FORMAT_TEXT;
+        } else {
+            fprintf(stderr, "Unknown report format %s\n", argvalue);
+            return BATTERY_ERROR;
+        }
+        return BATTERY_PASSED;
+    } else if (!strcmp(argname, "report-file")) {
+        obj->report_file = argvalue;
+        return BATTERY_PASSED;
+    } else if (!strcmp(argname, "fail-pvalue")) {
+        char *endptr;
+        obj->fail_pvalue = strtod(argvalue, &endptr);
+        if (*endptr != '\0' || !(obj->fail_pvalue > 0.0 && obj->fail_pvalue < 0.5)) {
+            fprintf(stderr, "Invalid value of fail-pvalue: %s\n", argvalue);
+            return BATTERY_ERROR;
+        }
+        return BATTERY_PASSED;
+    } else if (!strcmp(argname, "mem-limit")) {
+        obj->mem_limit = parse_mem_size(argvalue);
+        if (obj->mem_limit == 0) {
+            fprintf(stderr, "Invalid value of mem-limit: %s\n", argvalue);
+            return BATTERY_ERROR;
+        }
+        return BATTERY_PASSED;
     } else {
         return BATTERY_FAILED;
     }
@@ -269,8 +358,16 @@ void SmokeRandSettings_init(SmokeRandSettings *obj)
     obj->testid             = TESTS_ALL;
     obj->testname           = NULL;
     obj->report_type        = REPORT_FULL;
+    obj->report_format      = REPORT_FORMAT_TEXT;
+    obj->report_file        = NULL;
+    obj->pipeline           = 0;
+    obj->progressive        = 0;
+    obj->fail_pvalue        = PVALUE_FAIL_DEFAULT;
+    obj->nsplits            = 1;
+    obj->mem_limit          = 0;
+    obj->pin_threads        = 0;
+    obj->static_schedule    = 0;
     obj->bat_param          = NULL;
-    obj->nthreads_from_seed = 0;
     obj->filter             = FILTER_NONE;
     obj->maxlen_log2        = 0;
 }
@@ -299,6 +396,14 @@ BatteryExitCode SmokeRandSettings_load(SmokeRandSettings *obj, int argc, char *a
             obj->report_type = REPORT_BRIEF;
             continue;
         }
+        if (!strcmp(argv[i], "--pipeline")) {
+            obj->pipeline = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "--pin-threads")) {
+            obj->pin_threads = 1;
+            continue;
+        }
         if (len < 3 || (argv[i][0] != '-' || argv[i][1] != '-') || eqpos == NULL) {
             fprintf(stderr, "Argument '%s' should have --argname=argval layout\n", argv[i]);
             return BATTERY_ERROR;
@@ -320,9 +425,6 @@ BatteryExitCode SmokeRandSettings_load(SmokeRandSettings *obj, int argc, char *a
         return BATTERY_ERROR;
 
     }
-    if (obj->nthreads_from_seed != 0) {
-        obj->nthreads = obj->nthreads_from_seed;
-    }
     return BATTERY_PASSED;
 }
 
@@ -437,6 +539,15 @@ BatteryExitCode run_battery(const char *battery_name, GeneratorInfo *gi,
     bat_opts.nthreads    = opts->nthreads;
     bat_opts.report_type = opts->report_type;
     bat_opts.param       = (opts->bat_param != NULL) ? opts->bat_param : "";
+    bat_opts.report_format = opts->report_format;
+    bat_opts.report_file   = opts->report_file;
+    bat_opts.pipeline      = opts->pipeline;
+    bat_opts.progressive   = opts->progressive;
+    bat_opts.fail_pvalue   = opts->fail_pvalue;
+    bat_opts.nsplits       = opts->nsplits;
+    bat_opts.mem_limit     = opts->mem_limit;
+    bat_opts.pin_threads   = opts->pin_threads;
+    bat_opts.static_schedule = opts->static_schedule;
 
 
     if (strlen(battery_name) > 1 &&
@@ -598,19 +709,16 @@ int main(int argc, char *argv[])
     if (SmokeRandSettings_load(&opts, argc, argv)) {
         return BATTERY_ERROR;
     }
-    const int is_stdin32 = !strcmp(generator_lib, "stdin32");
-    const int is_stdin64 = !strcmp(generator_lib, "stdin64");
+    const int is_file32 = !strncmp(generator_lib, "file32:", 7);
+    const int is_file64 = !strncmp(generator_lib, "file64:", 7);
+    const int is_stdin32 = !strcmp(generator_lib, "stdin32") || is_file32;
+    const int is_stdin64 = !strcmp(generator_lib, "stdin64") || is_file64;
     const int is_stdout =
         !strcmp(battery_name, "stdout") ||
         !strcmp(battery_name, "stdoutfl") ||
         !strcmp(battery_name, "stdoutflx") ;
     set_use_stderr_for_printf(is_stdout); // Messages mustn't be in PRNG output
 
-    if (opts.nthreads > 1 && (is_stdin32 || is_stdin64)) {
-        fprintf(stderr, "Multithreading is not supported for stdin32/stdin64\n");
-        return BATTERY_ERROR;
-    }
-
     if (!entfuncs_test()) {
         fprintf(stderr, "Seed generator self-test failed\n");
         return BATTERY_ERROR;
@@ -621,21 +729,46 @@ int main(int argc, char *argv[])
     }
 
     if (is_stdin32 || is_stdin64) {
-        CallerAPI intf = CallerAPI_init();
+        CallerAPI intf = (opts.nthreads == 1 && !opts.pipeline && opts.nsplits == 1) ?
+            CallerAPI_init() : CallerAPI_init_mthr();
         GeneratorInfo stdin_gi;
-        if (is_stdin32) {
-            stdin_gi = StdinCollector_get_info(stdin_collector_32bit);
+        const StdinCollectorType type = (is_stdin32) ?
+            stdin_collector_32bit : stdin_collector_64bit;
+        if (is_file32 || is_file64) {
+            stdin_gi = StdinCollector_get_file_info(type, generator_lib + 7);
         } else {
-            stdin_gi = StdinCollector_get_info(stdin_collector_64bit);
+            stdin_gi = StdinCollector_get_info(type);
+        }
+        if (opts.nsplits > 1) {
+            fprintf(stderr, "The split/merge mode is not supported for stdin and files\n");
+            CallerAPI_free();
+            return BATTERY_ERROR;
         }
         GeneratorInfo_print(&stdin_gi, is_stdout);
+        // Each worker thread reads its own lane of the input, tests are
+        // assigned to threads in advance: results don't depend on timing.
+        const int is_single_test = opts.testid != TESTS_ALL || opts.testname != NULL;
+        const unsigned int nlanes = is_single_test ? 1 : opts.nthreads;
+        const unsigned int nlanes_stream = (opts.pipeline || opts.progressive) ?
+            1 : nlanes;
+        if (StdinCollector_open(nlanes, nlanes_stream) < nlanes) {
+            fprintf(stderr, "Note: the input stream is read by one thread "
+                "in the pipelined and progressive modes\n");
+            opts.nthreads = 1;
+        }
+        opts.static_schedule = 1;
+        if (!is_stdout) {
+            StdinCollector_print_source_info();
+        }
         BatteryExitCode ans = run_battery(battery_name, &stdin_gi, &intf, &opts);
         StdinCollector_print_report();
+        StdinCollector_close();
         CallerAPI_free();
         return ans;
     } else {
         GeneratorInfo filter_gen;
-        CallerAPI intf = (opts.nthreads == 1) ? CallerAPI_init() : CallerAPI_init_mthr();
+        CallerAPI intf = (opts.nthreads == 1 && !opts.pipeline && opts.nsplits == 1) ?
+            CallerAPI_init() : CallerAPI_init_mthr();
         GeneratorModule mod = GeneratorModule_load(generator_lib, &intf);
         if (!mod.valid) {
             CallerAPI_free();
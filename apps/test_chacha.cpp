@@ -38,7 +38,7 @@ static uint64_t get_bits(void *state)
 
 int main()
 {
-    BatteryOptions opts;
+    BatteryOptions opts{};
     opts.test.id     = TESTS_ALL;
     opts.test.name   = nullptr;
     opts.nthreads    = 8;
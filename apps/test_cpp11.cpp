@@ -49,13 +49,17 @@ template <class G> GeneratorWrapper<G>::GeneratorWrapper()
     this->self_test = nullptr;
     this->get_sum = nullptr;
     this->parent = NULL;
+    this->fill = nullptr;
+    this->jump = nullptr;
+    this->seek = nullptr;
+    this->discard = nullptr;
 }
 
 
 
 int main()
 {                                     
-    BatteryOptions bat_opts;
+    BatteryOptions bat_opts{};
     bat_opts.test.id     = TESTS_ALL;
     bat_opts.test.name   = nullptr;
     bat_opts.nthreads    = 4;
@@ -15,7 +15,10 @@
  */
 
 #include "smokerand/core.h"
+#include "smokerand/coretests.h"
+#include "smokerand/hwtests.h"
 #include "smokerand/specfuncs.h"
+#include "smokerand/lineardep.h"
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -132,6 +135,11 @@ int test_radixsort32()
 }
 
 
+static void radixsort64_inplace_mt_wrap(uint64_t *x, size_t len)
+{
+    radixsort64_inplace_mt(x, len, 4);
+}
+
 int test_radixsort64()
 {
     const size_t len = 1U << 25;
@@ -139,6 +147,7 @@ int test_radixsort64()
     int is_ok = 1;
     const SortMethodInfo methods[] = {
         {"radixsort64_inplace", radixsort64_inplace},
+        {"radixsort64_inplace_mt", radixsort64_inplace_mt_wrap},
         {"quicksort64", quicksort64},
         {"qsort64", qsort64_wrap},        
         {NULL, NULL}
@@ -173,6 +182,84 @@ int test_radixsort64()
 }
 
 
+/**
+ * @brief Reference (slow) implementation of Berlekamp-Massey algorithm
+ * that stores one bit per byte.
+ */
+static size_t berlekamp_massey_ref(const uint8_t *s, size_t n)
+{
+    size_t L = 0;
+    long m = -1;
+    uint8_t *C = calloc(n + 1, sizeof(uint8_t));
+    uint8_t *B = calloc(n + 1, sizeof(uint8_t));
+    uint8_t *T = calloc(n + 1, sizeof(uint8_t));
+    C[0] = 1; B[0] = 1;
+    for (size_t N = 0; N < n; N++) {
+        uint8_t d = s[N];
+        for (size_t i = 1; i <= L; i++) {
+            d ^= C[i] & s[N - i];
+        }
+        if (d == 1) {
+            memcpy(T, C, n + 1);
+            for (size_t i = 0; i + (size_t) ((long) N - m) <= n; i++) {
+                C[i + (size_t) ((long) N - m)] ^= B[i];
+            }
+            if (2*L <= N) {
+                L = N + 1 - L;
+                m = (long) N;
+                memcpy(B, T, n + 1);
+            }
+        }
+    }
+    free(C); free(B); free(T);
+    return L;
+}
+
+/**
+ * @brief Compares the bit-packed Berlekamp-Massey algorithm with
+ * the reference implementation. Random sequences and sequences from
+ * the lowest bit of LCG modulo 2^64 (low linear complexity) are used.
+ */
+int test_berlekamp_massey()
+{
+    static const size_t lengths[] = {1, 2, 63, 64, 65, 127, 128, 129,
+        1000, 1001, 4096, 5003, 0};
+    int is_ok = 1;
+    uint64_t seed = (uint64_t) time(NULL);
+    printf("----- test_berlekamp_massey -----\n");
+    printf("%6s %6s %6s %6s\n", "n", "type", "L", "Lref");
+    for (const size_t *n_ptr = lengths; *n_ptr != 0; n_ptr++) {
+        size_t n = *n_ptr;
+        uint8_t *s = calloc(n, sizeof(uint8_t));
+        uint64_t *s_packed = calloc(n / 64 + 1, sizeof(uint64_t));
+        for (int type = 0; type < 2; type++) {
+            uint64_t lcg = seed;
+            memset(s_packed, 0, (n / 64 + 1) * sizeof(uint64_t));
+            for (size_t i = 0; i < n; i++) {
+                if (type == 0) {
+                    s[i] = (uint8_t) (pcg_bits64(&seed) >> 63);
+                } else {
+                    lcg = 6906969069ull * lcg + 1234567ull;
+                    s[i] = (uint8_t) ((lcg >> 3) & 1);
+                }
+                s_packed[i / 64] |= (uint64_t) s[i] << (i % 64);
+            }
+            size_t L = berlekamp_massey(s_packed, n);
+            size_t Lref = berlekamp_massey_ref(s, n);
+            printf("%6d %6s %6d %6d\n", (int) n, (type == 0) ? "rand" : "lcg",
+                (int) L, (int) Lref);
+            if (L != Lref) {
+                is_ok = 0;
+            }
+        }
+        free(s);
+        free(s_packed);
+    }
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+
 int test_chi2()
 {
     double cdf_data[] = { //x, p, cdf
@@ -745,11 +832,366 @@ int test_linearcomp_cdf()
 }
 
 
+/**
+ * @brief Fills the buffer for checking of the block kernels: random values
+ * with some corner cases (zeros, all ones, maximal digits sums).
+ */
+static void fill_kernel_input64(uint64_t *x, size_t len)
+{
+    static const uint64_t special[] = {0, 0xFFFFFFFFFFFFFFFF,
+        0xFFFF0000FFFF0000, 0x0000FFFF0000FFFF, 0x8000000000000001, 3};
+    fill_rand64(x, len);
+    for (size_t i = 0; i < len; i += 7) {
+        x[i] = special[(i / 7) % (sizeof(special) / sizeof(special[0]))];
+    }
+}
+
+/**
+ * @brief Checks that the AVX2 version of the mod3 test block kernel gives
+ * the same residues as the portable one (and as the `%` operator) for
+ * different lengths and alignments.
+ */
+int test_mod3_residues(void)
+{
+    enum { MAXLEN = 1027 };
+    uint64_t *x = calloc(MAXLEN + 1, sizeof(uint64_t));
+    uint32_t *r = calloc(MAXLEN, sizeof(uint32_t));
+    uint32_t *r_ref = calloc(MAXLEN, sizeof(uint32_t));
+    if (x == NULL || r == NULL || r_ref == NULL) {
+        fprintf(stderr, "***** test_mod3_residues: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    int is_ok = 1;
+    printf("----- test_mod3_residues -----\n");
+    fill_kernel_input64(x, MAXLEN + 1);
+    for (size_t len = 0; len <= MAXLEN && is_ok; len = (len < 40) ? len + 1 : len + 97) {
+        for (size_t offset = 0; offset < 2; offset++) {
+            mod3_residues_block(r, x + offset, len);
+            mod3_residues_block_portable(r_ref, x + offset, len);
+            for (size_t i = 0; i < len; i++) {
+                if (r[i] != r_ref[i] || r_ref[i] != x[i + offset] % 3) {
+                    printf("len = %d, offset = %d, i = %d: %u %u\n",
+                        (int) len, (int) offset, (int) i, r[i], r_ref[i]);
+                    is_ok = 0;
+                    break;
+                }
+            }
+        }
+    }
+    free(x);
+    free(r);
+    free(r_ref);
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+/**
+ * @brief Checks that the AVX2 versions of the Hamming weights tests block
+ * kernels give the same results as the portable ones for different
+ * lengths, alignments and codes tables.
+ */
+int test_hamming_kernels(void)
+{
+    static const uint8_t hw_to_code[][9] = {
+        {0, 0, 1, 1, 2, 2, 3, 3, 0}, // hamming_ot for bytes
+        {0, 1, 2, 3, 4, 5, 6, 7, 8}
+    };
+    enum { MAXLEN = 1027 };
+    uint64_t *x = calloc(2 * MAXLEN + 8, sizeof(uint64_t));
+    uint8_t *codes = calloc(MAXLEN, sizeof(uint8_t));
+    uint8_t *codes_ref = calloc(MAXLEN, sizeof(uint8_t));
+    if (x == NULL || codes == NULL || codes_ref == NULL) {
+        fprintf(stderr, "***** test_hamming_kernels: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    int is_ok = 1;
+    printf("----- test_hamming_kernels -----\n");
+    fill_kernel_input64(x, 2 * MAXLEN + 8);
+    const uint8_t *bytes = (const uint8_t *) x;
+    for (size_t len = 0; len <= MAXLEN && is_ok; len = (len < 70) ? len + 1 : len + 97) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            // hamming_bytes_to_codes
+            for (size_t k = 0; k < sizeof(hw_to_code) / sizeof(hw_to_code[0]); k++) {
+                hamming_bytes_to_codes(codes, bytes + offset, len, hw_to_code[k]);
+                hamming_bytes_to_codes_portable(codes_ref, bytes + offset, len, hw_to_code[k]);
+                if (memcmp(codes, codes_ref, len) != 0) {
+                    printf("hamming_bytes_to_codes: len = %d, offset = %d, table = %d\n",
+                        (int) len, (int) offset, (int) k);
+                    is_ok = 0;
+                }
+            }
+            // hamming_xorsum_u64
+            const uint64_t *a = x + offset, *b = x + MAXLEN + 2 * offset;
+            const unsigned int hw = hamming_xorsum_u64(a, b, len);
+            const unsigned int hw_ref = hamming_xorsum_u64_portable(a, b, len);
+            if (hw != hw_ref) {
+                printf("hamming_xorsum_u64: len = %d, offset = %d: %u %u\n",
+                    (int) len, (int) offset, hw, hw_ref);
+                is_ok = 0;
+            }
+        }
+    }
+    free(x);
+    free(codes);
+    free(codes_ref);
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+/**
+ * @brief Checks the radix sort used by the 32-bit birthday spacings test
+ * against quicksort32, including samples with identical digits where
+ * the sorting passes are skipped.
+ */
+int test_bspace32_sort(void)
+{
+    static const uint32_t masks[] = {0xFFFFFFFF, 0x00FFFFFF, 0x7FF,
+        0xFFFFF800, 0xFFC007FF, 0};
+    static const size_t lens[] = {1, 2, 3, 17, 1000, 4096, 65537};
+    enum { MAXLEN = 65537 };
+    uint32_t *x = calloc(MAXLEN, sizeof(uint32_t));
+    uint32_t *x_ref = calloc(MAXLEN, sizeof(uint32_t));
+    uint32_t *tmp = calloc(MAXLEN, sizeof(uint32_t));
+    BSpace32SortHist *h = malloc(sizeof(BSpace32SortHist));
+    if (x == NULL || x_ref == NULL || tmp == NULL || h == NULL) {
+        fprintf(stderr, "***** test_bspace32_sort: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    int is_ok = 1;
+    printf("----- test_bspace32_sort -----\n");
+    for (size_t i = 0; i < sizeof(masks) / sizeof(masks[0]); i++) {
+        for (size_t j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+            const size_t len = lens[j];
+            fill_rand32(x, len);
+            for (size_t k = 0; k < len; k++) {
+                x[k] &= masks[i];
+                x_ref[k] = x[k];
+            }
+            bspace32_sort_small(x, tmp, len, h);
+            quicksort32(x_ref, len);
+            if (memcmp(x, x_ref, len * sizeof(uint32_t)) != 0) {
+                printf("mask = 0x%08X, len = %d: array is not sorted\n",
+                    masks[i], (int) len);
+                is_ok = 0;
+            }
+        }
+    }
+    free(x);
+    free(x_ref);
+    free(tmp);
+    free(h);
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+/**
+ * @brief Seed for test_discard: both copies of the generator must have
+ * the same state.
+ */
+static uint64_t get_fixed_seed64(void)
+{
+    return 0x243F6A8885A308D3;
+}
+
+static uint32_t get_fixed_seed32(void)
+{
+    return 0x13198A2E;
+}
+
+/**
+ * @brief Checks that `discard(n)` of the generator gives the same state
+ * as `n` calls of `get_bits`: the outputs after skipping are compared.
+ * Skipping is started from different positions inside the generator
+ * block (if any).
+ */
+static int test_discard_gen(const char *dirname, const char *genname,
+    const char *param)
+{
+    static const uint64_t nskip[] = {0, 1, 2, 3, 4, 7, 15, 16, 17, 63, 64, 65,
+        1000, 12345, 1000003};
+    static const unsigned int npre[] = {0, 1, 5};
+    char libname[512];
+    snprintf(libname, sizeof(libname), "%s/%s.so", dirname, genname);
+    set_cmd_param(param);
+    CallerAPI intf = CallerAPI_init();
+    intf.get_seed64 = get_fixed_seed64;
+    intf.get_seed32 = get_fixed_seed32;
+    GeneratorModule mod = GeneratorModule_load(libname, &intf);
+    if (!mod.valid) {
+        printf("%s: cannot load the module\n", genname);
+        return 0;
+    }
+    const GeneratorInfo *gi = &mod.gen;
+    int is_ok = (gi->discard != NULL);
+    for (size_t i = 0; is_ok && i < sizeof(nskip) / sizeof(nskip[0]); i++) {
+        for (size_t j = 0; is_ok && j < sizeof(npre) / sizeof(npre[0]); j++) {
+            void *a = gi->create(gi, &intf), *b = gi->create(gi, &intf);
+            for (unsigned int k = 0; k < npre[j]; k++) {
+                (void) gi->get_bits(a);
+                (void) gi->get_bits(b);
+            }
+            gi->discard(a, nskip[i]);
+            for (uint64_t k = 0; k < nskip[i]; k++) {
+                (void) gi->get_bits(b);
+            }
+            for (int k = 0; k < 64; k++) {
+                if (gi->get_bits(a) != gi->get_bits(b)) {
+                    printf("%s: mismatch for n = %llu after %u values\n",
+                        gi->name, (unsigned long long) nskip[i], npre[j]);
+                    is_ok = 0;
+                    break;
+                }
+            }
+            gi->free(a, gi, &intf);
+            gi->free(b, gi, &intf);
+        }
+    }
+    printf("%-20s %s\n", gi->name, is_ok ? "ok" : "FAILED");
+    GeneratorModule_unload(&mod);
+    CallerAPI_free();
+    return is_ok;
+}
+
+/**
+ * @brief Checks the jump-ahead `discard` callbacks of generators: LCG
+ * (`lcg64_skip`), counter-based and block generators.
+ * @param dirname  Directory with the generators modules.
+ */
+int test_discard(const char *dirname)
+{
+    static const char *gens[][2] = {
+        {"lcg64", "marsaglia"}, {"lcg64", "taocp"}, {"lcg64", "steele"},
+        {"pcg64_64", ""}, {"splitmix", ""}, {"chacha", "c99"},
+        {"chacha", "avx"}, {"philox", ""}, {NULL, NULL}
+    };
+    int is_ok = 1;
+    printf("----- test_discard -----\n");
+    for (size_t i = 0; gens[i][0] != NULL; i++) {
+        is_ok = is_ok & test_discard_gen(dirname, gens[i][0], gens[i][1]);
+    }
+    set_cmd_param("");
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+/**
+ * @brief Compares the next 64 outputs of two examples of the generator.
+ */
+static int gen_outputs_equal(const GeneratorInfo *gi, void *a, void *b)
+{
+    for (int k = 0; k < 64; k++) {
+        if (gi->get_bits(a) != gi->get_bits(b)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks the `jump` and `seek` callbacks of the generator against
+ * its `discard` callback (see test_discard_gen): the jump by \f$ 2^d \f$
+ * outputs must be equivalent to skipping of \f$ 2^d \f$ values, the seek
+ * to the output with index \f$ i \f$ - to skipping of \f$ i \f$ values
+ * from the beginning. Each supported callback must accept at least one
+ * of the tried distances and indexes.
+ */
+static int test_jump_gen(const char *dirname, const char *genname,
+    const char *param)
+{
+    static const unsigned int log2_dists[] = {2, 4, 5, 10, 20, 33, 48, 56, 63};
+    static const uint64_t seek_inds[][2] = {{0, 0}, {0, 1}, {0, 17},
+        {0, 1000003}, {0, 0x123456789ABCDEF}, {1, 5}, {3, 0}, {0x10, 0}};
+    char libname[512];
+    snprintf(libname, sizeof(libname), "%s/%s.so", dirname, genname);
+    set_cmd_param(param);
+    CallerAPI intf = CallerAPI_init();
+    intf.get_seed64 = get_fixed_seed64;
+    intf.get_seed32 = get_fixed_seed32;
+    GeneratorModule mod = GeneratorModule_load(libname, &intf);
+    if (!mod.valid) {
+        printf("%s: cannot load the module\n", genname);
+        return 0;
+    }
+    const GeneratorInfo *gi = &mod.gen;
+    int is_ok = (gi->discard != NULL && (gi->jump != NULL || gi->seek != NULL));
+    unsigned int njumps = 0, nseeks = 0;
+    for (size_t i = 0; is_ok && gi->jump != NULL &&
+        i < sizeof(log2_dists) / sizeof(log2_dists[0]); i++) {
+        void *a = gi->create(gi, &intf), *b = gi->create(gi, &intf);
+        (void) gi->get_bits(a);
+        (void) gi->get_bits(b);
+        if (gi->jump(a, log2_dists[i])) {
+            gi->discard(b, 1ull << log2_dists[i]);
+            njumps++;
+            if (!gen_outputs_equal(gi, a, b)) {
+                printf("%s: jump mismatch for d = %u\n", gi->name, log2_dists[i]);
+                is_ok = 0;
+            }
+        }
+        gi->free(a, gi, &intf);
+        gi->free(b, gi, &intf);
+    }
+    for (size_t i = 0; is_ok && gi->seek != NULL &&
+        i < sizeof(seek_inds) / sizeof(seek_inds[0]); i++) {
+        void *a = gi->create(gi, &intf), *b = gi->create(gi, &intf);
+        for (int k = 0; k < 3; k++) {
+            (void) gi->get_bits(a);
+        }
+        if (gi->seek(a, seek_inds[i][0], seek_inds[i][1])) {
+            for (uint64_t k = 0; k < seek_inds[i][0]; k++) {
+                gi->discard(b, 1ull << 63);
+                gi->discard(b, 1ull << 63);
+            }
+            gi->discard(b, seek_inds[i][1]);
+            nseeks++;
+            if (!gen_outputs_equal(gi, a, b)) {
+                printf("%s: seek mismatch for index 0x%llX:%llX\n", gi->name,
+                    (unsigned long long) seek_inds[i][0],
+                    (unsigned long long) seek_inds[i][1]);
+                is_ok = 0;
+            }
+        }
+        gi->free(a, gi, &intf);
+        gi->free(b, gi, &intf);
+    }
+    if ((gi->jump != NULL && njumps == 0) || (gi->seek != NULL && nseeks == 0)) {
+        printf("%s: no supported distances or indexes\n", gi->name);
+        is_ok = 0;
+    }
+    printf("%-20s %s (jumps: %u, seeks: %u)\n", gi->name,
+        is_ok ? "ok" : "FAILED", njumps, nseeks);
+    GeneratorModule_unload(&mod);
+    CallerAPI_free();
+    return is_ok;
+}
+
+/**
+ * @brief Checks the `jump` and `seek` callbacks of generators that also
+ * have `discard` callbacks.
+ * @param dirname  Directory with the generators modules.
+ */
+int test_jump(const char *dirname)
+{
+    static const char *gens[][2] = {
+        {"pcg64_64", ""}, {"splitmix", ""}, {"chacha", "c99"},
+        {"chacha", "avx"}, {"philox", ""}, {NULL, NULL}
+    };
+    int is_ok = 1;
+    printf("----- test_jump -----\n");
+    for (size_t i = 0; gens[i][0] != NULL; i++) {
+        is_ok = is_ok & test_jump_gen(dirname, gens[i][0], gens[i][1]);
+    }
+    set_cmd_param("");
+    print_is_ok(is_ok);
+    return is_ok;
+}
+
+
 int main(int argc, char *argv[])
 {
     if (argc < 2) {
         printf("Usage: test_funcs test_group\n");
-        printf("  test_group: sort, specfuncs, distr\n");
+        printf("  test_group: sort, specfuncs, distr, kernels, discard [generators_dir]\n");
         return 0;
     }
     int is_ok = 1;
@@ -761,6 +1203,7 @@ int main(int argc, char *argv[])
         is_ok = is_ok & test_lgamma();
         is_ok = is_ok & test_hamming_weights();
         is_ok = is_ok & test_round();
+        is_ok = is_ok & test_berlekamp_massey();
     } else if (!strcmp(argv[1], "distr")) {
         is_ok = is_ok & test_chi2();
         is_ok = is_ok & test_ks();
@@ -772,6 +1215,13 @@ int main(int argc, char *argv[])
         is_ok = is_ok & test_norminv();
         is_ok = is_ok & test_linearcomp_cdf();
         is_ok = is_ok & test_geom();
+    } else if (!strcmp(argv[1], "kernels")) {
+        is_ok = is_ok & test_mod3_residues();
+        is_ok = is_ok & test_hamming_kernels();
+        is_ok = is_ok & test_bspace32_sort();
+    } else if (!strcmp(argv[1], "discard")) {
+        is_ok = is_ok & test_discard((argc > 2) ? argv[2] : "generators");
+        is_ok = is_ok & test_jump((argc > 2) ? argv[2] : "generators");
     } else {
         fprintf(stderr, "Unknown test group '%s'\n", argv[1]);
         is_ok = 0;
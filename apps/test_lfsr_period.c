@@ -457,6 +457,57 @@ static int test_xorshift160(const CallerAPI *intf)
     return is_ok;
 }
 
+/**
+ * @brief Tests the generic LFSR jump (LfsrJump) used for generators
+ * without their own `jump` callback: it must be rejected for the counter
+ * and must coincide with direct calls of the xorshift160 generator.
+ */
+static int test_lfsr_jump(const CallerAPI *intf)
+{
+    static const GeneratorInfo gen_ctr = {
+        .name = "ctr64",
+        .nbits = 32,
+        .create = gen_create_ctr64,
+        .free = gen_free,
+        .get_bits = get_bits_ctr64
+    };
+    static const GeneratorInfo gen_xs160 = {
+        .name = "xorshift160",
+        .nbits = 32,
+        .create = gen_create_xs160,
+        .free = gen_free,
+        .get_bits = get_bits_xs160
+    };
+    const unsigned int jmp_pow = 20;
+    LfsrJump jmp;
+    intf->printf("----- LfsrJump test -----\n");
+    if (LfsrJump_init(&jmp, &gen_ctr, intf, jmp_pow)) {
+        intf->printf("  ctr64 was not rejected\n");
+        LfsrJump_destruct(&jmp);
+        return 0;
+    }
+    if (!LfsrJump_init(&jmp, &gen_xs160, intf, jmp_pow)) {
+        intf->printf("  xorshift160 was rejected\n");
+        return 0;
+    }
+    GeneratorState gen = GeneratorState_create(&gen_xs160, intf);
+    // a) reference value
+    Xorshift160State_reset(gen.state);
+    for (size_t i = 0; i < (size_t) (1ULL << jmp_pow); i++) {
+        (void) gen.gi->get_bits(gen.state);
+    }
+    const uint64_t u_ref = gen.gi->get_bits(gen.state);
+    intf->printf("  u_ref = %llX\n", (unsigned long long) u_ref);
+    // b) generic jump value
+    Xorshift160State_reset(gen.state);
+    LfsrJump_apply(&jmp, &gen);
+    const uint64_t u_jmp = gen.gi->get_bits(gen.state);
+    intf->printf("  u_jmp = %llX\n", (unsigned long long) u_jmp);
+    GeneratorState_destruct(&gen);
+    LfsrJump_destruct(&jmp);
+    return u_jmp == u_ref;
+}
+
 /**
  * @brief Program entry point, runs all tests.
  */
@@ -468,6 +519,7 @@ int main()
     const int is_xr32_ok   = test_xorrot32(&intf);
     const int is_xs128_ok  = test_xoroshiro128(&intf);
     const int is_xs160_ok  = test_xorshift160(&intf);
+    const int is_jump_ok   = test_lfsr_jump(&intf);
     CallerAPI_free();
 
     printf("ctr:            [%s]\n", is_ctr_ok    ? "PASSED" : "FAILED");
@@ -475,6 +527,8 @@ int main()
     printf("xorrot32:       [%s]\n", is_xr32_ok   ? "PASSED" : "FAILED");
     printf("xoroshiro128++: [%s]\n", is_xs128_ok  ? "PASSED" : "FAILED");
     printf("xorshift160:    [%s]\n", is_xs160_ok  ? "PASSED" : "FAILED");
-    const int is_ok = is_ctr_ok && is_tf0_64_ok && is_xr32_ok && is_xs128_ok && is_xs160_ok;
+    printf("LfsrJump:       [%s]\n", is_jump_ok   ? "PASSED" : "FAILED");
+    const int is_ok = is_ctr_ok && is_tf0_64_ok && is_xr32_ok && is_xs128_ok &&
+        is_xs160_ok && is_jump_ok;
     return is_ok ? 0 : 1;
 }
@@ -252,6 +252,65 @@ static inline uint64_t get_bits_c99ctr32_raw(ChaChaState *obj)
 
 MAKE_GET_BITS_WRAPPERS(c99ctr32)
 
+/**
+ * @brief Moves the scalar generator (with 64-bit counter) forward by
+ * \f$ 2^d \f$ outputs where \f$ 4 \le d < 68 \f$. Also suitable for the AVX
+ * version because they give bit-to-bit identical output.
+ */
+static int jump_scalar(void *state, uint64_t log2_distance)
+{
+    ChaChaState *obj = state;
+    if (log2_distance < 4 || log2_distance >= 68) {
+        return 0;
+    }
+    const uint64_t inc = 1ull << (log2_distance - 4);
+    const uint64_t ctr = ((uint64_t) obj->x[12] | ((uint64_t) obj->x[13] << 32)) + inc;
+    obj->x[12] = (uint32_t) ctr;
+    obj->x[13] = (uint32_t) (ctr >> 32);
+    ChaCha_block_c99(obj);
+    return 1;
+}
+
+/**
+ * @brief Moves the scalar generator (with 64-bit counter) to the output with
+ * the given 128-bit index; the output with index 0 is the first output of
+ * the freshly created generator. Indexes beyond the period \f$ 2^{68} \f$
+ * are not supported.
+ */
+static int seek_scalar(void *state, uint64_t counter_hi, uint64_t counter_lo)
+{
+    ChaChaState *obj = state;
+    if (counter_hi >> 4 != 0) {
+        return 0;
+    }
+    const uint64_t ctr = (counter_lo >> 4) | (counter_hi << 60);
+    obj->x[12] = (uint32_t) ctr;
+    obj->x[13] = (uint32_t) (ctr >> 32);
+    ChaCha_block_c99(obj);
+    obj->pos = (size_t) (counter_lo & 0xF);
+    return 1;
+}
+
+
+/**
+ * @brief Skips `n` outputs of the scalar generator (with 64-bit counter):
+ * the output index is `16*ctr + pos`, only the counter and the position
+ * inside the block are changed.
+ */
+static void discard_scalar(void *state, uint64_t n)
+{
+    ChaChaState *obj = state;
+    const uint64_t ctr0 = (uint64_t) obj->x[12] | ((uint64_t) obj->x[13] << 32);
+    const size_t pos = obj->pos + (size_t) (n & 0xF);
+    const uint64_t ctr = ctr0 + (n >> 4) + (pos >> 4);
+    obj->x[12] = (uint32_t) ctr;
+    obj->x[13] = (uint32_t) (ctr >> 32);
+    obj->pos = pos & 0xF;
+    if (ctr != ctr0) {
+        ChaCha_block_c99(obj);
+    }
+}
+
 
 /**
  * @brief Print the 4x4 matrix of uint32_t from the ChaCha PRNG state.
@@ -892,5 +951,13 @@ int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf)
     const char *param = intf->get_param();
     gi->description = description;
     gi->self_test = run_self_test;
-    return GeneratorParamVariant_find(gen_list, intf, param, gi);
+    if (!GeneratorParamVariant_find(gen_list, intf, param, gi)) {
+        return 0;
+    }
+    if (gi->get_bits == get_bits_c99 || gi->get_bits == get_bits_avx) {
+        gi->jump = jump_scalar;
+        gi->seek = seek_scalar;
+        gi->discard = discard_scalar;
+    }
+    return 1;
 }
@@ -20,6 +20,16 @@
 
 PRNG_CMODULE_PROLOG
 
+/**
+ * @brief Generates the `discard_SUFFIX` function that skips `n` outputs
+ * of the LCG with the given multiplier and increment by means of jump-ahead.
+ */
+#define MAKE_LCG64_DISCARD(suffix, a, c) \
+static void discard_##suffix(void *state, uint64_t n) { \
+    Lcg64State *obj = state; \
+    obj->x = lcg64_skip(obj->x, a, c, n); \
+}
+
 /////////////////////////////
 ///// Marsaglia version /////
 /////////////////////////////
@@ -31,6 +41,7 @@ static inline uint64_t get_bits_marsaglia_raw(Lcg64State *obj)
 }
 
 MAKE_GET_BITS_WRAPPERS(marsaglia)
+MAKE_LCG64_DISCARD(marsaglia, 6906969069ULL, 1ULL)
 
 /////////////////////////////////////////
 ///// Version from TAOCP (by Hayes) /////
@@ -43,6 +54,7 @@ static inline uint64_t get_bits_taocp_raw(Lcg64State *obj)
 }
 
 MAKE_GET_BITS_WRAPPERS(taocp)
+MAKE_LCG64_DISCARD(taocp, 6364136223846793005ULL, 1442695040888963407ULL)
 
 //////////////////////////////////
 ///// Steele & Vigna version /////
@@ -55,6 +67,7 @@ static inline uint64_t get_bits_steele_raw(Lcg64State *obj)
 }
 
 MAKE_GET_BITS_WRAPPERS(steele)
+MAKE_LCG64_DISCARD(steele, 0xd1342543de82ef95ULL, 1442695040888963407ULL)
 
 //////////////////////
 ///// Interfaces /////
@@ -90,5 +103,15 @@ int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf)
     const char *param = intf->get_param();
     gi->description = description;
     gi->self_test = NULL;
-    return GeneratorParamVariant_find(gen_list, intf, param, gi);
+    if (!GeneratorParamVariant_find(gen_list, intf, param, gi)) {
+        return 0;
+    }
+    if (gi->get_bits == get_bits_marsaglia) {
+        gi->discard = discard_marsaglia;
+    } else if (gi->get_bits == get_bits_taocp) {
+        gi->discard = discard_taocp;
+    } else if (gi->get_bits == get_bits_steele) {
+        gi->discard = discard_steele;
+    }
+    return 1;
 }
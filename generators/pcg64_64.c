@@ -20,6 +20,8 @@
  *
  * This software is licensed under the MIT license.
  */
+#define GEN_JUMP_FUNC jump
+#define GEN_DISCARD_FUNC discard_lcg
 #include "smokerand/cinterface.h"
 
 PRNG_CMODULE_PROLOG
@@ -37,6 +39,35 @@ static inline uint64_t get_bits_raw(Pcg64State *obj)
     return (word >> 43) ^ word;
 }
 
+/**
+ * @brief Moves the generator forward by \f$ 2^d \f$ outputs where
+ * \f$ d < 64 \f$: the LCG is iterated \f$ d \f$ times with the squared
+ * transition function \f$ (a, c) \to (a^2, c(a + 1)) \f$.
+ */
+static int jump(void *state, uint64_t log2_distance)
+{
+    Pcg64State *obj = state;
+    if (log2_distance >= 64) {
+        return 0;
+    }
+    uint64_t a = 6364136223846793005ull, c = obj->inc;
+    for (unsigned int i = 0; i < log2_distance; i++) {
+        c *= a + 1;
+        a *= a;
+    }
+    obj->state = obj->state * a + c;
+    return 1;
+}
+
+/**
+ * @brief Skips `n` outputs by means of the LCG jump-ahead.
+ */
+static void discard_lcg(void *state, uint64_t n)
+{
+    Pcg64State *obj = state;
+    obj->state = lcg64_skip(obj->state, 6364136223846793005ull, obj->inc, n);
+}
+
 static void *create(const CallerAPI *intf)
 {
     Pcg64State *obj = intf->malloc(sizeof(Pcg64State));
@@ -25,6 +25,9 @@
  *
  * This software is licensed under the MIT license.
  */
+#define GEN_JUMP_FUNC jump
+#define GEN_SEEK_FUNC seek
+#define GEN_DISCARD_FUNC discard_ctr
 #include "smokerand/cinterface.h"
 #include "smokerand/int128defs.h"
 
@@ -181,6 +184,65 @@ static inline uint64_t get_bits_raw(PhiloxState *obj)
     return obj->out[obj->pos++];
 }
 
+/**
+ * @brief Moves the generator forward by \f$ 2^d \f$ outputs where
+ * \f$ 2 \le d < 130 \f$, i.e. adds \f$ 2^{d - 2} \f$ to the 128-bit
+ * block counter.
+ */
+static int jump(void *state, uint64_t log2_distance)
+{
+    PhiloxState *obj = state;
+    if (log2_distance < 2 || log2_distance >= 130) {
+        return 0;
+    }
+    const unsigned int e = (unsigned int) (log2_distance - 2);
+    if (e < 64) {
+        const uint64_t inc = 1ull << e;
+        obj->ctr[0] += inc;
+        if (obj->ctr[0] < inc) obj->ctr[1]++;
+    } else {
+        obj->ctr[1] += 1ull << (e - 64);
+    }
+    if (obj->pos < Nw) {
+        PhiloxState_block10(obj);
+    }
+    return 1;
+}
+
+/**
+ * @brief Moves the generator to the output with the given 128-bit index;
+ * the output with index 0 is the first output of the freshly created
+ * generator.
+ */
+static int seek(void *state, uint64_t counter_hi, uint64_t counter_lo)
+{
+    PhiloxState *obj = state;
+    obj->ctr[0] = (counter_lo >> 2) | (counter_hi << 62);
+    obj->ctr[1] = counter_hi >> 2;
+    PhiloxState_inc_counter(obj);
+    PhiloxState_block10(obj);
+    obj->pos = (size_t) (counter_lo & 0x3);
+    return 1;
+}
+
+/**
+ * @brief Skips `n` outputs: the output index is `4*ctr + pos`, so only
+ * the 128-bit block counter and the position inside the block are changed.
+ */
+static void discard_ctr(void *state, uint64_t n)
+{
+    PhiloxState *obj = state;
+    const uint64_t ctr0 = obj->ctr[0], ctr1 = obj->ctr[1];
+    const size_t pos = obj->pos + (size_t) (n & 0x3);
+    const uint64_t inc = (n >> 2) + (pos >> 2);
+    obj->ctr[0] += inc;
+    if (obj->ctr[0] < inc) obj->ctr[1]++;
+    obj->pos = pos & 0x3;
+    if (obj->ctr[0] != ctr0 || obj->ctr[1] != ctr1) {
+        PhiloxState_block10(obj);
+    }
+}
+
 static void *create(const CallerAPI *intf)
 {
     uint64_t k[Nw / 2];
@@ -11,6 +11,8 @@
  *
  * This software is licensed under the MIT license.
  */
+#define GEN_JUMP_FUNC jump
+#define GEN_DISCARD_FUNC discard_ctr
 #include "smokerand/cinterface.h"
 
 PRNG_CMODULE_PROLOG
@@ -22,15 +24,40 @@ typedef struct {
     uint64_t x;
 } SplitMixState;
 
+#define SPLITMIX_GAMMA 0x9E3779B97F4A7C15
+
 static inline uint64_t get_bits_raw(SplitMixState *obj)
 {
-    const uint64_t gamma = 0x9E3779B97F4A7C15;
+    const uint64_t gamma = SPLITMIX_GAMMA;
     uint64_t z = (obj->x += gamma);
     z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
     z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
     return z ^ (z >> 31);
 }
 
+/**
+ * @brief Moves the generator forward by \f$ 2^d \f$ outputs where
+ * \f$ d < 64 \f$: just adds \f$ 2^d \gamma \f$ to the counter.
+ */
+static int jump(void *state, uint64_t log2_distance)
+{
+    SplitMixState *obj = state;
+    if (log2_distance >= 64) {
+        return 0;
+    }
+    obj->x += SPLITMIX_GAMMA << log2_distance;
+    return 1;
+}
+
+/**
+ * @brief Skips `n` outputs: just adds \f$ n \gamma \f$ to the counter.
+ */
+static void discard_ctr(void *state, uint64_t n)
+{
+    SplitMixState *obj = state;
+    obj->x += SPLITMIX_GAMMA * n;
+}
+
 static void *create(const CallerAPI *intf)
 {
     SplitMixState *obj = intf->malloc(sizeof(SplitMixState));
@@ -111,6 +111,7 @@ static inline uint64_t get_bits_scalar_raw(void *state)
 }
 
 MAKE_GET_BITS_WRAPPERS(scalar)
+MAKE_FILL_WRAPPER(scalar)
 
 static void *create_scalar(const GeneratorInfo *gi, const CallerAPI *intf)
 {
@@ -194,6 +195,7 @@ static inline uint64_t get_bits_vector_raw(void *state)
 }
 
 MAKE_GET_BITS_WRAPPERS(vector)
+MAKE_FILL_WRAPPER(vector)
 
 
 void next_scalar(uint64_t *s0_out, uint64_t *s1_out, uint64_t s0, uint64_t s1)
@@ -204,26 +206,52 @@ void next_scalar(uint64_t *s0_out, uint64_t *s1_out, uint64_t s0, uint64_t s1)
 }
 
 
-void long_jump(uint64_t *s0_out, uint64_t *s1_out, uint64_t s0_in, uint64_t s1_in)
+/**
+ * @brief Applies the jump polynomial to the (s0_in, s1_in) state.
+ */
+static void apply_jump_poly(uint64_t *s0_out, uint64_t *s1_out,
+    uint64_t s0_in, uint64_t s1_in, const uint64_t *poly)
 {
-    static const uint64_t LONG_JUMP[] = { 0x360fd5f2cf8d5d99, 0x9c6e6877736c46e3 };
     uint64_t s0 = 0, s1 = 0;
-    for (size_t i = 0; i < sizeof(LONG_JUMP) / sizeof (*LONG_JUMP); i++) {
+    for (size_t i = 0; i < 2; i++) {
         for (int b = 0; b < 64; b++) {
-            if (LONG_JUMP[i] & UINT64_C(1) << b) {
+            if (poly[i] & UINT64_C(1) << b) {
                 s0 ^= s0_in;
                 s1 ^= s1_in;
             }
             next_scalar(&s0_in, &s1_in, s0_in, s1_in);
         }
     }
-
-
     *s0_out = s0;
     *s1_out = s1;
 }
 
 
+void long_jump(uint64_t *s0_out, uint64_t *s1_out, uint64_t s0_in, uint64_t s1_in)
+{
+    static const uint64_t LONG_JUMP[] = { 0x360fd5f2cf8d5d99, 0x9c6e6877736c46e3 };
+    apply_jump_poly(s0_out, s1_out, s0_in, s1_in, LONG_JUMP);
+}
+
+/**
+ * @brief Jump for the scalar version: supports 2^64 and 2^96 steps.
+ */
+static int jump_scalar(void *state, uint64_t log2_distance)
+{
+    static const uint64_t JUMP[] = { 0x2bd7a6a6e99c2ddc, 0x0992ccaf6a6fca05 };
+    static const uint64_t LONG_JUMP[] = { 0x360fd5f2cf8d5d99, 0x9c6e6877736c46e3 };
+    Xoroshiro128PPState *obj = state;
+    if (log2_distance == 64) {
+        apply_jump_poly(&obj->s[0], &obj->s[1], obj->s[0], obj->s[1], JUMP);
+    } else if (log2_distance == 96) {
+        apply_jump_poly(&obj->s[0], &obj->s[1], obj->s[0], obj->s[1], LONG_JUMP);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+
 #ifdef XS128PP_VEC_ENABLED
 static void Xoroshiro128PPVecState_init(Xoroshiro128PPVecState *obj, uint64_t s0, uint64_t s1)
 {
@@ -358,16 +386,23 @@ int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf)
     gi->nbits = 64;
     gi->self_test = run_self_test;
     gi->parent = NULL;
+    gi->fill = NULL;
+    gi->jump = NULL;
+    gi->seek = NULL;
+    gi->discard = NULL;
     if (!intf->strcmp(param, "scalar") || !intf->strcmp(param, "")) {
         gi->name = "xoroshiro128++:scalar";
         gi->create = create_scalar;
         gi->get_bits = get_bits_scalar;
         gi->get_sum = get_sum_scalar;
+        gi->fill = fill_scalar;
+        gi->jump = jump_scalar;
     } else if (!intf->strcmp(param, "vector")) {
         gi->name = "xoroshiro128++:vector";
         gi->create = create_vector;
         gi->get_bits = get_bits_vector;
         gi->get_sum = get_sum_vector;
+        gi->fill = fill_vector;
     } else {
         gi->name = "xoroshiro128++:unknown";
         gi->get_bits = NULL;
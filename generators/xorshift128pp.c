@@ -192,6 +192,20 @@ void jump(uint64_t *s0_out, uint64_t *s1_out, uint64_t s0_in, uint64_t s1_in)
 }
 
 
+/**
+ * @brief Jump for the scalar version: supports only \f$ 2^{64} \f$ steps.
+ */
+static int jump_scalar(void *state, uint64_t log2_distance)
+{
+    Xorshift128PPState *obj = state;
+    if (log2_distance != 64) {
+        return 0;
+    }
+    jump(&obj->s[0], &obj->s[1], obj->s[0], obj->s[1]);
+    return 1;
+}
+
+
 #ifdef XSH128PP_VEC_ENABLED
 static void Xorshift128PPVecState_init(Xorshift128PPVecState *obj, uint64_t s0, uint64_t s1)
 {
@@ -296,11 +310,16 @@ int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf)
     gi->nbits = 64;
     gi->self_test = run_self_test;
     gi->parent = NULL;
+    gi->fill = NULL;
+    gi->jump = NULL;
+    gi->seek = NULL;
+    gi->discard = NULL;
     if (!intf->strcmp(param, "scalar") || !intf->strcmp(param, "")) {
         gi->name = "xorshift128++:scalar";
         gi->create = create_scalar;
         gi->get_bits = get_bits_scalar;
         gi->get_sum = get_sum_scalar;
+        gi->jump = jump_scalar;
     } else if (!intf->strcmp(param, "vector")) {
         gi->name = "xorshift128++:vector";
         gi->create = create_vector;
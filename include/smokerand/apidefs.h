@@ -96,6 +96,10 @@ typedef struct GeneratorInfo_ {
     int (*self_test)(const CallerAPI *intf); ///< Run internal self-test
     uint64_t (*get_sum)(void *state, size_t len); ///< Return sum of `len` elements
     const struct GeneratorInfo_ *parent; ///< Used by create/free functions in enveloped generators.
+    void (*fill)(void *state, uint64_t *buf, size_t len); ///< Write `len` u32/u64 numbers to `buf` (optional)
+    int (*jump)(void *state, uint64_t log2_distance); ///< Jump by 2^log2_distance outputs, 0 if unsupported (optional)
+    int (*seek)(void *state, uint64_t counter_hi, uint64_t counter_lo); ///< Go to the output with 128-bit index counter_hi:counter_lo, 0 if unsupported (optional)
+    void (*discard)(void *state, uint64_t n); ///< Skip `n` outputs (optional)
 } GeneratorInfo;
 
 
@@ -53,10 +53,57 @@ static void default_free(void *state, const GeneratorInfo *gi, const CallerAPI *
     return sum; \
 }
 
+/**
+ * @brief Defines a function that writes a block of pseudorandom numbers
+ * to the buffer. Allows the caller to avoid an indirect call per each
+ * generated number.
+ */
+#define FILL_FUNC EXPORT void fill(void *state, uint64_t *buf, size_t len) { \
+    for (size_t i = 0; i < len; i++) { \
+        buf[i] = get_bits_raw(state); \
+    } \
+}
+
+/**
+ * @brief Defines a function that skips `n` outputs of the generator. The loop
+ * is inlined into the module, so the caller avoids an indirect call per each
+ * discarded number.
+ */
+#define DISCARD_FUNC EXPORT void discard(void *state, uint64_t n) { \
+    for (uint64_t i = 0; i < n; i++) { \
+        (void) get_bits_raw(state); \
+    } \
+}
+
 #ifndef GEN_DESCRIPTION
 #define GEN_DESCRIPTION NULL
 #endif
 
+/**
+ * @brief Optional `jump` and `seek` callbacks for MAKE_UINT_PRNG. A module
+ * that supports them must define these macros before including this header.
+ */
+#ifndef GEN_JUMP_FUNC
+#define GEN_JUMP_FUNC NULL
+#endif
+
+#ifndef GEN_SEEK_FUNC
+#define GEN_SEEK_FUNC NULL
+#endif
+
+/**
+ * @brief The `discard` callback for MAKE_UINT_PRNG: the loop generated by
+ * DISCARD_FUNC by default. Modules with a fast jump-ahead may define their
+ * own function before including this header, the default one is not
+ * emitted then.
+ */
+#ifndef GEN_DISCARD_FUNC
+#define GEN_DISCARD_FUNC discard
+#define DEFAULT_DISCARD_FUNC DISCARD_FUNC
+#else
+#define DEFAULT_DISCARD_FUNC
+#endif
+
 /**
  * @brief  Some default boilerplate code for scalar PRNG that returns
  * unsigned integers.
@@ -71,6 +118,8 @@ static void default_free(void *state, const GeneratorInfo *gi, const CallerAPI *
 #define MAKE_UINT_PRNG(prng_name, selftest_func, numofbits) \
 EXPORT uint64_t get_bits(void *state) { return get_bits_raw(state); } \
 GET_SUM_FUNC \
+FILL_FUNC \
+DEFAULT_DISCARD_FUNC \
 int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf) { (void) intf; \
     gi->name = prng_name; \
     gi->description = GEN_DESCRIPTION; \
@@ -81,6 +130,10 @@ int EXPORT gen_getinfo(GeneratorInfo *gi, const CallerAPI *intf) { (void) intf;
     gi->get_sum = get_sum; \
     gi->self_test = selftest_func; \
     gi->parent = NULL; \
+    gi->fill = fill; \
+    gi->jump = GEN_JUMP_FUNC; \
+    gi->seek = GEN_SEEK_FUNC; \
+    gi->discard = GEN_DISCARD_FUNC; \
     return 1; \
 }
 
@@ -115,6 +168,17 @@ static uint64_t get_sum_##suffix(void *state, size_t len) { \
     return sum; \
 }
 
+/**
+ * @brief Generates the `fill_SUFFIX` function for a user defined
+ * `get_bits_SUFFIX_raw`, see `FILL_FUNC`.
+ */
+#define MAKE_FILL_WRAPPER(suffix) \
+static void fill_##suffix(void *state, uint64_t *buf, size_t len) { \
+    for (size_t i = 0; i < len; i++) { \
+        buf[i] = get_bits_##suffix##_raw(state); \
+    } \
+}
+
 ///////////////////////////////////////////////////////
 ///// Some predefined structures for PRNGs states /////
 ///////////////////////////////////////////////////////
@@ -133,6 +197,27 @@ typedef struct {
     uint64_t x;
 } Lcg64State;
 
+/**
+ * @brief Returns the state of the \f$ x_{i+1} = (ax_i + c) \mod 2^{64} \f$
+ * LCG after `n` steps. Requires \f$ O(\log n) \f$ operations: the pair
+ * \f$ (a, c) \f$ is transformed to \f$ (a^2, c(a + 1)) \f$ for the doubled
+ * distance.
+ */
+static inline uint64_t lcg64_skip(uint64_t x, uint64_t a, uint64_t c, uint64_t n)
+{
+    uint64_t acc_a = 1, acc_c = 0;
+    while (n > 0) {
+        if (n & 1) {
+            acc_a *= a;
+            acc_c = acc_c * a + c;
+        }
+        c *= a + 1;
+        a *= a;
+        n >>= 1;
+    }
+    return acc_a * x + acc_c;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 ///// Some data structures and subroutines for command line interface /////
 ///////////////////////////////////////////////////////////////////////////
@@ -169,6 +254,10 @@ GeneratorParamVariant_find(const GeneratorParamVariant *gen_list,
     gi->free     = default_free;
     gi->get_bits = NULL;
     gi->get_sum  = NULL;
+    gi->fill     = NULL;
+    gi->jump     = NULL;
+    gi->seek     = NULL;
+    gi->discard  = NULL;
     for (const GeneratorParamVariant *e = gen_list; e->param != NULL; e++) {
         if (!intf->strcmp(param, e->param)) {
             gi->name     = e->name;
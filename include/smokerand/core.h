@@ -43,21 +43,103 @@ void set_entropy_textseed(const char *seed);
 int set_entropy_base64_seed(const char *seed);
 char *get_entropy_base64_seed(void);
 void set_use_stderr_for_printf(int val);
+void set_test_nsplits(unsigned int nsplits);
+unsigned int get_test_nsplits(void);
+
+/**
+ * @brief Size of the GeneratorState block buffer, in 64-bit words.
+ */
+#define GENERATOR_STATE_BUFSIZE 512
+
+/**
+ * @brief Memory arena for large temporary buffers of statistical tests.
+ * @details Each thread running the tests has its own arena: the memory block
+ * is reserved from the OS once (backed by huge pages if possible) and then
+ * reused by all tests of the battery run, so they don't pay page faults
+ * for each new 100+ MiB array. Buffers are allocated as a stack and may be
+ * freed in any order. If the block is too small and some buffers are still
+ * in use then `calloc` is used instead.
+ */
+typedef struct {
+    unsigned char *data; ///< Reserved memory block
+    size_t capacity; ///< Size of the reserved block, bytes
+    size_t used; ///< Top of the stack, bytes
+    size_t top; ///< Offset of the last chunk header (if `used > 0`)
+    size_t peak; ///< Peak value of `used`, bytes
+    unsigned long long nfallbacks; ///< Number of buffers allocated by calloc
+    int is_huge; ///< 1 if the block is backed by huge pages
+} TestArena;
+
+void *TestArena_calloc(TestArena *obj, size_t nmemb, size_t size);
+void TestArena_free(TestArena *obj, void *ptr);
 
 /**
  * @brief Input data for generic statistical test, mainly PNG and its state.
+ * @details Statistical tests should read the generator output by means of
+ * the GeneratorState_get_bits function: it takes numbers from the block
+ * buffer that is refilled by the `fill` callback (or by `get_bits` calls
+ * if the generator has no `fill`). Each test gets its own state seeded from
+ * the ChaCha20 substream of this test, so the values left in the buffer
+ * are not passed to the next test: they are discarded by
+ * GeneratorState_destruct and counted by GeneratorState_get_nbytes_unused.
  */
 typedef struct {
     const GeneratorInfo *gi; ///< Generator to be tested
     void *state; ///< Pointer to generator state
     const CallerAPI *intf; ///< Will be used for output
+    uint64_t *buf; ///< Block buffer with the generator output
+    size_t buf_pos; ///< Position of the next unread number in the buffer
+    size_t buf_len; ///< Number of filled elements in the buffer
+    unsigned long long nvalues; ///< Number of values obtained from the generator
+    TestArena *arena; ///< Arena of the thread that created the state (may be NULL)
 } GeneratorState;
 
 GeneratorState GeneratorState_create(const GeneratorInfo *gi,
     const CallerAPI *intf);
 void GeneratorInfo_print(const GeneratorInfo *gi, int to_stderr);
 void GeneratorState_destruct(GeneratorState *obj);
+unsigned long long GeneratorState_get_nbytes_unused(void);
 int GeneratorState_check_size(const GeneratorState *obj);
+void GeneratorState_refill(GeneratorState *obj);
+void GeneratorState_discard(GeneratorState *obj, unsigned long long n);
+void GeneratorState_get_array(GeneratorState *obj, uint64_t *x, size_t n);
+unsigned int GeneratorState_create_substreams(GeneratorState *out, size_t n,
+    const GeneratorInfo *gi, const CallerAPI *intf, const unsigned int *log2_dists);
+
+/**
+ * @brief Test kernel for the split/merge mode: processes `nitems` items
+ * (values, gaps, points etc.) and adds frequencies of some events
+ * to the `counts` array.
+ * @return 1 - success, 0 - the test should be stopped (e.g. the generator
+ * output is obviously broken).
+ */
+typedef int (*CountsKernelFunc)(GeneratorState *obj, unsigned long long *counts,
+    unsigned long long nitems, const void *udata);
+
+int GeneratorState_collect_counts(GeneratorState *obj, CountsKernelFunc kernel,
+    const void *udata, unsigned long long *counts, size_t ncounts,
+    unsigned long long nitems);
+
+/**
+ * @brief Returns the next u32/u64 number from the generator
+ * using the block buffer.
+ */
+static inline uint64_t GeneratorState_get_bits(GeneratorState *obj)
+{
+    if (obj->buf_pos >= obj->buf_len) {
+        GeneratorState_refill(obj);
+    }
+    return obj->buf[obj->buf_pos++];
+}
+
+/**
+ * @brief Returns the number of u32/u64 values consumed by the test, i.e.
+ * returned by `GeneratorState_get_bits`.
+ */
+static inline unsigned long long GeneratorState_get_nvalues(const GeneratorState *obj)
+{
+    return obj->nvalues - (obj->buf_len - obj->buf_pos);
+}
 
 typedef struct
 {
@@ -81,6 +163,10 @@ typedef struct {
     double x; ///< Empirical random value
     double penalty; ///< Penalty score for failure
     uint64_t thread_id; ///< Thread ID for logging
+    double wall_time; ///< Wall time, seconds
+    double cpu_time; ///< CPU time of the test thread, seconds
+    unsigned long long nvalues; ///< Number of consumed generator outputs
+    unsigned long long nbytes; ///< Number of consumed bytes
 } TestResults;
 
 
@@ -92,6 +178,15 @@ typedef enum {
     REPORT_FULL = 1
 } ReportType;
 
+/**
+ * @brief Format of the machine-readable report saved to the file.
+ */
+typedef enum {
+    REPORT_FORMAT_TEXT = 0, ///< Only the text report (no file)
+    REPORT_FORMAT_JSON = 1,
+    REPORT_FORMAT_CSV = 2
+} ReportFormat;
+
 /**
  * @brief Exit codes for battries
  */
@@ -103,6 +198,36 @@ typedef enum {
 } BatteryExitCode;
 
 
+/**
+ * @brief Optional properties of the test function used by the battery
+ * runner. They are declared by the module that implements the test.
+ */
+typedef struct {
+    size_t (*memory)(const void *udata); ///< Estimated peak memory consumption, bytes (NULL - only small buffers)
+    int is_pipelined; ///< 1 - reads the output sequentially, may share the stream (see `--pipeline`)
+    size_t opts_size; ///< Size of the options structure, bytes (for `scale`)
+    void (*scale)(void *opts, unsigned int shr); ///< Divides the sample size by 2^shr (NULL - not scalable)
+} TestTraits;
+
+/**
+ * @brief Defines a function that divides the sample size (the `field`
+ * of the options structure) by \f$ 2^{shr} \f$, see TestTraits::scale.
+ */
+#define OPTIONS_SCALE_FUNC_TPL(Type, field) \
+static void Type##_scale(void *opts, unsigned int shr) \
+{ \
+    Type *obj = opts; \
+    obj->field >>= shr; \
+    if (obj->field == 0) { \
+        obj->field = 1; \
+    } \
+}
+
+/**
+ * @brief Initializer of the TestTraits fields for the sample size scaling.
+ */
+#define TEST_TRAITS_SCALER(Type) .opts_size = sizeof(Type), .scale = Type##_scale
+
 /**
  * @brief Test generalized description.
  */
@@ -110,6 +235,8 @@ typedef struct {
     const char *name;
     TestResults (*run)(GeneratorState *obj, const void *udata);
     const void *udata; ///< User data for the function
+    unsigned int cost; ///< Expected running time (seconds for a fast PRNG), 0 if unknown
+    const TestTraits *traits; ///< Properties of the test (NULL - defaults)
 } TestDescription;
 
 
@@ -138,6 +265,15 @@ typedef struct {
     unsigned int nthreads;
     ReportType report_type;
     const char *param;
+    ReportFormat report_format; ///< Format of the machine-readable report
+    const char *report_file; ///< Report file name (NULL - default name)
+    int pipeline; ///< 1 - run stream tests in the pipelined mode (one shared generator)
+    unsigned int progressive; ///< Number of sample size halvings in the progressive mode (0 - off)
+    double fail_pvalue; ///< Failure threshold for the progressive mode (0 - default)
+    unsigned int nsplits; ///< Substreams for the split/merge mode (0 or 1 - off)
+    size_t mem_limit; ///< Memory budget for tests in the multithreaded mode, bytes (0 - auto)
+    int pin_threads; ///< 1 - pin worker threads to CPU cores (NUMA-aware)
+    int static_schedule; ///< 1 - fixed assignment of tests to threads (for shared inputs)
 } BatteryOptions;
 
 
@@ -155,6 +291,11 @@ typedef enum {
     PVALUE_FAILED = 2
 } PValueCategory;
 
+/**
+ * @brief Default p-value threshold for the failed tests.
+ */
+#define PVALUE_FAIL_DEFAULT 1.0e-10
+
 const char *interpret_pvalue(double pvalue);
 PValueCategory get_pvalue_category(double pvalue);
 void quicksort64(uint64_t *x, size_t len);
@@ -162,8 +303,10 @@ void quicksort32(uint32_t *x, size_t len);
 void radixsort32(uint32_t *x, size_t len);
 void radixsort32_inplace(uint32_t *x, size_t len);
 void radixsort64_inplace(uint64_t *x, size_t len);
+void radixsort64_inplace_mt(uint64_t *x, size_t len, unsigned int nthreads);
 void fastsort32(uint32_t *x, size_t len);
 void fastsort64(uint64_t *x, size_t len);
+void fastsort64_mt(uint64_t *x, size_t len, unsigned int nthreads);
 
 typedef struct {
     void *original_state;
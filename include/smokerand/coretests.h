@@ -32,6 +32,7 @@ typedef struct {
     unsigned long nsamples; ///< Number of samples.
     unsigned long n; ///< Sample length.
     int get_lower; ///< 0/1 - use lower/higher part of PRNG output.
+    unsigned int nthreads; ///< Threads for sorting (0 or 1 - no threads).
 } CollOverNDOptions;
 
 enum {
@@ -118,6 +119,21 @@ TestResults nbit_words_freq_test(GeneratorState *obj,
 TestResults byte_freq_test(GeneratorState *obj);
 TestResults word16_freq_test(GeneratorState *obj);
 
+/**
+ * @brief Histograms for LSD radix sort of small 32-bit arrays (3 passes
+ * with 11-bit digits). They occupy 24 KiB and are kept in L1 cache together
+ * with the sorted sample, unlike 16-bit counting sort used by `fastsort32`.
+ */
+typedef struct {
+    uint32_t counts[3][2048];
+} BSpace32SortHist;
+
+// Block kernels (exported for checking them against reference versions)
+void bspace32_sort_small(uint32_t *x, uint32_t *tmp, size_t len,
+    BSpace32SortHist *h);
+void mod3_residues_block(uint32_t *r, const uint64_t *x, size_t n);
+void mod3_residues_block_portable(uint32_t *r, const uint64_t *x, size_t n);
+
 
 // Unified interfaces that can be used for batteries composition
 TestResults monobit_freq_test_wrap(GeneratorState *obj, const void *udata);
@@ -131,4 +147,15 @@ TestResults gap_test_wrap(GeneratorState *obj, const void *udata);
 TestResults gap16_count0_test_wrap(GeneratorState *obj, const void *udata);
 TestResults mod3_test_wrap(GeneratorState *obj, const void *udata);
 TestResults sumcollector_test_wrap(GeneratorState *obj, const void *udata);
+
+// Properties of tests for the battery runner
+extern const TestTraits bspace_nd_test_traits;
+extern const TestTraits collisionover_test_traits;
+extern const TestTraits sumcollector_test_traits;
+extern const TestTraits monobit_freq_test_traits;
+extern const TestTraits byte_freq_test_traits;
+extern const TestTraits word16_freq_test_traits;
+extern const TestTraits gap_test_traits;
+extern const TestTraits gap16_count0_test_traits;
+extern const TestTraits mod3_test_traits;
 #endif // __SMOKERAND_CORETESTS_H
@@ -15,4 +15,6 @@
 uint64_t cpuclock();
 uint64_t call_rdseed();
 double get_cpu_freq(void);
+double get_wall_time(void);
+double get_thread_cpu_time(void);
 #endif // __SMOKERAND_CPUINFO_H
@@ -31,7 +31,7 @@
  * @brief Entry for seeds logger.
  */
 typedef struct {
-    uint64_t thread_id;
+    uint64_t stream_id; ///< Substream (test) identifier, 0 for the main stream
     uint64_t seed;
 } SeedLogEntry;
 
@@ -97,7 +97,10 @@ int Entropy_init_from_base64_seed(Entropy *obj, const char *seed);
 void Entropy_free(Entropy *obj);
 const uint32_t *Entropy_get_key(const Entropy *obj);
 char *Entropy_get_base64_key(const Entropy *obj);
-uint64_t Entropy_seed64(Entropy *obj, uint64_t thread_id);
+uint64_t Entropy_seed64(Entropy *obj, uint64_t stream_id);
+void Entropy_init_substream(Entropy *obj, ChaCha20State *gen, uint64_t stream_id);
+void Entropy_log_substream(Entropy *obj, uint64_t stream_id, size_t nseeds);
+void Entropy_unlog_substream(Entropy *obj, size_t pos, uint64_t stream_id);
 void Entropy_print_seeds_log(const Entropy *obj, FILE *fp);
 int fill_from_random_device(unsigned char *out, size_t len);
 
@@ -26,6 +26,7 @@ typedef struct {
     uint64_t mvalue; ///< Required value in the lower (e - 1) bits
     int is_dynamic_mvalue;
     unsigned int niters_max; ///< Maximal number of iterations
+    unsigned int nthreads; ///< Number of threads for sorting
 } CollOver64DecimatedOptions;
 
 
@@ -63,6 +64,8 @@ TestResults unit_sphere_volume_test(GeneratorState *gs, const UnitSphereOptions
 TestResults ising2d_test_wrap(GeneratorState *obj, const void *udata);
 TestResults unit_sphere_volume_test_wrap(GeneratorState *gs, const void *udata);
 
+extern const TestTraits unit_sphere_volume_test_traits;
+
 
 BatteryExitCode battery_collover64_decimated(const GeneratorInfo *gen, const CallerAPI *intf,
     const BatteryOptions *bat_opts);
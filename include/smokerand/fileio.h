@@ -1,6 +1,7 @@
 /**
  * @file fileio.h
- * @brief Implementation of PRNG based on reading binary data from stdin.
+ * @brief Implementation of PRNG based on reading binary data from stdin
+ * or from a file.
  * @copyright
  * (c) 2024-2025 Alexey L. Voskov, Lomonosov Moscow State University.
  * alvoskov@gmail.com
@@ -17,5 +18,11 @@ typedef enum {
 } StdinCollectorType;
 
 GeneratorInfo StdinCollector_get_info(StdinCollectorType type);
+GeneratorInfo StdinCollector_get_file_info(StdinCollectorType type, const char *filename);
+unsigned int StdinCollector_open(unsigned int nlanes, unsigned int nlanes_stream);
+void StdinCollector_close(void);
+unsigned long long StdinCollector_get_nbytes_consumed(void);
+unsigned long long StdinCollector_get_nbytes_available(void);
+void StdinCollector_print_source_info(void);
 void StdinCollector_print_report(void);
 #endif // __SMOKERAND_FILEIO_H
@@ -70,9 +70,22 @@ TestResults hamming_ot_test(GeneratorState *obj, const HammingOtOptions *opts);
 TestResults hamming_ot_long_test(GeneratorState *obj, const HammingOtLongOptions *opts);
 TestResults hamming_distr_test(GeneratorState *obj, const HammingDistrOptions *opts);
 
+// Block kernels (exported for checking their vectorized versions)
+void hamming_bytes_to_codes(uint8_t *codes, const uint8_t *bytes,
+    size_t n, const uint8_t *hw_to_code);
+void hamming_bytes_to_codes_portable(uint8_t *codes, const uint8_t *bytes,
+    size_t n, const uint8_t *hw_to_code);
+unsigned int hamming_xorsum_u64(const uint64_t *a, const uint64_t *b, size_t n);
+unsigned int hamming_xorsum_u64_portable(const uint64_t *a, const uint64_t *b, size_t n);
+
 // Unified interfaces that can be used for batteries composition
 TestResults hamming_ot_test_wrap(GeneratorState *obj, const void *udata);
 TestResults hamming_ot_long_test_wrap(GeneratorState *obj, const void *udata);
 TestResults hamming_distr_test_wrap(GeneratorState *obj, const void *udata);
 
+// Properties of tests for the battery runner
+extern const TestTraits hamming_ot_test_traits;
+extern const TestTraits hamming_ot_long_test_traits;
+extern const TestTraits hamming_distr_test_traits;
+
 #endif // __SMOKERAND_HWTESTS_H
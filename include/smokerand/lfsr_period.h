@@ -17,11 +17,13 @@
 #include "smokerand/core.h"
 
 enum {
-    LFSR_NBYTES_DEFAULT = 0
+    LFSR_NBYTES_DEFAULT = 0,
+    LFSR_JUMP_NBITS_MAX = 1024 ///< Maximal state size for LfsrJump, bits
 };
 
 typedef struct {
     int check_validity;
+    unsigned int nthreads; ///< Threads for matrix products (0 or 1 - no threads)
 } LfsrPeriodOptions;
 
 
@@ -48,10 +50,14 @@ typedef struct {
 /**
  * @brief Square matrix over the GF(2) field that represents the LFSR
  * transition function.
+ * @details Rows are packed into 64-bit words: the (i, j) element is
+ * the `(j % 64)`-th bit of the `x[i*nwords + j/64]` word. Unused bits
+ * in the last word of each row are always zero.
  */
 typedef struct {
-    uint8_t *x; ///< Pointer to the data
-    size_t n;   ///< Matrix size (n x n)
+    uint64_t *x;   ///< Pointer to the data
+    size_t n;      ///< Matrix size (n x n)
+    size_t nwords; ///< Number of 64-bit words per row
 } LfsrMatrix;
 
 
@@ -66,6 +72,16 @@ typedef struct {
     size_t nwords; ///< Number of 64-bit words used for storage
 } LfsrPoly;
 
+/**
+ * @brief A generic jump for LFSR based generators that don't supply
+ * their own `jump` callback. The jump polynomial is deduced from the
+ * generator transition function.
+ */
+typedef struct {
+    LfsrPoly jump_poly; ///< Jump polynomial for \f$ 2^d \f$ steps
+    size_t nbytes; ///< Generator state size in bytes
+} LfsrJump;
+
 
 // GeneratorStateExt functions
 GeneratorStateExt
@@ -84,6 +100,12 @@ LfsrPoly GeneratorStateExt_get_jump_poly_pow2(GeneratorStateExt *obj, unsigned i
 void GeneratorStateExt_apply_jump_poly(GeneratorStateExt *obj, const LfsrPoly *jump_poly);
 void GeneratorStateExt_make_jump_pow2(GeneratorStateExt *obj, unsigned int p);
 
+// LfsrJump functions
+int LfsrJump_init(LfsrJump *obj, const GeneratorInfo *gi, const CallerAPI *intf,
+    unsigned int log2_dist);
+void LfsrJump_apply(const LfsrJump *obj, GeneratorState *gen);
+void LfsrJump_destruct(LfsrJump *obj);
+
 // LargeInt functions
 LargeInt LargeInt_from_u64(uint64_t x);
 LargeInt LargeInt_from_pow2(unsigned int p);
@@ -126,24 +148,32 @@ static inline int LfsrPoly_getbit(const LfsrPoly *obj, size_t ind)
 // LfsrMatrix functions
 LfsrMatrix LfsrMatrix_create(size_t n);
 LfsrMatrix LfsrMatrix_create_prod(const LfsrMatrix *a, const LfsrMatrix *b);
+LfsrMatrix LfsrMatrix_create_prod_mt(const LfsrMatrix *a, const LfsrMatrix *b,
+    unsigned int nthreads);
 int LfsrMatrix_are_equal(const LfsrMatrix *a, const LfsrMatrix *b);
 int LfsrMatrix_is_eye(const LfsrMatrix *a);
 LfsrMatrix LfsrMatrix_clone(const LfsrMatrix *obj);
 void LfsrMatrix_destruct(LfsrMatrix *obj);
-LfsrMatrix LfsrMatrix_create_pow(const LfsrMatrix *x, const LargeInt *e);
+LfsrMatrix LfsrMatrix_create_pow(const LfsrMatrix *x, const LargeInt *e,
+    unsigned int nthreads);
 void LfsrMatrix_print(const LfsrMatrix *obj, const CallerAPI *intf);
-int LfsrMatrix_is_period_possible(const LfsrMatrix *mat, const LargeInt *period);
+int LfsrMatrix_is_period_possible(const LfsrMatrix *mat, const LargeInt *period,
+    unsigned int nthreads);
 LfsrMatrix LfsrMatrix_get_krylov_matrix(const LfsrMatrix *mat);
-LfsrPoly LfsrMatrix_krylov_to_charpoly(LfsrMatrix *mat);
+LfsrPoly LfsrMatrix_krylov_to_charpoly(const LfsrMatrix *mat);
+int LfsrMatrix_try_krylov_to_charpoly(const LfsrMatrix *mat, LfsrPoly *poly,
+    size_t *j_singular);
 
 static inline void LfsrMatrix_setbit(LfsrMatrix *obj, size_t i, size_t j, uint8_t val)
 {
-    obj->x[i*obj->n + j] = (val == 0) ? 0 : 1;
+    const uint64_t mask = 1ULL << (j & 0x3FU);
+    uint64_t *w = &obj->x[i*obj->nwords + (j >> 6)];
+    *w = (val == 0) ? (*w & ~mask) : (*w | mask);
 }
 
 static inline uint8_t LfsrMatrix_getbit(const LfsrMatrix *obj, size_t i, size_t j)
 {
-    return obj->x[i*obj->n + j];
+    return (uint8_t) ((obj->x[i*obj->nwords + (j >> 6)] >> (j & 0x3FU)) & 1);
 }
 
 
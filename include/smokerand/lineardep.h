@@ -41,6 +41,7 @@ typedef struct {
     int bitpos; ///< Bit position (0 is the lowest).
 } LinearCompOptions;
 
+size_t berlekamp_massey(const uint64_t *s, size_t n);
 TestResults linearcomp_test(GeneratorState *obj, const LinearCompOptions *opts);
 TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts);
 
@@ -48,5 +49,8 @@ TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts);
 TestResults linearcomp_test_wrap(GeneratorState *obj, const void *udata);
 TestResults matrixrank_test_wrap(GeneratorState *obj, const void *udata);
 
+// Properties of tests for the battery runner
+extern const TestTraits matrixrank_test_traits;
+
 #endif // __SMOKERAND_LINEARDEP_H
 
@@ -57,6 +57,12 @@ typedef struct {
 typedef void* ThreadRetVal;
 #define THREADFUNC_SPEC
 
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int value;
+} Semaphore;
+
 //---------------------------------------------------------------------------------
 // WinAPI version
 #elif defined(USE_WINTHREADS)
@@ -86,6 +92,10 @@ typedef struct {
 typedef DWORD ThreadRetVal;
 #define THREADFUNC_SPEC WINAPI
 
+typedef struct {
+    HANDLE handle;
+} Semaphore;
+
 //---------------------------------------------------------------------------------
 // Stubs for a plaform without threads
 #else
@@ -106,19 +116,60 @@ typedef struct {
 
 typedef int ThreadRetVal;
 #define THREADFUNC_SPEC
+
+typedef struct {
+    unsigned int value;
+} Semaphore;
 #endif
 
 ///////////////////////////////
 ///// Cross-platform part /////
 ///////////////////////////////
 
+/**
+ * @brief Storage class for thread-local variables. Without multithreading
+ * API the variables are just static.
+ */
+#if defined(USE_WINTHREADS) && defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(USE_PTHREADS) || defined(USE_WINTHREADS)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
+/**
+ * @brief Maximal number of worker threads (ordinals 1..NTHREADS_MAX,
+ * 0 is the main thread).
+ */
+#define NTHREADS_MAX 256
+
+/**
+ * @brief The first ordinal of helper threads, i.e. threads started by tests
+ * and data sources (substreams, sorting, readers). Helper ordinals never
+ * collide with ordinals of the worker threads, so the per-worker tables
+ * (seeders, arenas, logs) are not shared with helpers.
+ */
+#define THREAD_ORD_HELPER (NTHREADS_MAX + 1)
+
 typedef ThreadRetVal (THREADFUNC_SPEC *ThreadFuncPtr)(void *);
 
+/**
+ * @brief Function called by each thread created by ThreadObj_create
+ * after its thread function returns (see ThreadObj_set_exit_handler).
+ */
+typedef void (*ThreadExitFuncPtr)(unsigned int ord);
+
 void init_thread_dispatcher(void);
 ThreadObj ThreadObj_create(ThreadFuncPtr thr_func, void *udata, unsigned int ord);
+void ThreadObj_set_exit_handler(ThreadExitFuncPtr handler);
 int ThreadObj_equal(const ThreadObj *a, const ThreadObj *b);
 void ThreadObj_wait(ThreadObj *obj);
 ThreadObj ThreadObj_current(void);
+void Semaphore_init(Semaphore *obj, unsigned int value);
+void Semaphore_wait(Semaphore *obj);
+void Semaphore_post(Semaphore *obj);
+void Semaphore_destruct(Semaphore *obj);
 
 //------------------------------------------------------------------------------------
 
@@ -133,6 +184,24 @@ void *dlsym_wrap(void *handle, const char *symname);
 void dlclose_wrap(void *handle);
 unsigned int get_cpu_numcores(void);
 int get_ram_info(RamInfo *info);
+
+/**
+ * @brief Placement of the thread: logical CPU and NUMA node.
+ */
+typedef struct {
+    int cpu; ///< Logical CPU index (-1 if unknown)
+    int node; ///< NUMA node index (-1 if unknown)
+} ThreadPlacement;
+
+int pin_current_thread(unsigned int ind, ThreadPlacement *pl);
+
+/**
+ * @brief Huge page size used for rounding of large_pages_alloc requests.
+ */
+#define LARGE_PAGE_SIZE ((size_t) 1 << 21)
+
+void *large_pages_alloc(size_t len, int *is_huge);
+void large_pages_free(void *ptr, size_t len);
 void set_bin_stdout(void);
 void set_bin_stdin(void);
 
@@ -39,6 +39,31 @@ static inline __m256i mm256_rotr_epi64_def(__m256i in, int r)
         _mm256_srli_epi64(in, r)
     );
 }
+
+/**
+ * @brief Vectorized population count (Hamming weight) for vector of 8-bit
+ * values: weights of lower and higher nibbles are found by `vpshufb` lookups.
+ */
+static inline __m256i mm256_popcnt_epi8_def(__m256i in)
+{
+    const __m256i lut = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i mask4 = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_and_si256(in, mask4);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 4), mask4);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo),
+        _mm256_shuffle_epi8(lut, hi));
+}
+
+/**
+ * @brief Vectorized population count (Hamming weight) for vector of 64-bit
+ * values: weights of bytes are summed by the `vpsadbw` instruction.
+ */
+static inline __m256i mm256_popcnt_epi64_def(__m256i in)
+{
+    return _mm256_sad_epu8(mm256_popcnt_epi8_def(in), _mm256_setzero_si256());
+}
 #endif // __AVX2__
 
 #endif // __SMOKERAND_X86EXTS_H
@@ -77,32 +77,32 @@ BatteryExitCode battery_brief(const GeneratorInfo *gen, const CallerAPI *intf,
     static const Mod3Options mod3 = {.nvalues = 1ull << 26};
 
     static const TestDescription tests[] = {
-        {"monobit_freq",      monobit_freq_test_wrap, &monobit},
-        {"byte_freq",         byte_freq_test_wrap, NULL},
-        {"bspace64_1d",       bspace_nd_test_wrap, &bspace64_1d},
-        {"bspace32_1d",       bspace_nd_test_wrap, &bspace32_1d},
-        {"bspace32_1d_high",  bspace_nd_test_wrap, &bspace32_1d_high},
-        {"bspace32_2d",       bspace_nd_test_wrap, &bspace32_2d},
-        {"bspace21_3d",       bspace_nd_test_wrap, &bspace21_3d},
-        {"bspace16_4d",       bspace_nd_test_wrap, &bspace16_4d},
-        {"bspace8_8d",        bspace_nd_test_wrap, &bspace8_8d},
-        {"bspace4_8d_dec",    bspace4_8d_decimated_test_wrap, &bs_dec},
-        {"collover20_2d",     collisionover_test_wrap, &collover20_2d},
-        {"collover13_3d",     collisionover_test_wrap, &collover13_3d},
-        {"collover8_5d",      collisionover_test_wrap, &collover8_5d},
-        {"collover5_8d",      collisionover_test_wrap, &collover5_8d},
-        {"gap_inv8",          gap_test_wrap, &gap_inv8},
-        {"gap_inv512",        gap_test_wrap, &gap_inv512},
-        {"gap16_count0",      gap16_count0_test_wrap, &gap16_count0},
-        {"hamming_distr",     hamming_distr_test_wrap, &hw_distr},
-        {"hamming_ot_low1",   hamming_ot_test_wrap, &hw_ot_low1},
-        {"hamming_ot_values", hamming_ot_test_wrap, &hw_ot_values},
-        {"hamming_ot_u128",   hamming_ot_long_test_wrap, &hw_ot_long128},
-        {"linearcomp_high",   linearcomp_test_wrap, &linearcomp_high},
-        {"linearcomp_mid",    linearcomp_test_wrap, &linearcomp_mid},
-        {"linearcomp_low",    linearcomp_test_wrap, &linearcomp_low},
-        {"mod3",              mod3_test_wrap,       &mod3},
-        {NULL, NULL, NULL}
+        {"monobit_freq",      monobit_freq_test_wrap, &monobit, 4, &monobit_freq_test_traits},
+        {"byte_freq",         byte_freq_test_wrap, NULL, 2, &byte_freq_test_traits},
+        {"bspace64_1d",       bspace_nd_test_wrap, &bspace64_1d, 70, &bspace_nd_test_traits},
+        {"bspace32_1d",       bspace_nd_test_wrap, &bspace32_1d, 2, &bspace_nd_test_traits},
+        {"bspace32_1d_high",  bspace_nd_test_wrap, &bspace32_1d_high, 2, &bspace_nd_test_traits},
+        {"bspace32_2d",       bspace_nd_test_wrap, &bspace32_2d, 5, &bspace_nd_test_traits},
+        {"bspace21_3d",       bspace_nd_test_wrap, &bspace21_3d, 4, &bspace_nd_test_traits},
+        {"bspace16_4d",       bspace_nd_test_wrap, &bspace16_4d, 6, &bspace_nd_test_traits},
+        {"bspace8_8d",        bspace_nd_test_wrap, &bspace8_8d, 6, &bspace_nd_test_traits},
+        {"bspace4_8d_dec",    bspace4_8d_decimated_test_wrap, &bs_dec, 1, NULL},
+        {"collover20_2d",     collisionover_test_wrap, &collover20_2d, 14, &collisionover_test_traits},
+        {"collover13_3d",     collisionover_test_wrap, &collover13_3d, 16, &collisionover_test_traits},
+        {"collover8_5d",      collisionover_test_wrap, &collover8_5d, 15, &collisionover_test_traits},
+        {"collover5_8d",      collisionover_test_wrap, &collover5_8d, 14, &collisionover_test_traits},
+        {"gap_inv8",          gap_test_wrap, &gap_inv8, 7, &gap_test_traits},
+        {"gap_inv512",        gap_test_wrap, &gap_inv512, 15, &gap_test_traits},
+        {"gap16_count0",      gap16_count0_test_wrap, &gap16_count0, 1, &gap16_count0_test_traits},
+        {"hamming_distr",     hamming_distr_test_wrap, &hw_distr, 2, &hamming_distr_test_traits},
+        {"hamming_ot_low1",   hamming_ot_test_wrap, &hw_ot_low1, 1, &hamming_ot_test_traits},
+        {"hamming_ot_values", hamming_ot_test_wrap, &hw_ot_values, 1, &hamming_ot_test_traits},
+        {"hamming_ot_u128",   hamming_ot_long_test_wrap, &hw_ot_long128, 2, &hamming_ot_long_test_traits},
+        {"linearcomp_high",   linearcomp_test_wrap, &linearcomp_high, 1, NULL},
+        {"linearcomp_mid",    linearcomp_test_wrap, &linearcomp_mid, 1, NULL},
+        {"linearcomp_low",    linearcomp_test_wrap, &linearcomp_low, 1, NULL},
+        {"mod3",              mod3_test_wrap,       &mod3, 1, &mod3_test_traits},
+        {NULL, NULL, NULL, 0, NULL}
     };
 
     const TestsBattery bat = {
@@ -94,51 +94,51 @@ BatteryExitCode battery_default(const GeneratorInfo *gen, const CallerAPI *intf,
     static const Mod3Options mod3 = {.nvalues = 1ull << 28};
 
     static const TestDescription tests[] = {
-        {"monobit_freq",         monobit_freq_test_wrap, &monobit},
-        {"byte_freq",            byte_freq_test_wrap, NULL},
-        {"word16_freq",          word16_freq_test_wrap, NULL},
-        {"bspace64_1d",          bspace_nd_test_wrap, &bspace64_1d},
-        {"bspace32_1d",          bspace_nd_test_wrap, &bspace32_1d},
-        {"bspace32_1d_high",     bspace_nd_test_wrap, &bspace32_1d_high},
-        {"bspace32_2d",          bspace_nd_test_wrap, &bspace32_2d},
-        {"bspace32_2d_high",     bspace_nd_test_wrap, &bspace32_2d_high},
-        {"bspace21_3d",          bspace_nd_test_wrap, &bspace21_3d},
-        {"bspace21_3d_high",     bspace_nd_test_wrap, &bspace21_3d_high},
-        {"bspace16_4d",          bspace_nd_test_wrap, &bspace16_4d},
-        {"bspace16_4d_high",     bspace_nd_test_wrap, &bspace16_4d_high},
-        {"bspace8_8d",           bspace_nd_test_wrap, &bspace8_8d},
-        {"bspace8_8d_high",      bspace_nd_test_wrap, &bspace8_8d_high},
-        {"bspace4_8d_dec",       bspace4_8d_decimated_test_wrap, &bs_dec},
-        {"bspace4_16d",          bspace_nd_test_wrap, &bspace4_16d},
-        {"bspace4_16d_high",     bspace_nd_test_wrap, &bspace4_16d_high},
-        {"collover20_2d",        collisionover_test_wrap, &collover20_2d},
-        {"collover20_2d_high",   collisionover_test_wrap, &collover20_2d_high},
-        {"collover13_3d",        collisionover_test_wrap, &collover13_3d},
-        {"collover13_3d_high",   collisionover_test_wrap, &collover13_3d_high},
-        {"collover8_5d",         collisionover_test_wrap, &collover8_5d},
-        {"collover8_5d_high",    collisionover_test_wrap, &collover8_5d_high},
-        {"collover5_8d",         collisionover_test_wrap, &collover5_8d},
-        {"collover5_8d_high",    collisionover_test_wrap, &collover5_8d_high},
-        {"collover2_20d",        collisionover_test_wrap, &collover2_20d},
-        {"collover2_20d_high",   collisionover_test_wrap, &collover2_20d_high},
-        {"gap_inv8",             gap_test_wrap, &gap_inv8},
-        {"gap_inv512",           gap_test_wrap, &gap_inv512},
-        {"gap16_count0",         gap16_count0_test_wrap, &gap16_count0},
-        {"hamming_distr",        hamming_distr_test_wrap, &hw_distr},
-        {"hamming_ot",           hamming_ot_test_wrap, &hw_ot_all},
-        {"hamming_ot_low1",      hamming_ot_test_wrap, &hw_ot_low1},
-        {"hamming_ot_low8",      hamming_ot_test_wrap, &hw_ot_low8},
-        {"hamming_ot_values",    hamming_ot_test_wrap, &hw_ot_values},
-        {"hamming_ot_u128",      hamming_ot_long_test_wrap, &hw_ot_long128},
-        {"hamming_ot_u256",      hamming_ot_long_test_wrap, &hw_ot_long256},
-        {"hamming_ot_u512",      hamming_ot_long_test_wrap, &hw_ot_long512},
-        {"linearcomp_high",      linearcomp_test_wrap, &linearcomp_high},
-        {"linearcomp_mid",       linearcomp_test_wrap, &linearcomp_mid},
-        {"linearcomp_low",       linearcomp_test_wrap, &linearcomp_low},
-        {"matrixrank_4096",      matrixrank_test_wrap, &matrixrank_4096},
-        {"matrixrank_4096_low8", matrixrank_test_wrap, &matrixrank_4096_low8},
-        {"mod3", mod3_test_wrap, &mod3},
-        {NULL, NULL, NULL}
+        {"monobit_freq",         monobit_freq_test_wrap, &monobit, 2, &monobit_freq_test_traits},
+        {"byte_freq",            byte_freq_test_wrap, NULL, 1, &byte_freq_test_traits},
+        {"word16_freq",          word16_freq_test_wrap, NULL, 12, &word16_freq_test_traits},
+        {"bspace64_1d",          bspace_nd_test_wrap, &bspace64_1d, 100, &bspace_nd_test_traits},
+        {"bspace32_1d",          bspace_nd_test_wrap, &bspace32_1d, 2, &bspace_nd_test_traits},
+        {"bspace32_1d_high",     bspace_nd_test_wrap, &bspace32_1d_high, 2, &bspace_nd_test_traits},
+        {"bspace32_2d",          bspace_nd_test_wrap, &bspace32_2d, 9, &bspace_nd_test_traits},
+        {"bspace32_2d_high",     bspace_nd_test_wrap, &bspace32_2d_high, 10, &bspace_nd_test_traits},
+        {"bspace21_3d",          bspace_nd_test_wrap, &bspace21_3d, 7, &bspace_nd_test_traits},
+        {"bspace21_3d_high",     bspace_nd_test_wrap, &bspace21_3d_high, 8, &bspace_nd_test_traits},
+        {"bspace16_4d",          bspace_nd_test_wrap, &bspace16_4d, 11, &bspace_nd_test_traits},
+        {"bspace16_4d_high",     bspace_nd_test_wrap, &bspace16_4d_high, 12, &bspace_nd_test_traits},
+        {"bspace8_8d",           bspace_nd_test_wrap, &bspace8_8d, 12, &bspace_nd_test_traits},
+        {"bspace8_8d_high",      bspace_nd_test_wrap, &bspace8_8d_high, 11, &bspace_nd_test_traits},
+        {"bspace4_8d_dec",       bspace4_8d_decimated_test_wrap, &bs_dec, 23, NULL},
+        {"bspace4_16d",          bspace_nd_test_wrap, &bspace4_16d, 12, &bspace_nd_test_traits},
+        {"bspace4_16d_high",     bspace_nd_test_wrap, &bspace4_16d_high, 12, &bspace_nd_test_traits},
+        {"collover20_2d",        collisionover_test_wrap, &collover20_2d, 25, &collisionover_test_traits},
+        {"collover20_2d_high",   collisionover_test_wrap, &collover20_2d_high, 24, &collisionover_test_traits},
+        {"collover13_3d",        collisionover_test_wrap, &collover13_3d, 25, &collisionover_test_traits},
+        {"collover13_3d_high",   collisionover_test_wrap, &collover13_3d_high, 27, &collisionover_test_traits},
+        {"collover8_5d",         collisionover_test_wrap, &collover8_5d, 24, &collisionover_test_traits},
+        {"collover8_5d_high",    collisionover_test_wrap, &collover8_5d_high, 24, &collisionover_test_traits},
+        {"collover5_8d",         collisionover_test_wrap, &collover5_8d, 25, &collisionover_test_traits},
+        {"collover5_8d_high",    collisionover_test_wrap, &collover5_8d_high, 25, &collisionover_test_traits},
+        {"collover2_20d",        collisionover_test_wrap, &collover2_20d, 23, &collisionover_test_traits},
+        {"collover2_20d_high",   collisionover_test_wrap, &collover2_20d_high, 25, &collisionover_test_traits},
+        {"gap_inv8",             gap_test_wrap, &gap_inv8, 21, &gap_test_traits},
+        {"gap_inv512",           gap_test_wrap, &gap_inv512, 16, &gap_test_traits},
+        {"gap16_count0",         gap16_count0_test_wrap, &gap16_count0, 10, &gap16_count0_test_traits},
+        {"hamming_distr",        hamming_distr_test_wrap, &hw_distr, 11, &hamming_distr_test_traits},
+        {"hamming_ot",           hamming_ot_test_wrap, &hw_ot_all, 5, &hamming_ot_test_traits},
+        {"hamming_ot_low1",      hamming_ot_test_wrap, &hw_ot_low1, 1, &hamming_ot_test_traits},
+        {"hamming_ot_low8",      hamming_ot_test_wrap, &hw_ot_low8, 1, &hamming_ot_test_traits},
+        {"hamming_ot_values",    hamming_ot_test_wrap, &hw_ot_values, 1, &hamming_ot_test_traits},
+        {"hamming_ot_u128",      hamming_ot_long_test_wrap, &hw_ot_long128, 7, &hamming_ot_long_test_traits},
+        {"hamming_ot_u256",      hamming_ot_long_test_wrap, &hw_ot_long256, 5, &hamming_ot_long_test_traits},
+        {"hamming_ot_u512",      hamming_ot_long_test_wrap, &hw_ot_long512, 6, &hamming_ot_long_test_traits},
+        {"linearcomp_high",      linearcomp_test_wrap, &linearcomp_high, 1, NULL},
+        {"linearcomp_mid",       linearcomp_test_wrap, &linearcomp_mid, 1, NULL},
+        {"linearcomp_low",       linearcomp_test_wrap, &linearcomp_low, 1, NULL},
+        {"matrixrank_4096",      matrixrank_test_wrap, &matrixrank_4096, 7, &matrixrank_test_traits},
+        {"matrixrank_4096_low8", matrixrank_test_wrap, &matrixrank_4096_low8, 8, &matrixrank_test_traits},
+        {"mod3", mod3_test_wrap, &mod3, 1, &mod3_test_traits},
+        {NULL, NULL, NULL, 0, NULL}
     };
 
     const TestsBattery bat = {
@@ -43,14 +43,14 @@ BatteryExitCode battery_express(const GeneratorInfo *gen, const CallerAPI *intf,
         linearcomp_high = {.nbits = 10000, .bitpos = LINEARCOMP_BITPOS_HIGH};
 
     static const TestDescription tests[] = {
-        {"byte_freq",       nbit_words_freq_test_wrap,      &byte_freq},
-        {"bspace32_1d",     bspace_nd_test_wrap,            &bspace32_1d},
-        {"bspace8_4d",      bspace_nd_test_wrap,            &bspace8_4d},
-        {"bspace4_8d",      bspace_nd_test_wrap,            &bspace4_8d},
-        {"bspace4_8d_dec",  bspace4_8d_decimated_test_wrap, &bs_dec},
-        {"linearcomp_high", linearcomp_test_wrap,           &linearcomp_high},
-        {"linearcomp_low",  linearcomp_test_wrap,           &linearcomp_low},
-        {NULL, NULL, NULL}
+        {"byte_freq",       nbit_words_freq_test_wrap,      &byte_freq, 1, NULL},
+        {"bspace32_1d",     bspace_nd_test_wrap,            &bspace32_1d, 1, &bspace_nd_test_traits},
+        {"bspace8_4d",      bspace_nd_test_wrap,            &bspace8_4d, 1, &bspace_nd_test_traits},
+        {"bspace4_8d",      bspace_nd_test_wrap,            &bspace4_8d, 1, &bspace_nd_test_traits},
+        {"bspace4_8d_dec",  bspace4_8d_decimated_test_wrap, &bs_dec, 1, NULL},
+        {"linearcomp_high", linearcomp_test_wrap,           &linearcomp_high, 1, NULL},
+        {"linearcomp_low",  linearcomp_test_wrap,           &linearcomp_low, 1, NULL},
+        {NULL, NULL, NULL, 0, NULL}
     };
 
     const TestsBattery bat = {
@@ -384,6 +384,7 @@ static int parse_bspace_nd(TestDescription *out, const TestInfo *obj, char *errm
     out->name = obj->testname;
     out->run = bspace_nd_test_wrap;
     out->udata = opts;
+    out->traits = &bspace_nd_test_traits;
     return 1;
 }
 
@@ -416,6 +417,7 @@ static int parse_collisionover(TestDescription *out, const TestInfo *obj, char *
 {
     int is_ok = parse_collover_nd(out, obj, errmsg);
     out->run = collisionover_test_wrap;
+    out->traits = &collisionover_test_traits;
     return is_ok;
 }
 
@@ -433,6 +435,7 @@ static int parse_monobit_freq(TestDescription *out, const TestInfo *obj, char *e
     out->name = obj->testname;
     out->run = monobit_freq_test_wrap;
     out->udata = opts;
+    out->traits = &monobit_freq_test_traits;
     return 1;
 }
 
@@ -488,6 +491,7 @@ static int parse_gap(TestDescription *out, const TestInfo *obj, char *errmsg)
     out->name = obj->testname;
     out->run = gap_test_wrap;
     out->udata = opts;
+    out->traits = &gap_test_traits;
     return 1;
 }
 
@@ -504,6 +508,7 @@ static int parse_gap16_count0(TestDescription *out, const TestInfo *obj, char *e
     out->name = obj->testname;
     out->run = gap16_count0_test_wrap;
     out->udata = opts;
+    out->traits = &gap16_count0_test_traits;
     return 1;
 }
 
@@ -522,6 +527,7 @@ static int parse_hamming_distr(TestDescription *out, const TestInfo *obj, char *
     out->name = obj->testname;
     out->run = hamming_distr_test_wrap;
     out->udata = opts;
+    out->traits = &hamming_distr_test_traits;
     return 1;
 }
 
@@ -549,6 +555,7 @@ static int parse_hamming_ot(TestDescription *out, const TestInfo *obj, char *err
     out->name = obj->testname;
     out->run = hamming_ot_test_wrap;
     out->udata = opts;
+    out->traits = &hamming_ot_test_traits;
     return 1;
 }
 
@@ -575,6 +582,7 @@ static int parse_hamming_ot_long(TestDescription *out, const TestInfo *obj, char
     out->name = obj->testname;
     out->run = hamming_ot_long_test_wrap;
     out->udata = opts;
+    out->traits = &hamming_ot_long_test_traits;
     return 1;
 }
 
@@ -627,6 +635,7 @@ static int parse_matrixrank(TestDescription *out, const TestInfo *obj, char *err
     out->name = obj->testname;
     out->run = matrixrank_test_wrap;
     out->udata = opts;
+    out->traits = &matrixrank_test_traits;
     return 1;
 }
 
@@ -642,6 +651,7 @@ static int parse_mod3(TestDescription *out, const TestInfo *obj, char *errmsg)
     out->name = obj->testname;
     out->run = mod3_test_wrap;
     out->udata = opts;
+    out->traits = &mod3_test_traits;
     return 1;
 }
 
@@ -657,6 +667,7 @@ static int parse_sumcollector(TestDescription *out, const TestInfo *obj, char *e
     out->name = obj->testname;
     out->run = sumcollector_test_wrap;
     out->udata = opts;
+    out->traits = &sumcollector_test_traits;
     return 1;
 }
 
@@ -699,6 +710,7 @@ static int parse_usphere(TestDescription *out, const TestInfo *obj, char *errmsg
     out->name = obj->testname;
     out->run = unit_sphere_volume_test_wrap;
     out->udata = opts;
+    out->traits = &unit_sphere_volume_test_traits;
     return 1;
 }
 
@@ -110,57 +110,57 @@ BatteryExitCode battery_full(const GeneratorInfo *gen, const CallerAPI *intf,
     static const SumCollectorOptions sumcoll = {.nvalues = 20000000000};
 
     static const TestDescription tests[] = {
-        {"monobit_freq",         monobit_freq_test_wrap, &monobit},
-        {"byte_freq",            byte_freq_test_wrap, NULL},
-        {"word16_freq",          word16_freq_test_wrap, NULL},
-        {"bspace64_1d",          bspace_nd_test_wrap, &bspace64_1d},
-        {"bspace32_1d",          bspace_nd_test_wrap, &bspace32_1d},
-        {"bspace32_1d_high",     bspace_nd_test_wrap, &bspace32_1d_high},
-        {"bspace32_2d",          bspace_nd_test_wrap, &bspace32_2d},
-        {"bspace32_2d_high",     bspace_nd_test_wrap, &bspace32_2d_high},
-        {"bspace21_3d",          bspace_nd_test_wrap, &bspace21_3d},
-        {"bspace21_3d_high",     bspace_nd_test_wrap, &bspace21_3d_high},
-        {"bspace16_4d",          bspace_nd_test_wrap, &bspace16_4d},
-        {"bspace16_4d_high",     bspace_nd_test_wrap, &bspace16_4d_high},
-        {"bspace8_8d",           bspace_nd_test_wrap, &bspace8_8d},
-        {"bspace8_8d_high",      bspace_nd_test_wrap, &bspace8_8d_high},
-        {"bspace4_8d_dec",       bspace4_8d_decimated_test_wrap, &bs_dec},
-        {"bspace4_16d",          bspace_nd_test_wrap, &bspace4_16d},
-        {"bspace4_16d_high",     bspace_nd_test_wrap, &bspace4_16d_high},
-        {"collover20_2d",        collisionover_test_wrap, &collover20_2d},
-        {"collover20_2d_high",   collisionover_test_wrap, &collover20_2d_high},
-        {"collover13_3d",        collisionover_test_wrap, &collover13_3d},
-        {"collover13_3d_high",   collisionover_test_wrap, &collover13_3d_high},
-        {"collover8_5d",         collisionover_test_wrap, &collover8_5d},
-        {"collover8_5d_high",    collisionover_test_wrap, &collover8_5d_high},
-        {"collover5_8d",         collisionover_test_wrap, &collover5_8d},
-        {"collover5_8d_high",    collisionover_test_wrap, &collover5_8d_high},
-        {"collover3_13d",        collisionover_test_wrap, &collover3_13d},
-        {"collover3_13d_high",   collisionover_test_wrap, &collover3_13d_high},
-        {"collover2_20d",        collisionover_test_wrap, &collover2_20d},
-        {"collover2_20d_high",   collisionover_test_wrap, &collover2_20d_high},
-        {"gap_inv8",             gap_test_wrap, &gap_inv8},
-        {"gap_inv512",           gap_test_wrap, &gap_inv512},
-        {"gap_inv1024",          gap_test_wrap, &gap_inv1024},
-        {"gap16_count0",         gap16_count0_test_wrap, &gap16_count0},
-        {"hamming_distr",        hamming_distr_test_wrap, &hw_distr},
-        {"hamming_ot",           hamming_ot_test_wrap, &hw_ot_all},
-        {"hamming_ot_low1",      hamming_ot_test_wrap, &hw_ot_low1},
-        {"hamming_ot_low8",      hamming_ot_test_wrap, &hw_ot_low8},
-        {"hamming_ot_values",    hamming_ot_test_wrap, &hw_ot_values},
-        {"hamming_ot_u128",      hamming_ot_long_test_wrap, &hw_ot_long128},
-        {"hamming_ot_u256",      hamming_ot_long_test_wrap, &hw_ot_long256},
-        {"hamming_ot_u512",      hamming_ot_long_test_wrap, &hw_ot_long512},
-        {"linearcomp_high",      linearcomp_test_wrap, &linearcomp_high},
-        {"linearcomp_mid",       linearcomp_test_wrap, &linearcomp_mid},
-        {"linearcomp_low",       linearcomp_test_wrap, &linearcomp_low},
-        {"matrixrank_4096",      matrixrank_test_wrap, &matrixrank_4096},
-        {"matrixrank_4096_low8", matrixrank_test_wrap, &matrixrank_4096_low8},
-        {"matrixrank_8192",      matrixrank_test_wrap, &matrixrank_8192},
-        {"matrixrank_8192_low8", matrixrank_test_wrap, &matrixrank_8192_low8},
-        {"mod3",                 mod3_test_wrap, &mod3},
-        {"sumcollector",         sumcollector_test_wrap, &sumcoll},
-        {NULL, NULL, NULL}
+        {"monobit_freq",         monobit_freq_test_wrap, &monobit, 2, &monobit_freq_test_traits},
+        {"byte_freq",            byte_freq_test_wrap, NULL, 1, &byte_freq_test_traits},
+        {"word16_freq",          word16_freq_test_wrap, NULL, 12, &word16_freq_test_traits},
+        {"bspace64_1d",          bspace_nd_test_wrap, &bspace64_1d, 250, &bspace_nd_test_traits},
+        {"bspace32_1d",          bspace_nd_test_wrap, &bspace32_1d, 2, &bspace_nd_test_traits},
+        {"bspace32_1d_high",     bspace_nd_test_wrap, &bspace32_1d_high, 2, &bspace_nd_test_traits},
+        {"bspace32_2d",          bspace_nd_test_wrap, &bspace32_2d, 235, &bspace_nd_test_traits},
+        {"bspace32_2d_high",     bspace_nd_test_wrap, &bspace32_2d_high, 235, &bspace_nd_test_traits},
+        {"bspace21_3d",          bspace_nd_test_wrap, &bspace21_3d, 150, &bspace_nd_test_traits},
+        {"bspace21_3d_high",     bspace_nd_test_wrap, &bspace21_3d_high, 150, &bspace_nd_test_traits},
+        {"bspace16_4d",          bspace_nd_test_wrap, &bspace16_4d, 230, &bspace_nd_test_traits},
+        {"bspace16_4d_high",     bspace_nd_test_wrap, &bspace16_4d_high, 230, &bspace_nd_test_traits},
+        {"bspace8_8d",           bspace_nd_test_wrap, &bspace8_8d, 240, &bspace_nd_test_traits},
+        {"bspace8_8d_high",      bspace_nd_test_wrap, &bspace8_8d_high, 240, &bspace_nd_test_traits},
+        {"bspace4_8d_dec",       bspace4_8d_decimated_test_wrap, &bs_dec, 23, NULL},
+        {"bspace4_16d",          bspace_nd_test_wrap, &bspace4_16d, 250, &bspace_nd_test_traits},
+        {"bspace4_16d_high",     bspace_nd_test_wrap, &bspace4_16d_high, 250, &bspace_nd_test_traits},
+        {"collover20_2d",        collisionover_test_wrap, &collover20_2d, 250, &collisionover_test_traits},
+        {"collover20_2d_high",   collisionover_test_wrap, &collover20_2d_high, 250, &collisionover_test_traits},
+        {"collover13_3d",        collisionover_test_wrap, &collover13_3d, 250, &collisionover_test_traits},
+        {"collover13_3d_high",   collisionover_test_wrap, &collover13_3d_high, 250, &collisionover_test_traits},
+        {"collover8_5d",         collisionover_test_wrap, &collover8_5d, 250, &collisionover_test_traits},
+        {"collover8_5d_high",    collisionover_test_wrap, &collover8_5d_high, 250, &collisionover_test_traits},
+        {"collover5_8d",         collisionover_test_wrap, &collover5_8d, 250, &collisionover_test_traits},
+        {"collover5_8d_high",    collisionover_test_wrap, &collover5_8d_high, 250, &collisionover_test_traits},
+        {"collover3_13d",        collisionover_test_wrap, &collover3_13d, 250, &collisionover_test_traits},
+        {"collover3_13d_high",   collisionover_test_wrap, &collover3_13d_high, 250, &collisionover_test_traits},
+        {"collover2_20d",        collisionover_test_wrap, &collover2_20d, 250, &collisionover_test_traits},
+        {"collover2_20d_high",   collisionover_test_wrap, &collover2_20d_high, 250, &collisionover_test_traits},
+        {"gap_inv8",             gap_test_wrap, &gap_inv8, 41, &gap_test_traits},
+        {"gap_inv512",           gap_test_wrap, &gap_inv512, 16, &gap_test_traits},
+        {"gap_inv1024",          gap_test_wrap, &gap_inv1024, 320, &gap_test_traits},
+        {"gap16_count0",         gap16_count0_test_wrap, &gap16_count0, 21, &gap16_count0_test_traits},
+        {"hamming_distr",        hamming_distr_test_wrap, &hw_distr, 87, &hamming_distr_test_traits},
+        {"hamming_ot",           hamming_ot_test_wrap, &hw_ot_all, 37, &hamming_ot_test_traits},
+        {"hamming_ot_low1",      hamming_ot_test_wrap, &hw_ot_low1, 4, &hamming_ot_test_traits},
+        {"hamming_ot_low8",      hamming_ot_test_wrap, &hw_ot_low8, 8, &hamming_ot_test_traits},
+        {"hamming_ot_values",    hamming_ot_test_wrap, &hw_ot_values, 7, &hamming_ot_test_traits},
+        {"hamming_ot_u128",      hamming_ot_long_test_wrap, &hw_ot_long128, 52, &hamming_ot_long_test_traits},
+        {"hamming_ot_u256",      hamming_ot_long_test_wrap, &hw_ot_long256, 44, &hamming_ot_long_test_traits},
+        {"hamming_ot_u512",      hamming_ot_long_test_wrap, &hw_ot_long512, 49, &hamming_ot_long_test_traits},
+        {"linearcomp_high",      linearcomp_test_wrap, &linearcomp_high, 7, NULL},
+        {"linearcomp_mid",       linearcomp_test_wrap, &linearcomp_mid, 7, NULL},
+        {"linearcomp_low",       linearcomp_test_wrap, &linearcomp_low, 7, NULL},
+        {"matrixrank_4096",      matrixrank_test_wrap, &matrixrank_4096, 7, &matrixrank_test_traits},
+        {"matrixrank_4096_low8", matrixrank_test_wrap, &matrixrank_4096_low8, 8, &matrixrank_test_traits},
+        {"matrixrank_8192",      matrixrank_test_wrap, &matrixrank_8192, 60, &matrixrank_test_traits},
+        {"matrixrank_8192_low8", matrixrank_test_wrap, &matrixrank_8192_low8, 64, &matrixrank_test_traits},
+        {"mod3",                 mod3_test_wrap, &mod3, 5, &mod3_test_traits},
+        {"sumcollector",         sumcollector_test_wrap, &sumcoll, 30, &sumcollector_test_traits},
+        {NULL, NULL, NULL, 0, NULL}
     };
 
     const TestsBattery bat = {
@@ -11,7 +11,9 @@
  */
 #include "smokerand/base64.h"
 #include "smokerand/core.h"
+#include "smokerand/cpuinfo.h"
 #include "smokerand/entropy.h"
+#include "smokerand/lfsr_period.h"
 #include "smokerand/specfuncs.h"
 #include "smokerand/threads_intf.h"
 #include "smokerand/version.h"
@@ -30,7 +32,69 @@ static Entropy entropy = ENTROPY_INITIALIZER;
 static char cmd_param[128] = {0};
 static int use_stderr_for_printf = 0;
 static int use_mutexes = 0;
-static unsigned int seed64_mt_current_thread_ord = 0;
+static unsigned int test_nsplits = 1;
+/// Values read into the block buffers of destroyed generator states but
+/// not consumed by tests, in bytes (see GeneratorState_get_nbytes_unused).
+static unsigned long long generators_nbytes_unused = 0;
+
+/**
+ * @brief Seeds generator for the test that is running in the given thread.
+ * @details It is a ChaCha20 substream keyed by the battery key (seed) with
+ * the test index used as a nonce, so the test results don't depend on the
+ * order of tests and on the number of threads. Each thread uses only its own
+ * seeder, so no mutexes are required.
+ */
+typedef struct {
+    ChaCha20State gen; ///< ChaCha20 substream
+    size_t test_id; ///< 1-based test index (0 - seeder is not used)
+    size_t nseeds; ///< Number of returned seeds
+} TestSeeder;
+
+/// Seeders indexed by thread ordinals (0 is the main thread).
+static TestSeeder test_seeders[NTHREADS_MAX + 1];
+
+
+/**
+ * @brief Returns seeder of the test running in the thread with the given
+ * ordinal or NULL if there is no such test.
+ */
+static inline TestSeeder *get_test_seeder(unsigned int thread_ord)
+{
+    if (thread_ord > NTHREADS_MAX || test_seeders[thread_ord].test_id == 0) {
+        return NULL;
+    }
+    return &test_seeders[thread_ord];
+}
+
+/**
+ * @brief Turns on the per-test seeds generator for the given thread.
+ * @details Must be called from the main thread before starting workers
+ * if the entropy source is not initialized yet.
+ */
+static void TestSeeder_start(unsigned int thread_ord, size_t test_id)
+{
+    TestSeeder *obj = &test_seeders[thread_ord];
+    Entropy_init_substream(&entropy, &obj->gen, test_id);
+    obj->nseeds = 0;
+    obj->test_id = test_id;
+}
+
+/**
+ * @brief Turns off the per-test seeds generator for the given thread.
+ * @return Number of seeds returned by the seeder.
+ */
+static size_t TestSeeder_stop(unsigned int thread_ord)
+{
+    TestSeeder *obj = &test_seeders[thread_ord];
+    obj->test_id = 0;
+    return obj->nseeds;
+}
+
+static inline uint64_t TestSeeder_seed64(TestSeeder *obj)
+{
+    obj->nseeds++;
+    return ChaCha20State_next64(&obj->gen);
+}
 
 static const char *get_cmd_param(void)
 {
@@ -48,6 +112,25 @@ void set_use_stderr_for_printf(int val)
     use_stderr_for_printf = val;
 }
 
+/**
+ * @brief Sets the number of substreams for the tests that support
+ * the split/merge mode (see GeneratorState_collect_counts).
+ */
+void set_test_nsplits(unsigned int nsplits)
+{
+    if (nsplits < 1) {
+        nsplits = 1;
+    } else if (nsplits > NTHREADS_MAX) {
+        nsplits = NTHREADS_MAX;
+    }
+    test_nsplits = nsplits;
+}
+
+unsigned int get_test_nsplits(void)
+{
+    return test_nsplits;
+}
+
 void set_entropy_textseed(const char *seed)
 {
     Entropy_init_from_textseed(&entropy, seed);
@@ -67,14 +150,18 @@ char *get_entropy_base64_seed(void)
 ///// Single-threaded API /////
 ///////////////////////////////
 
-static uint32_t get_seed32(void)
+static uint64_t get_seed64(void)
 {
-    return (uint32_t) (Entropy_seed64(&entropy, 0) >> 32);
+    TestSeeder *seeder = get_test_seeder(0);
+    if (seeder != NULL) {
+        return TestSeeder_seed64(seeder);
+    }
+    return Entropy_seed64(&entropy, 0);
 }
 
-static uint64_t get_seed64(void)
+static uint32_t get_seed32(void)
 {
-    return Entropy_seed64(&entropy, 0);
+    return (uint32_t) (get_seed64() >> 32);
 }
 
 static int printf_ser(const char *format, ...)
@@ -113,28 +200,33 @@ CallerAPI CallerAPI_init(void)
 
 DECLARE_MUTEX(get_seed64_mt_mutex)
 DECLARE_MUTEX(printf_mt_mutex)
+DECLARE_MUTEX(lfsr_jump_mutex)
+DECLARE_MUTEX(nbytes_unused_mutex)
 
 static void init_mutexes()
 {
     INIT_MUTEX(get_seed64_mt_mutex)
     INIT_MUTEX(printf_mt_mutex)
+    INIT_MUTEX(lfsr_jump_mutex)
+    INIT_MUTEX(nbytes_unused_mutex)
 }
 
 static void destroy_mutexes()
 {
     MUTEX_DESTROY(get_seed64_mt_mutex)
     MUTEX_DESTROY(printf_mt_mutex)    
+    MUTEX_DESTROY(lfsr_jump_mutex)
+    MUTEX_DESTROY(nbytes_unused_mutex)
 }
 
 static uint64_t get_seed64_mt(void)
 {
-    MUTEX_LOCK(get_seed64_mt_mutex, "get_seed64_mt");
-    unsigned int ord = seed64_mt_current_thread_ord;
-    if (ord < THREAD_ORD_OFFSET) {
-        ThreadObj thr = ThreadObj_current();
-        ord = thr.ord;
+    TestSeeder *seeder = get_test_seeder(ThreadObj_current().ord);
+    if (seeder != NULL) {
+        return TestSeeder_seed64(seeder);
     }
-    const uint64_t seed = Entropy_seed64(&entropy, ord);
+    MUTEX_LOCK(get_seed64_mt_mutex, "get_seed64_mt");
+    const uint64_t seed = Entropy_seed64(&entropy, 0);
     MUTEX_UNLOCK(get_seed64_mt_mutex);
     return seed;
 }
@@ -144,18 +236,187 @@ static uint32_t get_seed32_mt(void)
     return (uint32_t) (get_seed64_mt() >> 32);
 }
 
+/**
+ * @brief Log buffer of the test that runs in the worker thread. Output of
+ * the test is collected in the buffer without any locks and is written
+ * as one block after the test completion: worker threads don't wait for
+ * each other on every `printf` call, and logs of different tests are not
+ * interleaved.
+ * @details Each line is prefixed by the thread ordinal. The `\r` symbol
+ * rewinds the buffer to the beginning of the current line, so progress
+ * indicators are collapsed to their last state.
+ */
+typedef struct {
+    char *data; ///< Collected output
+    size_t len; ///< Length of the collected output
+    size_t capacity; ///< Buffer capacity
+    size_t line_start; ///< Beginning of the current line
+    unsigned int ord; ///< Ordinal of the thread that runs the test
+    int is_done; ///< 1 - the test is finished, the log may be written
+} ThreadLog;
+
+/**
+ * @brief Logs of the tests run by the worker threads. The logs are written
+ * in the order of tests in the battery: the log of the finished test waits
+ * for the logs of all previous tests.
+ */
+typedef struct {
+    ThreadLog *logs; ///< Logs indexed by the test indexes
+    size_t nlogs; ///< Number of logs (tests in the battery)
+    size_t next; ///< Index of the next log to be written
+} ThreadLogQueue;
+
+/// Log of the current thread (NULL - output is not captured). Helper
+/// threads of the test have their own NULL pointer and print directly.
+static THREAD_LOCAL ThreadLog *current_thread_log = NULL;
+
+
+static void ThreadLog_putc(ThreadLog *obj, char c)
+{
+    if (obj->len + 1 > obj->capacity) {
+        const size_t capacity = (obj->capacity == 0) ? 4096 : 2 * obj->capacity;
+        char *data = realloc(obj->data, capacity);
+        if (data == NULL) {
+            fprintf(stderr, "***** ThreadLog_putc: not enough memory *****\n");
+            exit(EXIT_FAILURE);
+        }
+        obj->data = data;
+        obj->capacity = capacity;
+    }
+    obj->data[obj->len++] = c;
+}
+
+
+static void ThreadLog_write(ThreadLog *obj, const char *str, size_t len)
+{
+    char prefix[32];
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '\r') {
+            obj->len = obj->line_start;
+            continue;
+        }
+        if (obj->len == obj->line_start) {
+            snprintf(prefix, sizeof(prefix), "== TH #%2u ==> ", obj->ord);
+            for (const char *p = prefix; *p != '\0'; p++) {
+                ThreadLog_putc(obj, *p);
+            }
+        }
+        ThreadLog_putc(obj, str[i]);
+        if (str[i] == '\n') {
+            obj->line_start = obj->len;
+        }
+    }
+}
+
+
+static int ThreadLog_vprintf(ThreadLog *obj, const char *format, va_list args)
+{
+    char buf[256];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    const int ans = vsnprintf(buf, sizeof(buf), format, args);
+    if (ans >= 0 && (size_t) ans < sizeof(buf)) {
+        ThreadLog_write(obj, buf, (size_t) ans);
+    } else if (ans >= 0) {
+        char *longbuf = malloc((size_t) ans + 1);
+        ASSERT_MALLOC_PTR(longbuf, "ThreadLog_vprintf");
+        vsnprintf(longbuf, (size_t) ans + 1, format, args_copy);
+        ThreadLog_write(obj, longbuf, (size_t) ans);
+        free(longbuf);
+    }
+    va_end(args_copy);
+    return ans;
+}
+
+/**
+ * @brief Writes the collected output and frees the buffer. Must be called
+ * under the `printf_mt_mutex`.
+ */
+static void ThreadLog_flush(ThreadLog *obj)
+{
+    FILE *fp = use_stderr_for_printf ? stderr : stdout;
+    if (obj->len != 0) {
+        fwrite(obj->data, 1, obj->len, fp);
+        if (obj->len != obj->line_start) {
+            fputc('\n', fp);
+        }
+        fflush(fp);
+    }
+    free(obj->data);
+    obj->data = NULL;
+    obj->len = obj->capacity = obj->line_start = 0;
+}
+
+
+/**
+ * @brief Initializes the logs queue, the skipped tests have empty logs.
+ */
+static void ThreadLogQueue_init(ThreadLogQueue *obj, size_t ntests, const int *skip)
+{
+    obj->logs = calloc(ntests, sizeof(ThreadLog));
+    ASSERT_MALLOC_PTR(obj->logs, "ThreadLogQueue_init")
+    obj->nlogs = ntests;
+    obj->next = 0;
+    for (size_t i = 0; i < ntests; i++) {
+        obj->logs[i].is_done = (skip != NULL && skip[i]);
+    }
+}
+
+/**
+ * @brief Starts capturing the output of the current thread into the log
+ * of the given test.
+ */
+static void ThreadLogQueue_start(ThreadLogQueue *obj, size_t ind, unsigned int ord)
+{
+    obj->logs[ind].ord = ord;
+    current_thread_log = &obj->logs[ind];
+}
+
+/**
+ * @brief Stops capturing the output of the current thread and writes all
+ * logs of the finished tests that are not preceded by unfinished ones.
+ */
+static void ThreadLogQueue_finish(ThreadLogQueue *obj, size_t ind)
+{
+    current_thread_log = NULL;
+    MUTEX_LOCK(printf_mt_mutex, "ThreadLogQueue_finish");
+    obj->logs[ind].is_done = 1;
+    for (; obj->next < obj->nlogs && obj->logs[obj->next].is_done; obj->next++) {
+        ThreadLog_flush(&obj->logs[obj->next]);
+    }
+    MUTEX_UNLOCK(printf_mt_mutex);
+}
+
+
+static void ThreadLogQueue_destruct(ThreadLogQueue *obj)
+{
+    for (size_t i = 0; i < obj->nlogs; i++) {
+        free(obj->logs[i].data);
+    }
+    free(obj->logs);
+    obj->logs = NULL;
+    obj->nlogs = 0;
+}
+
+
 static int printf_mt(const char *format, ...)
 {
     int ans;
-    ThreadObj thr = ThreadObj_current();
-    MUTEX_LOCK(printf_mt_mutex, "printf_mt");
     va_list args;
-    va_start(args, format);    
+    va_start(args, format);
+    ThreadLog *log = current_thread_log;
+    if (log != NULL) {
+        ans = ThreadLog_vprintf(log, format, args);
+        va_end(args);
+        return ans;
+    }
+    const unsigned int ord = ThreadObj_current().ord;
+    MUTEX_LOCK(printf_mt_mutex, "printf_mt");
     if (use_stderr_for_printf) {
-        fprintf(stderr, "== TH #%2u ==> ", thr.ord);
+        fprintf(stderr, "== TH #%2u ==> ", ord);
         ans = vfprintf(stderr, format, args);
     } else {
-        printf("== TH #%2u ==> ", thr.ord);
+        printf("== TH #%2u ==> ", ord);
         ans = vprintf(format, args);
     }
     va_end(args);
@@ -211,6 +472,10 @@ TestResults TestResults_create(const char *name)
     ans.x = NAN;
     ans.thread_id = 0;
     ans.penalty = 0;
+    ans.wall_time = 0.0;
+    ans.cpu_time = 0.0;
+    ans.nvalues = 0;
+    ans.nbytes = 0;
     return ans;
 }
 
@@ -232,7 +497,7 @@ void TestResults_set_pmin_ntests(TestResults *obj, unsigned long ntests, double
 
 PValueCategory get_pvalue_category(double pvalue)
 {
-    const double pvalue_fail_val = 1.0e-10;
+    const double pvalue_fail_val = PVALUE_FAIL_DEFAULT;
     const double pvalue_warn_val = 1.0e-3;
     if (pvalue < pvalue_fail_val || pvalue > 1.0 - pvalue_fail_val) {
         return PVALUE_FAILED;
@@ -258,6 +523,168 @@ const char *interpret_pvalue(double pvalue)
 }
 
 
+//////////////////////////////////////////
+///// TestArena class implementation /////
+//////////////////////////////////////////
+
+/**
+ * @brief Alignment of the TestArena buffers, also the size of the chunk
+ * header placed before each buffer.
+ */
+#define TEST_ARENA_ALIGN 64
+
+/**
+ * @brief Header of the buffer allocated from the TestArena.
+ */
+typedef struct {
+    size_t prev_top; ///< Offset of the previous chunk header
+    int is_free; ///< 1 if the buffer was freed but not popped yet
+} TestArenaChunk;
+
+/// Arenas indexed by thread ordinals (0 is the main thread).
+static TestArena test_arenas[NTHREADS_MAX + 1];
+
+/**
+ * @brief Returns the arena of the current thread or NULL for threads
+ * without ordinals.
+ */
+static TestArena *TestArena_current(void)
+{
+    const unsigned int ord = ThreadObj_current().ord;
+    return (ord <= NTHREADS_MAX) ? &test_arenas[ord] : NULL;
+}
+
+static inline TestArenaChunk *TestArena_get_chunk(TestArena *obj, size_t offset)
+{
+    return (TestArenaChunk *) (void *) (obj->data + offset);
+}
+
+/**
+ * @brief Replaces the (empty) reserved block by a larger one. Only `nbytes`
+ * rounded up to the large page size are reserved: the memory estimate of
+ * the test used by the tests dispatcher must cover the whole arena.
+ */
+static int TestArena_reserve(TestArena *obj, size_t nbytes)
+{
+    if (nbytes > SIZE_MAX - LARGE_PAGE_SIZE) {
+        return 0;
+    }
+    const size_t capacity = (nbytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1);
+    large_pages_free(obj->data, obj->capacity);
+    obj->data = large_pages_alloc(capacity, &obj->is_huge);
+    obj->capacity = (obj->data != NULL) ? capacity : 0;
+    return obj->data != NULL;
+}
+
+/**
+ * @brief Allocates the zeroed buffer for `nmemb` elements of `size` bytes,
+ * just as `calloc` does. If `obj` is NULL then `calloc` is used.
+ * @details The arena must be used only by the thread that owns it, i.e. by
+ * the test that received the GeneratorState from the tests dispatcher.
+ * The buffer must be freed by TestArena_free.
+ */
+void *TestArena_calloc(TestArena *obj, size_t nmemb, size_t size)
+{
+    if (obj == NULL || nmemb == 0 || size == 0 ||
+        nmemb > (SIZE_MAX - 2 * TEST_ARENA_ALIGN) / size) {
+        return calloc(nmemb, size);
+    }
+    const size_t nbytes = nmemb * size;
+    const size_t need = TEST_ARENA_ALIGN +
+        ((nbytes + TEST_ARENA_ALIGN - 1) & ~((size_t) TEST_ARENA_ALIGN - 1));
+    if (obj->used + need > obj->capacity) {
+        if (obj->used != 0 || !TestArena_reserve(obj, need)) {
+            obj->nfallbacks++;
+            return calloc(nmemb, size);
+        }
+    }
+    TestArenaChunk *chunk = TestArena_get_chunk(obj, obj->used);
+    chunk->prev_top = obj->top;
+    chunk->is_free = 0;
+    obj->top = obj->used;
+    obj->used += need;
+    if (obj->used > obj->peak) {
+        obj->peak = obj->used;
+    }
+    void *ptr = obj->data + obj->top + TEST_ARENA_ALIGN;
+    memset(ptr, 0, nbytes);
+    return ptr;
+}
+
+/**
+ * @brief Frees the buffer allocated by TestArena_calloc. Buffers may be
+ * freed in any order: memory is returned to the arena when all buffers
+ * above it are freed.
+ */
+void TestArena_free(TestArena *obj, void *ptr)
+{
+    unsigned char *p = ptr;
+    if (obj == NULL || obj->data == NULL || p < obj->data ||
+        p >= obj->data + obj->capacity) {
+        free(ptr);
+        return;
+    }
+    TestArena_get_chunk(obj, (size_t) (p - obj->data) - TEST_ARENA_ALIGN)->is_free = 1;
+    while (obj->used > 0 && TestArena_get_chunk(obj, obj->top)->is_free) {
+        obj->used = obj->top;
+        obj->top = TestArena_get_chunk(obj, obj->top)->prev_top;
+    }
+}
+
+/**
+ * @brief Returns memory of the empty arena to the OS if it is much larger
+ * than `nbytes`. Used by the tests dispatcher to prevent keeping large
+ * blocks by threads that run tests with small memory consumption.
+ */
+static void TestArena_shrink(TestArena *obj, size_t nbytes)
+{
+    if (obj == NULL || obj->data == NULL || obj->used != 0 ||
+        nbytes > SIZE_MAX - 2 * LARGE_PAGE_SIZE) {
+        return;
+    }
+    const size_t keep = ((nbytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1)) +
+        LARGE_PAGE_SIZE;
+    if (obj->capacity > keep) {
+        large_pages_free(obj->data, obj->capacity);
+        obj->data = NULL;
+        obj->capacity = 0;
+        obj->top = 0;
+    }
+}
+
+/**
+ * @brief Prints the arenas usage statistics (if they were used) and
+ * returns their memory to the OS.
+ */
+static void TestArenas_free_all(int print_usage)
+{
+    size_t peak_total = 0, peak_max = 0;
+    unsigned int narenas = 0, nhuge = 0;
+    unsigned long long nfallbacks = 0;
+    for (size_t i = 0; i <= NTHREADS_MAX; i++) {
+        TestArena *obj = &test_arenas[i];
+        if (obj->data == NULL && obj->peak == 0) {
+            continue;
+        }
+        narenas++;
+        nhuge += (obj->is_huge != 0);
+        peak_total += obj->peak;
+        if (obj->peak > peak_max) {
+            peak_max = obj->peak;
+        }
+        nfallbacks += obj->nfallbacks;
+        large_pages_free(obj->data, obj->capacity);
+        memset(obj, 0, sizeof(TestArena));
+    }
+    if (print_usage && narenas > 0) {
+        printf("Test arenas:       %u, peak usage %.1f MiB (max %.1f MiB per thread)\n",
+            narenas, (double) peak_total / 1048576.0, (double) peak_max / 1048576.0);
+        printf("  huge pages: %u of %u; calloc fallbacks: %llu\n\n",
+            nhuge, narenas, nfallbacks);
+    }
+}
+
+
 ///////////////////////////////////////////////
 ///// GeneratorState class implementation /////
 ///////////////////////////////////////////////
@@ -275,9 +702,84 @@ GeneratorState GeneratorState_create(const GeneratorInfo *gi,
             gi->name, intf->get_param());
         exit(EXIT_FAILURE);
     }
+    obj.buf = malloc(GENERATOR_STATE_BUFSIZE * sizeof(uint64_t));
+    ASSERT_MALLOC_PTR(obj.buf, "GeneratorState_create");
+    obj.buf_pos = 0;
+    obj.buf_len = 0;
+    obj.nvalues = 0;
+    obj.arena = TestArena_current();
     return obj;
 }
 
+/**
+ * @brief Refills the block buffer of the generator state. Uses the `fill`
+ * callback if it is supplied by the module, otherwise falls back to
+ * `get_bits` calls (e.g. for old modules and enveloped generators).
+ */
+void GeneratorState_refill(GeneratorState *obj)
+{
+    if (obj->gi->fill != NULL) {
+        obj->gi->fill(obj->state, obj->buf, GENERATOR_STATE_BUFSIZE);
+    } else {
+        uint64_t (*get_bits)(void *) = obj->gi->get_bits;
+        for (size_t i = 0; i < GENERATOR_STATE_BUFSIZE; i++) {
+            obj->buf[i] = get_bits(obj->state);
+        }
+    }
+    obj->buf_pos = 0;
+    obj->buf_len = GENERATOR_STATE_BUFSIZE;
+    obj->nvalues += GENERATOR_STATE_BUFSIZE;
+}
+
+/**
+ * @brief Skips `n` values of the generator output. Values left in the
+ * block buffer are skipped first, then the `discard` callback of the
+ * generator is used (if available). Skipped values are counted as consumed
+ * by the test.
+ */
+void GeneratorState_discard(GeneratorState *obj, unsigned long long n)
+{
+    const size_t nbuf = obj->buf_len - obj->buf_pos;
+    if (n <= nbuf) {
+        obj->buf_pos += (size_t) n;
+        return;
+    }
+    n -= nbuf;
+    obj->buf_pos = obj->buf_len;
+    if (obj->gi->discard != NULL) {
+        obj->gi->discard(obj->state, n);
+        obj->nvalues += n;
+    } else {
+        for (; n > GENERATOR_STATE_BUFSIZE; n -= GENERATOR_STATE_BUFSIZE) {
+            GeneratorState_refill(obj);
+        }
+        GeneratorState_refill(obj);
+        obj->buf_pos = (size_t) n;
+    }
+}
+
+/**
+ * @brief Copies the next `n` values of the generator output to the `x`
+ * array. It is equivalent to `n` calls of `GeneratorState_get_bits` but
+ * copies whole chunks of the block buffer.
+ */
+void GeneratorState_get_array(GeneratorState *obj, uint64_t *x, size_t n)
+{
+    while (n > 0) {
+        if (obj->buf_pos >= obj->buf_len) {
+            GeneratorState_refill(obj);
+        }
+        size_t len = obj->buf_len - obj->buf_pos;
+        if (len > n) {
+            len = n;
+        }
+        memcpy(x, obj->buf + obj->buf_pos, len * sizeof(uint64_t));
+        obj->buf_pos += len;
+        x += len;
+        n -= len;
+    }
+}
+
 void GeneratorInfo_print(const GeneratorInfo *gi, int to_stderr)
 {
     FILE *fp = (to_stderr) ? stderr : stdout;
@@ -292,85 +794,428 @@ void GeneratorInfo_print(const GeneratorInfo *gi, int to_stderr)
 
 /**
  * @brief Destructor for the generator state: deallocates all internal
- * buffers but not the GeneratorState itself.
+ * buffers but not the GeneratorState itself. Values left in the block
+ * buffer are added to the counter of unused bytes.
  */
 void GeneratorState_destruct(GeneratorState *obj)
 {
+    const unsigned long long nunused = obj->nvalues - GeneratorState_get_nvalues(obj);
+    if (nunused > 0) {
+        if (use_mutexes) {
+            MUTEX_LOCK(nbytes_unused_mutex, "GeneratorState_destruct");
+        }
+        generators_nbytes_unused += nunused * (obj->gi->nbits / 8);
+        if (use_mutexes) {
+            MUTEX_UNLOCK(nbytes_unused_mutex);
+        }
+    }
     obj->gi->free(obj->state, obj->gi, obj->intf);
+    free(obj->buf);
+    obj->buf = NULL;
 }
 
 /**
- * @brief Checks if the generator output size is consistent
- * with the number of bits.
+ * @brief Returns the number of bytes that were obtained from generators
+ * by all destroyed generator states but were not consumed by tests: they
+ * were left in the block buffers. Used by sources of external data, e.g.
+ * stdin, to report the consumed bytes as the sum of
+ * GeneratorState_get_nvalues of all generator states.
  */
-int GeneratorState_check_size(const GeneratorState *obj)
+unsigned long long GeneratorState_get_nbytes_unused(void)
 {
-    if (obj->gi->nbits == 64) {
-        return 1;
-    } else {
-        for (size_t i = 0; i < 1000; i++) {
-            uint64_t x = obj->gi->get_bits(obj->state);
-            if (x >> obj->gi->nbits != 0) {
-                return 0;
-            }
-        }
+    if (use_mutexes) {
+        MUTEX_LOCK(nbytes_unused_mutex, "GeneratorState_get_nbytes_unused");
     }
-    return 1;
+    const unsigned long long nbytes = generators_nbytes_unused;
+    if (use_mutexes) {
+        MUTEX_UNLOCK(nbytes_unused_mutex);
+    }
+    return nbytes;
 }
 
-
-//////////////////////////////////////////////////
-///// Subroutines for working with C modules /////
-//////////////////////////////////////////////////
-
 /**
- * @brief Loads shared library (`.so` or `.dll`) with module that
- * implements pseudorandom number generator.
+ * @brief Prepares the generic LFSR jump for the generator without its own
+ * `jump` callback, see LfsrJump_init. The probe example of the generator
+ * is seeded from a fixed substream and the seeder of the calling thread
+ * is restored, so the seeds of the test are not affected.
  */
-GeneratorModule GeneratorModule_load(const char *libname, const CallerAPI *intf)
+static int GeneratorState_init_lfsr_jump(LfsrJump *lfsr_jump,
+    const GeneratorInfo *gi, const CallerAPI *intf,
+    unsigned int ord, unsigned int log2_dist)
 {
-    GeneratorModule mod = {.valid = 1,
-        {
-            .name = NULL,
-            .description = NULL,
-            .nbits = 0,
-            .create = NULL,
-            .free = NULL,
-            .get_bits = NULL,
-            .self_test = NULL,
-            .get_sum = NULL,
-            .parent = NULL
-        }
-    };
-    mod.lib = dlopen_wrap(libname);
-    if (mod.lib == NULL) {
-        mod.valid = 0;
-        return mod;
+    const TestSeeder seeder_saved = test_seeders[ord];
+    TestSeeder_start(ord, SIZE_MAX);
+    // GeneratorStateExt_create temporarily hooks intf->malloc
+    if (use_mutexes) {
+        MUTEX_LOCK(lfsr_jump_mutex, "GeneratorState_init_lfsr_jump");
     }
-    void *fptr = dlsym_wrap(mod.lib, "gen_getinfo");
-    GetGenInfoFunc gen_getinfo;
-    memcpy(&gen_getinfo, &fptr, sizeof(gen_getinfo));
-    if (gen_getinfo == NULL) {
-        fprintf(stderr, "Cannot find the 'gen_getinfo' function\n");
-        mod.valid = 0;
-    } else {
-        int is_ok = gen_getinfo(&mod.gen, intf);
-        if (!is_ok) {
-            fprintf(stderr, "'gen_getinfo' function failed (%d returned)\n", is_ok);
-            mod.valid = 0;
-        }
+    const int is_ok = LfsrJump_init(lfsr_jump, gi, intf, log2_dist);
+    if (use_mutexes) {
+        MUTEX_UNLOCK(lfsr_jump_mutex);
     }
-    return mod;
+    test_seeders[ord] = seeder_saved;
+    return is_ok;
 }
 
 /**
- * @brief Unloads shared library (`.so` or `.dll`) with module that
- * implements pseudorandom number generator.
+ * @brief Moves the freshly created generator to the output with the index
+ * \f$ k \cdot 2^d \f$ by the `seek` callback.
+ * @return 0 if the index doesn't fit into 128 bits or is not supported
+ * by the generator.
  */
-void GeneratorModule_unload(GeneratorModule *mod)
-{
-    mod->valid = 0;
-    if (mod->lib != NULL) {
+static int GeneratorState_seek_substream(GeneratorState *obj, uint64_t k,
+    unsigned int log2_dist)
+{
+    uint64_t hi, lo;
+    if (obj->gi->seek == NULL || log2_dist == 0 || log2_dist >= 128) {
+        return 0;
+    } else if (log2_dist < 64) {
+        lo = k << log2_dist;
+        hi = k >> (64 - log2_dist);
+    } else if (log2_dist == 64 || (k >> (128 - log2_dist)) == 0) {
+        lo = 0;
+        hi = k << (log2_dist - 64);
+    } else {
+        return 0;
+    }
+    return obj->gi->seek(obj->state, hi, lo);
+}
+
+/**
+ * @brief Creates `n` examples of the generator that produce disjoint
+ * substreams of one logical stream: all of them are initialized by the same
+ * seeds and the k-th example is moved forward by \f$ k \cdot 2^d \f$ outputs,
+ * where \f$ d \f$ is the first value from the `log2_dists` list (terminated
+ * by 0) supported by the generator.
+ * @details Seeds are taken from a separate ChaCha20 substream that is
+ * replayed for each example, the substream number is obtained from the
+ * `intf->get_seed64` function.
+ *
+ * For each distance the `seek` callback is tried first: it moves the k-th
+ * example directly to its position. Then `k` calls of the `jump` callback
+ * are tried. If the generator has neither `seek` nor `jump` callback but is
+ * a small LFSR then the generic jump deduced from its transition function
+ * is used (LfsrJump) with the first distance from the list.
+ * @param[out] out         Array for `n` generator states.
+ * @param[in]  n           Number of substreams (at least 2).
+ * @param[in]  gi          Generator.
+ * @param[in]  intf        Caller API.
+ * @param[in]  log2_dists  Acceptable distances between substreams, in
+ *                         the order of preference.
+ * @return Selected \f$ d \f$ or 0 if the generator doesn't support jumps
+ * (no generator states are allocated in this case).
+ */
+unsigned int GeneratorState_create_substreams(GeneratorState *out, size_t n,
+    const GeneratorInfo *gi, const CallerAPI *intf, const unsigned int *log2_dists)
+{
+    if (n < 2 || log2_dists[0] == 0) {
+        return 0;
+    }
+    const unsigned int ord = ThreadObj_current().ord;
+    if (ord > NTHREADS_MAX) {
+        return 0;
+    }
+    unsigned int log2_dist = 0;
+    LfsrJump lfsr_jump;
+    int use_lfsr_jump = 0, use_seek = 0;
+    if (gi->jump == NULL && gi->seek == NULL) {
+        use_lfsr_jump = GeneratorState_init_lfsr_jump(&lfsr_jump, gi, intf,
+            ord, log2_dists[0]);
+        if (!use_lfsr_jump) {
+            return 0;
+        }
+        log2_dist = log2_dists[0];
+    }
+    const size_t stream_id = (size_t) (intf->get_seed64() | 1); // 0 is reserved
+    const TestSeeder seeder_saved = test_seeders[ord];
+    for (size_t k = 0; k < n; k++) {
+        TestSeeder_start(ord, stream_id);
+        out[k] = GeneratorState_create(gi, intf);
+        TestSeeder_stop(ord);
+        if (k == 0) {
+            continue;
+        }
+        if (log2_dist == 0) {
+            // Select the distance supported by the generator; the seek
+            // to the last substream checks that all of them are available
+            for (const unsigned int *d = log2_dists; *d != 0; d++) {
+                if (GeneratorState_seek_substream(&out[k], n - 1, *d) &&
+                    GeneratorState_seek_substream(&out[k], k, *d)) {
+                    use_seek = 1;
+                    log2_dist = *d;
+                    break;
+                } else if (gi->jump != NULL && gi->jump(out[k].state, *d)) {
+                    log2_dist = *d;
+                    break;
+                }
+            }
+            if (log2_dist == 0) {
+                for (size_t i = 0; i <= k; i++) {
+                    GeneratorState_destruct(&out[i]);
+                }
+                break;
+            }
+            continue;
+        }
+        if (use_seek) {
+            (void) GeneratorState_seek_substream(&out[k], k, log2_dist);
+            continue;
+        }
+        for (size_t i = 0; i < k; i++) {
+            if (use_lfsr_jump) {
+                LfsrJump_apply(&lfsr_jump, &out[k]);
+            } else {
+                (void) gi->jump(out[k].state, log2_dist);
+            }
+        }
+    }
+    if (use_lfsr_jump) {
+        LfsrJump_destruct(&lfsr_jump);
+    }
+    test_seeders[ord] = seeder_saved;
+    return log2_dist;
+}
+
+static void *PipelineConsumer_create(const GeneratorInfo *gi, const CallerAPI *intf);
+static unsigned int tests_borrow_helpers(unsigned int nhelpers_max, size_t nbytes);
+static void tests_return_helpers(unsigned int nhelpers, size_t nbytes);
+
+/**
+ * @brief A thread of the split/merge mode: processes the parts of the
+ * sample with indexes `first`, `first + step`, `first + 2*step`, ...
+ */
+typedef struct {
+    GeneratorState *parts; ///< Generators for all parts of the sample
+    unsigned int nparts; ///< Number of parts
+    unsigned int first; ///< Index of the first processed part
+    unsigned int step; ///< Number of threads processing the parts
+    CountsKernelFunc kernel;
+    const void *udata;
+    unsigned long long *counts; ///< Counts for the processed parts
+    unsigned long long nitems; ///< Sample size (for all parts)
+    int is_ok; ///< 0 if any part was rejected by the kernel
+} CountsSplitTask;
+
+
+static void CountsSplitTask_run(CountsSplitTask *task)
+{
+    const unsigned long long nitems = task->nitems, nparts = task->nparts;
+    task->is_ok = 1;
+    for (unsigned int k = task->first; k < task->nparts; k += task->step) {
+        const unsigned long long nitems_part = nitems / nparts +
+            ((k < nitems % nparts) ? 1 : 0);
+        if (!task->kernel(&task->parts[k], task->counts, nitems_part, task->udata)) {
+            task->is_ok = 0;
+        }
+    }
+}
+
+
+static ThreadRetVal THREADFUNC_SPEC CountsSplitTask_thread(void *data)
+{
+    CountsSplitTask_run(data);
+    return 0;
+}
+
+
+/**
+ * @brief Runs the test kernel that adds frequencies (counts) of some events
+ * to the `counts` array. In the split/merge mode (see `set_test_nsplits`)
+ * the sample is divided into parts taken from different generators. If the
+ * generator has the `jump` or `seek` callback then the parts are disjoint
+ * substreams of one stream (see GeneratorState_create_substreams), otherwise
+ * the first part is taken from the `obj` generator and other ones - from new
+ * generator examples seeded from the current test substream. Then counts
+ * are summed, so the test statistic is computed in the usual way.
+ * @details The results in the split/merge mode differ from the ordinary
+ * mode but are reproducible for the same seed and number of substreams:
+ * they don't depend on the number of threads processing the parts.
+ * Tests that consume the pipelined stream are not split.
+ *
+ * The parts are processed by the current thread and by the helper threads
+ * (see THREAD_ORD_HELPER) borrowed from the idle workers of the tests
+ * dispatcher, so the total number of busy threads doesn't exceed the
+ * number of workers. Each helper has its own table of counts that is
+ * charged to the memory budget of tests. If there are no idle workers
+ * then all parts are processed sequentially by the current thread.
+ * Additional generators don't use the arena of the test thread, values
+ * consumed by them are added to the `obj` counter of values.
+ * @param obj      Generator state of the test.
+ * @param kernel   Test kernel.
+ * @param udata    User data for the kernel.
+ * @param counts   Array of counts, must be initialized by the caller.
+ * @param ncounts  Number of elements in the `counts` array.
+ * @param nitems   Sample size (in items processed by the kernel).
+ * @return 0 if any part of the sample was rejected by the kernel, 1 otherwise.
+ */
+int GeneratorState_collect_counts(GeneratorState *obj, CountsKernelFunc kernel,
+    const void *udata, unsigned long long *counts, size_t ncounts,
+    unsigned long long nitems)
+{
+    static const unsigned int log2_dists[] = {128, 96, 64, 56, 0};
+    enum { NITEMS_PER_SPLIT_MIN = 1 << 16 };
+    unsigned int nsplits = test_nsplits;
+    if (nitems / NITEMS_PER_SPLIT_MIN < nsplits) {
+        nsplits = (unsigned int) (nitems / NITEMS_PER_SPLIT_MIN);
+    }
+    // Consumers of the pipelined stream cannot create new generators:
+    // the producer doesn't know about them.
+    if (nsplits <= 1 || obj->gi->create == PipelineConsumer_create) {
+        return kernel(obj, counts, nitems, udata);
+    }
+    GeneratorState *parts = calloc(nsplits, sizeof(GeneratorState));
+    ASSERT_MALLOC_PTR(parts, "GeneratorState_collect_counts");
+    // Generators are created in the current thread: it has the
+    // seeder of the test substream.
+    unsigned int log2_dist = 0;
+    if (obj->gi->jump != NULL || obj->gi->seek != NULL) {
+        log2_dist = GeneratorState_create_substreams(parts, nsplits,
+            obj->gi, obj->intf, log2_dists);
+    }
+    for (unsigned int k = (log2_dist != 0) ? 0 : 1; k < nsplits; k++) {
+        if (log2_dist == 0) {
+            parts[k] = GeneratorState_create(obj->gi, obj->intf);
+        }
+        // The arena belongs to the current thread
+        parts[k].arena = NULL;
+    }
+    if (log2_dist == 0) {
+        parts[0] = *obj;
+    }
+    // Helper threads are taken from the idle workers
+    const size_t table_nbytes = ncounts * sizeof(unsigned long long);
+    const unsigned int nhelpers = tests_borrow_helpers(nsplits - 1, table_nbytes);
+    if (log2_dist != 0) {
+        obj->intf->printf("  Split/merge mode: %u substreams (2^%u values apart), threads: %u\n",
+            nsplits, log2_dist, nhelpers + 1);
+    } else {
+        obj->intf->printf("  Split/merge mode: %u substreams, threads: %u\n",
+            nsplits, nhelpers + 1);
+    }
+    CountsSplitTask *tasks = calloc(nhelpers + 1, sizeof(CountsSplitTask));
+    ThreadObj *thrd = calloc(nhelpers + 1, sizeof(ThreadObj));
+    if (tasks == NULL || thrd == NULL) {
+        fprintf(stderr, "***** GeneratorState_collect_counts: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int j = 0; j <= nhelpers; j++) {
+        tasks[j].parts = parts;
+        tasks[j].nparts = nsplits;
+        tasks[j].first = j;
+        tasks[j].step = nhelpers + 1;
+        tasks[j].kernel = kernel;
+        tasks[j].udata = udata;
+        tasks[j].nitems = nitems;
+        if (j > 0) {
+            tasks[j].counts = calloc(ncounts, sizeof(unsigned long long));
+            ASSERT_MALLOC_PTR(tasks[j].counts, "GeneratorState_collect_counts");
+            thrd[j] = ThreadObj_create(CountsSplitTask_thread, &tasks[j],
+                THREAD_ORD_HELPER + j);
+        } else {
+            tasks[j].counts = counts;
+        }
+    }
+    CountsSplitTask_run(&tasks[0]);
+    int is_ok = tasks[0].is_ok;
+    for (unsigned int j = 1; j <= nhelpers; j++) {
+        ThreadObj_wait(&thrd[j]);
+        for (size_t i = 0; i < ncounts; i++) {
+            counts[i] += tasks[j].counts[i];
+        }
+        is_ok = is_ok && tasks[j].is_ok;
+        free(tasks[j].counts);
+    }
+    tests_return_helpers(nhelpers, table_nbytes);
+    // The first part may be processed by the `obj` generator itself
+    if (log2_dist == 0) {
+        *obj = parts[0];
+    }
+    for (unsigned int k = (log2_dist != 0) ? 0 : 1; k < nsplits; k++) {
+        obj->nvalues += GeneratorState_get_nvalues(&parts[k]);
+        GeneratorState_destruct(&parts[k]);
+    }
+    free(parts);
+    free(tasks);
+    free(thrd);
+    return is_ok;
+}
+
+/**
+ * @brief Checks if the generator output size is consistent
+ * with the number of bits.
+ */
+int GeneratorState_check_size(const GeneratorState *obj)
+{
+    if (obj->gi->nbits == 64) {
+        return 1;
+    } else {
+        for (size_t i = 0; i < 1000; i++) {
+            uint64_t x = obj->gi->get_bits(obj->state);
+            if (x >> obj->gi->nbits != 0) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+//////////////////////////////////////////////////
+///// Subroutines for working with C modules /////
+//////////////////////////////////////////////////
+
+/**
+ * @brief Loads shared library (`.so` or `.dll`) with module that
+ * implements pseudorandom number generator.
+ */
+GeneratorModule GeneratorModule_load(const char *libname, const CallerAPI *intf)
+{
+    GeneratorModule mod = {.valid = 1,
+        {
+            .name = NULL,
+            .description = NULL,
+            .nbits = 0,
+            .create = NULL,
+            .free = NULL,
+            .get_bits = NULL,
+            .self_test = NULL,
+            .get_sum = NULL,
+            .parent = NULL,
+            .fill = NULL,
+            .jump = NULL,
+            .seek = NULL,
+            .discard = NULL
+        }
+    };
+    mod.lib = dlopen_wrap(libname);
+    if (mod.lib == NULL) {
+        mod.valid = 0;
+        return mod;
+    }
+    void *fptr = dlsym_wrap(mod.lib, "gen_getinfo");
+    GetGenInfoFunc gen_getinfo;
+    memcpy(&gen_getinfo, &fptr, sizeof(gen_getinfo));
+    if (gen_getinfo == NULL) {
+        fprintf(stderr, "Cannot find the 'gen_getinfo' function\n");
+        mod.valid = 0;
+    } else {
+        int is_ok = gen_getinfo(&mod.gen, intf);
+        if (!is_ok) {
+            fprintf(stderr, "'gen_getinfo' function failed (%d returned)\n", is_ok);
+            mod.valid = 0;
+        }
+    }
+    return mod;
+}
+
+/**
+ * @brief Unloads shared library (`.so` or `.dll`) with module that
+ * implements pseudorandom number generator.
+ */
+void GeneratorModule_unload(GeneratorModule *mod)
+{
+    mod->valid = 0;
+    if (mod->lib != NULL) {
         dlclose_wrap(mod->lib);
     }
 }
@@ -602,6 +1447,262 @@ void radixsort32_inplace(uint32_t *x, size_t len)
 
 
 
+/**
+ * @brief Shared data for the multithreaded in-place radix sort.
+ * @details Each bucket (the highest byte of the value) is split into
+ * `nthreads` shares. The i-th thread owns the `[heads[i][b], tails[i][b])`
+ * share of the b-th bucket during the permutation phase.
+ */
+typedef struct {
+    uint64_t *x; ///< Sorted array.
+    size_t len; ///< Number of elements in the sorted array.
+    unsigned int nthreads; ///< Number of threads.
+    size_t *heads; ///< Histograms/shares heads, nthreads x 256.
+    size_t *tails; ///< Shares tails, nthreads x 256.
+    CountSortBounds bnd; ///< Global buckets boundaries.
+    unsigned char *bucket_thread; ///< Bucket to thread mapping for recursion.
+} RadixSort64Mt;
+
+/**
+ * @brief A thread argument for the multithreaded radix sort.
+ */
+typedef struct {
+    RadixSort64Mt *obj;
+    unsigned int ord;
+} RadixSort64MtThread;
+
+
+static ThreadRetVal THREADFUNC_SPEC RadixSort64Mt_hist_thread(void *udata)
+{
+    const RadixSort64MtThread *th = udata;
+    const RadixSort64Mt *obj = th->obj;
+    const size_t i_begin = obj->len * th->ord / obj->nthreads;
+    const size_t i_end = obj->len * (th->ord + 1) / obj->nthreads;
+    size_t *hist = &obj->heads[256 * th->ord];
+    for (size_t i = i_begin; i < i_end; i++) {
+        hist[obj->x[i] >> 56]++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Speculative permutation inside the thread shares of all buckets.
+ * @details An element is moved to the share of its bucket owned by the
+ * same thread. If this share is already full then the element is moved
+ * to the end of the current share and left "stuck", i.e. after this phase
+ * the `[tails[i][b], share_end)` range contains unresolved elements.
+ * Elements in the `[share_begin, heads[i][b])` range are always correct.
+ */
+static ThreadRetVal THREADFUNC_SPEC RadixSort64Mt_permute_thread(void *udata)
+{
+    const RadixSort64MtThread *th = udata;
+    const RadixSort64Mt *obj = th->obj;
+    uint64_t *x = obj->x;
+    size_t *ph = &obj->heads[256 * th->ord], *pt = &obj->tails[256 * th->ord];
+    for (unsigned int b = 0; b < 256; b++) {
+        while (ph[b] < pt[b]) {
+            const uint64_t v = x[ph[b]];
+            const unsigned int k = (unsigned int) (v >> 56);
+            if (k == b) {
+                ph[b]++;
+            } else if (ph[k] < pt[k]) {
+                x[ph[b]] = x[ph[k]];
+                x[ph[k]++] = v;
+            } else {
+                x[ph[b]] = x[--pt[b]];
+                x[pt[b]] = v;
+            }
+        }
+    }
+    return 0;
+}
+
+static ThreadRetVal THREADFUNC_SPEC RadixSort64Mt_recursion_thread(void *udata)
+{
+    const RadixSort64MtThread *th = udata;
+    const RadixSort64Mt *obj = th->obj;
+    CountSortBounds *bnd_ary = calloc(8, sizeof(CountSortBounds));
+    if (bnd_ary == NULL) {
+        fprintf(stderr, "***** radixsort64_inplace_mt: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int b = 0; b < 256; b++) {
+        if (obj->bucket_thread[b] != th->ord) {
+            continue;
+        }
+        const size_t lb = obj->bnd.lb[b], len = obj->bnd.ub[b] - lb;
+        if (len > 128) {
+            countsort64_inplace(obj->x + lb, len, 1, bnd_ary);
+        } else {
+            quicksort64(obj->x + lb, len);
+        }
+    }
+    free(bnd_ary);
+    return 0;
+}
+
+static void RadixSort64Mt_run_threads(RadixSort64Mt *obj, ThreadFuncPtr thr_func)
+{
+    ThreadObj thrd[NTHREADS_MAX];
+    RadixSort64MtThread args[NTHREADS_MAX];
+    for (unsigned int i = 0; i < obj->nthreads; i++) {
+        args[i].obj = obj;
+        args[i].ord = i;
+        thrd[i] = ThreadObj_create(thr_func, &args[i], THREAD_ORD_HELPER + i);
+    }
+    for (unsigned int i = 0; i < obj->nthreads; i++) {
+        ThreadObj_wait(&thrd[i]);
+    }
+}
+
+/**
+ * @brief Moves unresolved ("stuck") elements of the b-th bucket to
+ * the end of the bucket after the speculative permutation.
+ * @details Stuck elements that are located before the new boundary are
+ * swapped with the correct elements located after it. Only O(number of
+ * stuck elements) operations are required.
+ * @return The new lower boundary of the unresolved range of the bucket.
+ */
+static size_t RadixSort64Mt_repair_bucket(RadixSort64Mt *obj, unsigned int b)
+{
+    uint64_t *x = obj->x;
+    const size_t lb = obj->bnd.lb[b], ub = obj->bnd.ub[b];
+    const size_t blen = ub - lb, p = obj->nthreads;
+    size_t nstuck = 0;
+    for (size_t i = 0; i < p; i++) {
+        nstuck += lb + blen * (i + 1) / p - obj->tails[256 * i + b];
+    }
+    const size_t bnd = ub - nstuck;
+    size_t src = ub;
+    for (size_t i = 0; i < p; i++) {
+        const size_t share_end = lb + blen * (i + 1) / p;
+        for (size_t j = obj->tails[256 * i + b]; j < share_end && j < bnd; j++) {
+            if ((x[j] >> 56) != b) {
+                do {
+                    src--;
+                } while ((x[src] >> 56) != b);
+                const uint64_t tmp = x[j];
+                x[j] = x[src];
+                x[src] = tmp;
+            }
+        }
+    }
+    return bnd;
+}
+
+/**
+ * @brief Multithreaded in-place radix sort for 64-bit integers.
+ * @details It is a parallel version of the MSD in-place radix sort
+ * (American Flag Sort) by the highest byte that uses ideas from the
+ * PARADIS algorithm [1]:
+ *
+ * 1. Histogram of the highest byte is computed in parallel for
+ *    `nthreads` parts of the array.
+ * 2. Each bucket is split into `nthreads` shares and each thread permutes
+ *    elements only between its own shares. Elements that cannot be placed
+ *    are collected in the end of the buckets by the O(n_stuck) repair
+ *    procedure and then are placed by the serial American Flag Sort.
+ * 3. Buckets are distributed between threads by the "largest first"
+ *    greedy algorithm and sorted by the serial in-place radix sort.
+ *
+ * Small arrays and `nthreads < 2` are processed by `radixsort64_inplace`.
+ *
+ * References:
+ *
+ * 1. Cho M., Brand D., Bordawekar R. et al. PARADIS: an efficient parallel
+ *    algorithm for in-place radix sort // Proceedings of the VLDB Endowment.
+ *    2015. V. 8. N 12. P. 1518-1529. https://doi.org/10.14778/2824032.2824050
+ *
+ * @param x         Pointer to the sorted array.
+ * @param len       Number of elements in the sorted array.
+ * @param nthreads  Number of threads.
+ */
+void radixsort64_inplace_mt(uint64_t *x, size_t len, unsigned int nthreads)
+{
+    if (nthreads > NTHREADS_MAX) {
+        nthreads = NTHREADS_MAX;
+    }
+    if (nthreads < 2 || len < (1U << 16)) {
+        radixsort64_inplace(x, len);
+        return;
+    }
+    RadixSort64Mt obj;
+    obj.x = x;
+    obj.len = len;
+    obj.nthreads = nthreads;
+    obj.heads = calloc(256 * (size_t) nthreads, sizeof(size_t));
+    obj.tails = calloc(256 * (size_t) nthreads, sizeof(size_t));
+    obj.bucket_thread = calloc(256, sizeof(unsigned char));
+    if (obj.heads == NULL || obj.tails == NULL || obj.bucket_thread == NULL) {
+        fprintf(stderr, "***** radixsort64_inplace_mt: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    // a) Parallel histogram
+    RadixSort64Mt_run_threads(&obj, RadixSort64Mt_hist_thread);
+    size_t offset = 0;
+    for (size_t b = 0; b < 256; b++) {
+        obj.bnd.lb[b] = offset;
+        for (size_t i = 0; i < nthreads; i++) {
+            offset += obj.heads[256 * i + b];
+        }
+        obj.bnd.ub[b] = offset;
+    }
+    // b) Parallel speculative permutation
+    for (size_t b = 0; b < 256; b++) {
+        const size_t lb = obj.bnd.lb[b], blen = obj.bnd.ub[b] - lb;
+        for (size_t i = 0; i < nthreads; i++) {
+            obj.heads[256 * i + b] = lb + blen * i / nthreads;
+            obj.tails[256 * i + b] = lb + blen * (i + 1) / nthreads;
+        }
+    }
+    RadixSort64Mt_run_threads(&obj, RadixSort64Mt_permute_thread);
+    // c) Repair and serial permutation of the unresolved elements
+    size_t *lb = obj.bnd.lb, *ub = obj.bnd.ub;
+    for (unsigned int b = 0; b < 256; b++) {
+        lb[b] = RadixSort64Mt_repair_bucket(&obj, b);
+    }
+    for (unsigned int i = 0; i < 256; i++) {
+        for (size_t j = lb[i]; j < ub[i]; ) {
+            const unsigned int pos = (unsigned int) (x[j] >> 56);
+            const uint64_t tmp = x[lb[pos]];
+            x[lb[pos]++] = x[j];
+            x[j] = tmp;
+            if (pos == i) { j++; }
+        }
+    }
+    lb[0] = 0;
+    for (int i = 1; i < 256; i++) {
+        lb[i] = ub[i - 1];
+    }
+    // d) Parallel sorting of buckets: the largest ones are sorted first
+    size_t *load = obj.heads; // Reused as threads load counters
+    memset(load, 0, nthreads * sizeof(size_t));
+    unsigned char is_assigned[256] = {0};
+    for (unsigned int n = 0; n < 256; n++) {
+        unsigned int b_max = 0, th_min = 0;
+        size_t len_max = 0;
+        for (unsigned int b = 0; b < 256; b++) {
+            if (!is_assigned[b] && ub[b] - lb[b] >= len_max) {
+                len_max = ub[b] - lb[b];
+                b_max = b;
+            }
+        }
+        for (unsigned int i = 1; i < nthreads; i++) {
+            if (load[i] < load[th_min]) {
+                th_min = i;
+            }
+        }
+        is_assigned[b_max] = 1;
+        obj.bucket_thread[b_max] = (unsigned char) th_min;
+        load[th_min] += len_max;
+    }
+    RadixSort64Mt_run_threads(&obj, RadixSort64Mt_recursion_thread);
+    free(obj.heads);
+    free(obj.tails);
+    free(obj.bucket_thread);
+}
+
+
 /**
  * @brief Fast sort for 64-bit integers with automatic selection of the sorting
  * algorithm. Now it always uses the in-place radix sort.
@@ -614,6 +1715,15 @@ void fastsort64(uint64_t *x, size_t len)
     radixsort64_inplace(x, len);
 }
 
+/**
+ * @brief Multithreaded version of `fastsort64`.
+ * @param nthreads  Number of threads (0 or 1 - single-threaded version).
+ */
+void fastsort64_mt(uint64_t *x, size_t len, unsigned int nthreads)
+{
+    radixsort64_inplace_mt(x, len, nthreads);
+}
+
 
 void fastsort32(uint32_t *x, size_t len)
 {
@@ -662,54 +1772,76 @@ void snprintf_elapsed_time(char *buf, size_t len, unsigned long long nseconds_to
 }
 
 
-typedef struct {
-    size_t ind; ///< Test index (ID) inside battery and in the output buffer
-    size_t ord; ///< Test ordinal (for output information)
-} TestIndex;
-
-////////////////////////////////////////////
-///// ThreadQueue class implementation /////
-////////////////////////////////////////////
-
-typedef struct {
-    GeneratorState gen; ///< Per-thread PRNG
-    TestIndex *tests_inds; ///< Test indexes and ordinals
-    size_t ntests;
-    size_t front;
-    unsigned int thread_ord; ///< Thread ordinal
-} ThreadQueue;
-
-
-void ThreadQueue_init(ThreadQueue *obj, const GeneratorInfo *gi,
-    const CallerAPI *intf, unsigned int thread_ord)
+/**
+ * @brief Returns the estimated peak memory consumption of the test, bytes.
+ * Tests without the estimator use only small buffers, 0 is returned
+ * for them.
+ */
+static size_t TestDescription_get_memory(const TestDescription *obj)
 {
-    obj->ntests = 0;
-    obj->front = 0;
-    obj->thread_ord = thread_ord;
-    obj->tests_inds = calloc(1, sizeof(TestIndex));
-    obj->gen = GeneratorState_create(gi, intf);
+    if (obj->traits == NULL || obj->traits->memory == NULL || obj->udata == NULL) {
+        return 0;
+    }
+    return obj->traits->memory(obj->udata);
 }
 
 
-void ThreadQueue_push_back(ThreadQueue *obj, TestIndex index)
+/**
+ * @brief Returns the memory budget for the simultaneously running tests.
+ * @details The default budget is 3/4 of the total physical RAM: the available
+ * RAM reported by OS usually doesn't include reclaimable file caches.
+ * @param mem_limit  User defined limit, bytes (0 - default budget).
+ * @return Budget in bytes or `SIZE_MAX` if RAM size is unknown.
+ */
+static size_t get_tests_mem_budget(size_t mem_limit)
 {
-    obj->ntests++;
-    obj->tests_inds = realloc(obj->tests_inds, obj->ntests * sizeof(TestIndex));
-    obj->tests_inds[obj->ntests - 1] = index;
+    RamInfo info;
+    if (mem_limit != 0) {
+        return mem_limit;
+    } else if (!get_ram_info(&info) || info.phys_total_nbytes <= 0) {
+        return SIZE_MAX;
+    } else {
+        return (size_t) (info.phys_total_nbytes / 4 * 3);
+    }
 }
 
+/// Memory budget for tests in the multithreaded mode, bytes.
+static size_t tests_mem_budget = SIZE_MAX;
 
-TestIndex ThreadQueue_pop_front(ThreadQueue *obj)
-{
-    static const TestIndex none = {.ind = SIZE_MAX, .ord = SIZE_MAX};
-    return (obj->front == obj->ntests) ? none : obj->tests_inds[obj->front++];
-}
+/// Number of worker threads, limits the helper threads of the split/merge mode.
+static unsigned int tests_nthreads = 1;
+
+/// 1 - pin worker threads to CPU cores (see pin_current_thread).
+static int tests_pin_threads = 0;
+
+/// 1 - fixed assignment of tests to worker threads (see TestsDispatcher).
+static int tests_static_schedule = 0;
+
+
+/**
+ * @brief Test index and its expected cost, used by the multithreaded
+ * tests dispatcher.
+ */
+typedef struct {
+    size_t ind; ///< Test index (ID) inside battery and in the output buffer
+    size_t ord; ///< Test ordinal (for output information)
+    unsigned int cost; ///< Expected relative cost of the test
+    size_t mem; ///< Estimated peak memory consumption, bytes
+    unsigned int worker; ///< Worker index (0-based) for the static schedule
+} TestIndex;
 
 
-void ThreadQueue_destruct(ThreadQueue *obj)
+/**
+ * @brief Comparator for sorting tests by their expected costs (the longest
+ * tests go first). Tests with equal costs are sorted by their indexes.
+ */
+static int TestIndex_cmp_cost(const void *aptr, const void *bptr)
 {
-    GeneratorState_destruct(&obj->gen);
-    free(obj->tests_inds);
+    const TestIndex *a = aptr, *b = bptr;
+    if (a->cost != b->cost) {
+        return (a->cost > b->cost) ? -1 : 1;
+    }
+    return (a->ind > b->ind) - (a->ind < b->ind);
 }
 
 ////////////////////////////////////////////////
@@ -717,95 +1849,293 @@ void ThreadQueue_destruct(ThreadQueue *obj)
 ////////////////////////////////////////////////
 
 /**
- * @brief State of multi-threaded tests dispatcher. It uses PRNG from entropy
- * module but its result is fully determined by the PRNG input. This determinism
- * allows to obtain completely reproducible results (e.g. p-values in the test
- * reports) from the same seed.
+ * @brief State of multi-threaded tests dispatcher. All tests are kept in
+ * the shared queue sorted by their expected costs, and each worker thread
+ * takes the next test from the queue as soon as it becomes free. Each test
+ * has its own PRNG example seeded from its own substream (see TestSeeder),
+ * so the results (e.g. p-values in the test reports) are completely
+ * reproducible from the same seed and don't depend on the order of tests
+ * execution and the number of threads.
+ *
+ * Tests are admitted only while the sum of their estimated memory
+ * consumptions fits into the budget: a thread takes the first test from
+ * the queue that fits and waits for the memory release if there are no
+ * such tests. A test that is larger than the whole budget is run only
+ * when no other tests are running. Idle workers may be lent to the running
+ * tests as helper threads of the split/merge mode: they are not used for
+ * new tests until their return.
+ *
+ * In the static mode each test is assigned to the worker thread in advance:
+ * the sorted tests are given one by one to the least loaded worker (longest
+ * processing time first rule), and each worker runs its tests in the queue
+ * order. It is used for the shared input sources (stdin, files): the data
+ * consumed by each test then depend only on the number of threads, not on
+ * their timing. The memory budget is not applied in the static mode:
+ * waiting workers could block the input source shared with running ones.
  */
 typedef struct {
-    size_t *res_thrd_ord;
     const TestsBattery *bat;
     size_t ntests;
     TestResults *results;
     const GeneratorInfo *gi;
     const CallerAPI *intf;
-    ThreadQueue *queues;
+    size_t *nseeds; ///< Number of seeds used by each test
+    TestIndex *queue; ///< Tests sorted by expected costs (the longest first)
+    size_t nqueue; ///< Number of tests in the queue
+    size_t front; ///< Position of the next test in the queue
     unsigned int nthreads;
+    size_t mem_limit; ///< Memory budget for the running tests, bytes
+    size_t mem_used; ///< Estimated memory used by the running tests, bytes
+    unsigned int nrunning; ///< Number of running tests
+    unsigned int nwaiting; ///< Number of threads waiting for memory release
+    unsigned int nhelpers; ///< Idle workers lent to the split/merge mode
+    Semaphore mem_released; ///< Signals about memory release to waiting threads
+    int is_static; ///< 1 - static schedule (fixed tests for each worker)
+    size_t *next; ///< Next queue position for each worker (static schedule)
+    ThreadLogQueue logs; ///< Logs of the tests, written in the tests order
 } TestsDispatcher;
 
 
-void TestsDispatcher_init(TestsDispatcher *obj, const TestsBattery *bat,
-    const GeneratorInfo *gen, const CallerAPI *intf,
-    unsigned int nthreads, TestResults *results,
-    int shuffle)
+DECLARE_MUTEX(tests_queue_mutex)
+
+/// Dispatcher of the running battery (NULL in the one-threaded mode).
+static TestsDispatcher *tests_dispatcher = NULL;
+
+
+/**
+ * @brief Assigns the sorted tests to workers for the static schedule:
+ * each test goes to the worker with the smallest total cost of the
+ * already assigned tests (to the lowest index in the case of ties).
+ */
+static void TestsDispatcher_assign_workers(TestsDispatcher *obj)
+{
+    obj->is_static = tests_static_schedule;
+    obj->next = calloc(obj->nthreads, sizeof(size_t));
+    unsigned long long *load = calloc(obj->nthreads, sizeof(unsigned long long));
+    if (obj->next == NULL || load == NULL) {
+        fprintf(stderr, "***** TestsDispatcher_assign_workers: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < obj->nqueue; i++) {
+        unsigned int w_min = 0;
+        for (unsigned int w = 1; w < obj->nthreads; w++) {
+            if (load[w] < load[w_min]) {
+                w_min = w;
+            }
+        }
+        obj->queue[i].worker = w_min;
+        load[w_min] += obj->queue[i].cost;
+    }
+    free(load);
+}
+
+
+/**
+ * @brief Initializes the dispatcher.
+ * @param skip  Tests that shouldn't be put into the queue, e.g. already
+ *              run in the pipelined mode (NULL - run all tests).
+ */
+void TestsDispatcher_init(TestsDispatcher *obj, const TestsBattery *bat,
+    const GeneratorInfo *gen, const CallerAPI *intf,
+    unsigned int nthreads, TestResults *results, const int *skip)
 {
     size_t ntests = TestsBattery_ntests(bat);
-    obj->res_thrd_ord = calloc(ntests, sizeof(size_t));
     obj->bat = bat;
     obj->ntests = ntests;
     obj->results = results;
     obj->gi = gen;
     obj->intf = intf;
     obj->nthreads = nthreads;
-    obj->queues = calloc(nthreads, sizeof(ThreadQueue));
-
-    // They should be initialized BEFORE shuffling: shuffling
-    // uses get_seed64 from entropy generator.
-    for (unsigned int i = 0; i < nthreads; i++) {
-        const unsigned int thread_ord = i + THREAD_ORD_OFFSET;
-        seed64_mt_current_thread_ord = thread_ord;
-        ThreadQueue_init(&obj->queues[i], gen, intf, thread_ord);
-    }
-    seed64_mt_current_thread_ord = 0;
-    // Prepare an unshuffled array of indexes
-    TestIndex *inds = calloc(ntests, sizeof(TestIndex));
+    obj->front = 0;
+    obj->mem_limit = tests_mem_budget;
+    obj->mem_used = 0;
+    obj->nrunning = 0;
+    obj->nwaiting = 0;
+    obj->nhelpers = 0;
+    obj->nseeds = calloc(ntests, sizeof(size_t));
+    ASSERT_MALLOC_PTR(obj->nseeds, "TestsDispatcher_init");
+    obj->queue = calloc(ntests, sizeof(TestIndex));
+    ASSERT_MALLOC_PTR(obj->queue, "TestsDispatcher_init");
+    // Sort tests by their expected costs: the longest tests should be
+    // started first to prevent idle threads at the end of the battery.
+    obj->nqueue = 0;
     for (size_t i = 0; i < ntests; i++) {
-        inds[i].ind = i;
-        inds[i].ord = i + THREAD_ORD_OFFSET;
-    }
-    // An optional shuffling (shuffling indexes but not ordinals)
-    if (shuffle) {
-        uint64_t state = intf->get_seed64();
-        for (size_t i = 0; i < ntests; i++) {
-            state = pcg_bits64(&state);
-            size_t j = (size_t) (state % ntests);
-            size_t tmp = inds[i].ind;
-            inds[i].ind = inds[j].ind;
-            inds[j].ind = tmp;
+        if (skip != NULL && skip[i]) {
+            continue;
         }
+        obj->queue[obj->nqueue].ind = i;
+        obj->queue[obj->nqueue].cost = bat->tests[i].cost;
+        obj->queue[obj->nqueue].mem = TestDescription_get_memory(&bat->tests[i]);
+        obj->nqueue++;
     }
-    // Assign tests to threads
-    unsigned int thr_id = 0;
-    for (size_t i = 0; i < ntests; i++) {
-        thr_id = (thr_id + 1) % nthreads;
-        ThreadQueue_push_back(&obj->queues[thr_id], inds[i]);
+    qsort(obj->queue, obj->nqueue, sizeof(TestIndex), TestIndex_cmp_cost);
+    for (size_t i = 0; i < obj->nqueue; i++) {
+        obj->queue[i].ord = i + 1;
     }
-    // Free internal buffers
-    free(inds);
+    TestsDispatcher_assign_workers(obj);
+    ThreadLogQueue_init(&obj->logs, ntests, skip);
+    Semaphore_init(&obj->mem_released, 0);
+    INIT_MUTEX(tests_queue_mutex);
 }
 
 
-ThreadQueue *
-TestsDispatcher_get_queue_by_ord(const TestsDispatcher *obj, unsigned int ord)
+/**
+ * @brief Checks if the test can be started without exceeding the memory
+ * budget and the number of workers not lent to the split/merge mode.
+ * Must be called under the `tests_queue_mutex`.
+ */
+static inline int TestsDispatcher_is_admitted(const TestsDispatcher *obj,
+    const TestIndex *ti)
 {
-    for (unsigned int i = 0; i < obj->nthreads; i++) {
-        if (obj->queues[i].thread_ord == ord) {
-            return &obj->queues[i];
+    if (obj->nrunning + obj->nhelpers >= obj->nthreads) {
+        return 0;
+    }
+    return obj->nrunning == 0 ||
+        (ti->mem <= obj->mem_limit && obj->mem_used <= obj->mem_limit - ti->mem);
+}
+
+
+/**
+ * @brief Takes the first test from the shared queue that fits into the
+ * memory budget. If there are no such tests, waits until some of the
+ * running tests will release memory. In the static mode takes the next
+ * test assigned to the worker. Returns the index equal to `SIZE_MAX`
+ * if the queue is empty. Thread-safe.
+ * @param worker  Worker index (0-based).
+ */
+TestIndex TestsDispatcher_pop_front(TestsDispatcher *obj, unsigned int worker)
+{
+    static const TestIndex none = {.ind = SIZE_MAX, .ord = SIZE_MAX,
+        .cost = 0, .mem = 0, .worker = 0};
+    if (obj->is_static) {
+        // Positions of different workers are not shared: no locks
+        for (size_t i = obj->next[worker]; i < obj->nqueue; i++) {
+            if (obj->queue[i].worker == worker) {
+                obj->next[worker] = i + 1;
+                return obj->queue[i];
+            }
+        }
+        obj->next[worker] = obj->nqueue;
+        return none;
+    }
+    for (;;) {
+        TestIndex ti = none;
+        int must_wait = 0;
+        MUTEX_LOCK(tests_queue_mutex, "TestsDispatcher_pop_front");
+        for (size_t i = obj->front; i < obj->nqueue; i++) {
+            if (TestsDispatcher_is_admitted(obj, &obj->queue[i])) {
+                // Keep the order of the skipped (postponed) tests
+                ti = obj->queue[i];
+                memmove(&obj->queue[obj->front + 1], &obj->queue[obj->front],
+                    (i - obj->front) * sizeof(TestIndex));
+                obj->front++;
+                obj->nrunning++;
+                obj->mem_used += ti.mem;
+                break;
+            }
         }
+        if (ti.ind == SIZE_MAX && obj->front < obj->nqueue) {
+            obj->nwaiting++;
+            must_wait = 1;
+        }
+        MUTEX_UNLOCK(tests_queue_mutex);
+        if (!must_wait) {
+            return ti;
+        }
+        Semaphore_wait(&obj->mem_released);
     }
-    return NULL;
 }
 
 
+/**
+ * @brief Releases the memory reserved by the finished test and wakes up
+ * threads waiting for it. Thread-safe.
+ */
+void TestsDispatcher_release(TestsDispatcher *obj, const TestIndex *ti)
+{
+    if (obj->is_static) {
+        return;
+    }
+    MUTEX_LOCK(tests_queue_mutex, "TestsDispatcher_release");
+    const unsigned int nwaiting = obj->nwaiting;
+    obj->mem_used -= ti->mem;
+    obj->nrunning--;
+    obj->nwaiting = 0;
+    MUTEX_UNLOCK(tests_queue_mutex);
+    for (unsigned int i = 0; i < nwaiting; i++) {
+        Semaphore_post(&obj->mem_released);
+    }
+}
 
-void TestsDispatcher_destruct(TestsDispatcher *obj)
+
+/**
+ * @brief Lends idle workers to the split/merge mode of the running test
+ * (see GeneratorState_collect_counts). Each helper thread needs `nbytes`
+ * for its table of counts that is charged to the memory budget. In the
+ * one-threaded mode only one test is run, so other threads are idle.
+ * Workers are not lent in the static mode. Thread-safe.
+ * @param nhelpers_max  Maximal number of helper threads.
+ * @param nbytes        Memory for one helper thread, bytes.
+ * @return Number of lent workers (may be 0).
+ */
+static unsigned int tests_borrow_helpers(unsigned int nhelpers_max, size_t nbytes)
+{
+    TestsDispatcher *obj = tests_dispatcher;
+    unsigned int nidle;
+    size_t mem_free;
+    if (obj == NULL) {
+        nidle = tests_nthreads - 1;
+        mem_free = tests_mem_budget;
+    } else if (obj->is_static) {
+        return 0;
+    } else {
+        MUTEX_LOCK(tests_queue_mutex, "tests_borrow_helpers");
+        nidle = obj->nthreads - obj->nrunning - obj->nhelpers;
+        mem_free = (obj->mem_used < obj->mem_limit) ? obj->mem_limit - obj->mem_used : 0;
+    }
+    unsigned int nhelpers = (nhelpers_max < nidle) ? nhelpers_max : nidle;
+    if (nbytes > 0 && mem_free / nbytes < nhelpers) {
+        nhelpers = (unsigned int) (mem_free / nbytes);
+    }
+    if (obj != NULL) {
+        obj->nhelpers += nhelpers;
+        obj->mem_used += nhelpers * nbytes;
+        MUTEX_UNLOCK(tests_queue_mutex);
+    }
+    return nhelpers;
+}
+
+
+/**
+ * @brief Returns the workers lent by `tests_borrow_helpers` and wakes up
+ * threads waiting for them. Thread-safe.
+ */
+static void tests_return_helpers(unsigned int nhelpers, size_t nbytes)
 {
-    //free(obj->inds);
-    free(obj->res_thrd_ord);
-    for (unsigned int i = 0; i < obj->nthreads; i++) {
-        ThreadQueue_destruct(&obj->queues[i]);
+    TestsDispatcher *obj = tests_dispatcher;
+    if (obj == NULL || nhelpers == 0) {
+        return;
     }
-    free(obj->queues);
+    MUTEX_LOCK(tests_queue_mutex, "tests_return_helpers");
+    const unsigned int nwaiting = obj->nwaiting;
+    obj->nhelpers -= nhelpers;
+    obj->mem_used -= nhelpers * nbytes;
+    obj->nwaiting = 0;
+    MUTEX_UNLOCK(tests_queue_mutex);
+    for (unsigned int i = 0; i < nwaiting; i++) {
+        Semaphore_post(&obj->mem_released);
+    }
+}
+
+
+void TestsDispatcher_destruct(TestsDispatcher *obj)
+{
+    free(obj->nseeds);
+    free(obj->queue);
+    free(obj->next);
+    ThreadLogQueue_destruct(&obj->logs);
+    Semaphore_destruct(&obj->mem_released);
+    MUTEX_DESTROY(tests_queue_mutex);
 }
 
 
@@ -839,36 +2169,78 @@ unsigned int TestsBattery_get_testid(const TestsBattery *obj, const TestIdentifi
 }
 
 
+/**
+ * @brief Runs the test with the given index using its own PRNG example.
+ * @details The PRNG example is seeded from the per-test substream, so
+ * the results depend only on the battery seed and the test index.
+ * @param bat         The battery.
+ * @param ind         0-based test index inside the battery.
+ * @param gi          The generator to be tested.
+ * @param intf        Caller API (single- or multithreaded).
+ * @param thread_ord  Ordinal of the current thread (0 - main thread).
+ * @param[out] nseeds Number of seeds consumed by the test (for seeds log).
+ */
+static TestResults TestsBattery_run_test(const TestsBattery *bat, size_t ind,
+    const GeneratorInfo *gi, const CallerAPI *intf, unsigned int thread_ord,
+    size_t *nseeds)
+{
+    TestSeeder_start(thread_ord, ind + 1);
+    GeneratorState gen = GeneratorState_create(gi, intf);
+    const double wall_tic = get_wall_time(), cpu_tic = get_thread_cpu_time();
+    TestResults res = TestDescription_run(&bat->tests[ind], &gen);
+    res.wall_time = get_wall_time() - wall_tic;
+    res.cpu_time = get_thread_cpu_time() - cpu_tic;
+    res.nvalues = GeneratorState_get_nvalues(&gen);
+    res.nbytes = res.nvalues * (gi->nbits / 8);
+    GeneratorState_destruct(&gen);
+    *nseeds = TestSeeder_stop(thread_ord);
+    res.name = bat->tests[ind].name;
+    res.id = (unsigned int) (ind + 1);
+    res.thread_id = 0;
+    return res;
+}
+
+
 static ThreadRetVal THREADFUNC_SPEC battery_thread(void *data)
 {
     TestsDispatcher *th_data = data;
     const TestsBattery *bat = th_data->bat;
     ThreadObj thrd = ThreadObj_current();
+    const unsigned int worker = thrd.ord - THREAD_ORD_OFFSET;
     th_data->intf->printf("vvvvvvvvvv Thread %u started vvvvvvvvvv\n", thrd.ord);
-    ThreadQueue *queue = TestsDispatcher_get_queue_by_ord(th_data, thrd.ord);
-    if (queue == NULL) {
-        fprintf(stderr, "***** Thread %u: cannot find queue *****\n", thrd.ord);
-        exit(EXIT_FAILURE);
+    // Pinning is done before allocation of any test buffers: they will
+    // be placed on the local NUMA node of the thread.
+    if (tests_pin_threads) {
+        ThreadPlacement pl;
+        if (pin_current_thread(worker, &pl)) {
+            th_data->intf->printf("Thread %u: pinned to CPU %d (NUMA node %d)\n",
+                thrd.ord, pl.cpu, pl.node);
+        } else {
+            th_data->intf->printf("Thread %u: cannot pin thread to CPU\n", thrd.ord);
+        }
     }
-    for (TestIndex ti = ThreadQueue_pop_front(queue);
+    for (TestIndex ti = TestsDispatcher_pop_front(th_data, worker);
         ti.ind < th_data->ntests;
-        ti = ThreadQueue_pop_front(queue))
+        ti = TestsDispatcher_pop_front(th_data, worker))
     {
         th_data->intf->printf(
             "vvvvv Thread %u: test #%lld: %s (%lld of %lld) started vvvvv\n",
             thrd.ord,
             (long long) ti.ind + 1, bat->tests[ti.ind].name,
-            (long long) ti.ord, (long long) th_data->ntests);
-        th_data->results[ti.ind] = TestDescription_run(&bat->tests[ti.ind], &queue->gen);
-        th_data->res_thrd_ord[ti.ind] = thrd.ord;
+            (long long) ti.ord, (long long) th_data->nqueue);
+        // Memory kept by the arena is not counted by the dispatcher
+        TestArena_shrink(TestArena_current(), ti.mem);
+        ThreadLogQueue_start(&th_data->logs, ti.ind, thrd.ord);
+        th_data->results[ti.ind] = TestsBattery_run_test(bat, ti.ind,
+            th_data->gi, th_data->intf, thrd.ord, &th_data->nseeds[ti.ind]);
+        ThreadLogQueue_finish(&th_data->logs, ti.ind);
         th_data->intf->printf(
             "^^^^^ Thread %u: test #%lld: %s (%lld of %lld) finished ^^^^^\n",
             thrd.ord,
             (long long) ti.ind + 1, bat->tests[ti.ind].name,
-            (long long) ti.ord, (long long) th_data->ntests);
-        th_data->results[ti.ind].name = bat->tests[ti.ind].name;
-        th_data->results[ti.ind].id = (unsigned int) (ti.ind + 1);
+            (long long) ti.ord, (long long) th_data->nqueue);
         th_data->results[ti.ind].thread_id = thrd.ord;
+        TestsDispatcher_release(th_data, &ti);
     }
     th_data->intf->printf("^^^^^^^^^^ Thread %u finished ^^^^^^^^^^\n", thrd.ord);
     return 0;
@@ -880,27 +2252,489 @@ static ThreadRetVal THREADFUNC_SPEC battery_thread(void *data)
  */
 static void TestsBattery_run_threads(const TestsBattery *bat,
     const GeneratorInfo *gen, const CallerAPI *intf,
-    const BatteryOptions *opts, TestResults *results)
+    unsigned int nthreads, TestResults *results, const int *skip)
 {
     TestsDispatcher tdisp;
-    TestsDispatcher_init(&tdisp, bat, gen, intf, opts->nthreads, results, 1);
+    TestsDispatcher_init(&tdisp, bat, gen, intf, nthreads, results, skip);
     // Run threads
     init_thread_dispatcher();
-    ThreadObj *thrd = calloc(opts->nthreads, sizeof(ThreadObj));
-    for (unsigned int i = 0; i < opts->nthreads; i++) {
-        const unsigned int ord = tdisp.queues[i].thread_ord;
-        thrd[i] = ThreadObj_create(battery_thread, &tdisp, ord);
+    tests_dispatcher = &tdisp;
+    ThreadObj *thrd = calloc(nthreads, sizeof(ThreadObj));
+    for (unsigned int i = 0; i < nthreads; i++) {
+        thrd[i] = ThreadObj_create(battery_thread, &tdisp, i + THREAD_ORD_OFFSET);
     }
     // Get data from threads
-    for (size_t i = 0; i < opts->nthreads; i++) {
+    for (size_t i = 0; i < nthreads; i++) {
         ThreadObj_wait(&thrd[i]);
     }
+    tests_dispatcher = NULL;
+    // Add seeds from per-test substreams to the log
+    for (size_t i = 0; i < tdisp.ntests; i++) {
+        if (skip == NULL || !skip[i]) {
+            Entropy_log_substream(&entropy, i + 1, tdisp.nseeds[i]);
+        }
+    }
     // Deallocate array
     TestsDispatcher_destruct(&tdisp);
     free(thrd);
 }
 
 
+//////////////////////////////////////////////
+///// TestsPipeline class implementation /////
+//////////////////////////////////////////////
+
+enum {
+    PIPELINE_BLOCK_SIZE = 64 * GENERATOR_STATE_BUFSIZE, ///< Block size, in u32/u64 values
+    PIPELINE_NBLOCKS = 16 ///< Number of blocks in the broadcast ring
+};
+
+/**
+ * @brief Broadcast ring buffer for the pipelined mode: one producer writes
+ * blocks of the generator output, each block is read by all active
+ * consumers and is reused only after being released by the last of them.
+ * @details Blocks are released by each consumer in the same order as they
+ * are written, so the ring is just a FIFO with a counter of free blocks.
+ * The number of consumers is fixed before the producer is started; the
+ * consumer that finishes its test is detached and releases all unread
+ * blocks at once.
+ */
+typedef struct {
+    uint64_t *data; ///< PIPELINE_NBLOCKS blocks of PIPELINE_BLOCK_SIZE values
+    unsigned int nreaders[PIPELINE_NBLOCKS]; ///< Readers that haven't released the block
+    Semaphore nfree; ///< Number of free blocks (for the producer)
+    Semaphore *navail; ///< Number of written blocks (for each consumer)
+    unsigned long long *nposted; ///< Number of blocks posted to each consumer
+    unsigned long long *nreleased; ///< Number of blocks released by each consumer
+    int *is_active; ///< 0 for detached consumers
+    unsigned int nconsumers; ///< Total number of consumers
+    unsigned int nactive; ///< Number of active (not detached) consumers
+    unsigned long long nblocks; ///< Number of blocks written by the producer
+} BroadcastRing;
+
+
+DECLARE_MUTEX(pipeline_ring_mutex)
+
+
+static void BroadcastRing_init(BroadcastRing *obj, unsigned int nconsumers)
+{
+    obj->data = malloc(PIPELINE_NBLOCKS * PIPELINE_BLOCK_SIZE * sizeof(uint64_t));
+    obj->navail = calloc(nconsumers, sizeof(Semaphore));
+    obj->nposted = calloc(nconsumers, sizeof(unsigned long long));
+    obj->nreleased = calloc(nconsumers, sizeof(unsigned long long));
+    obj->is_active = calloc(nconsumers, sizeof(int));
+    if (obj->data == NULL || obj->navail == NULL || obj->nposted == NULL ||
+        obj->nreleased == NULL || obj->is_active == NULL) {
+        fprintf(stderr, "***** BroadcastRing_init: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < PIPELINE_NBLOCKS; i++) {
+        obj->nreaders[i] = 0;
+    }
+    Semaphore_init(&obj->nfree, PIPELINE_NBLOCKS);
+    for (unsigned int i = 0; i < nconsumers; i++) {
+        Semaphore_init(&obj->navail[i], 0);
+        obj->is_active[i] = 1;
+    }
+    obj->nconsumers = nconsumers;
+    obj->nactive = nconsumers;
+    obj->nblocks = 0;
+    INIT_MUTEX(pipeline_ring_mutex);
+}
+
+
+static void BroadcastRing_destruct(BroadcastRing *obj)
+{
+    Semaphore_destruct(&obj->nfree);
+    for (unsigned int i = 0; i < obj->nconsumers; i++) {
+        Semaphore_destruct(&obj->navail[i]);
+    }
+    free(obj->data);
+    free(obj->navail);
+    free(obj->nposted);
+    free(obj->nreleased);
+    free(obj->is_active);
+    MUTEX_DESTROY(pipeline_ring_mutex);
+}
+
+
+/**
+ * @brief Decrements the readers counter of the block, the block becomes
+ * free after the last reader. Should be called under the mutex.
+ */
+static inline void BroadcastRing_release_block(BroadcastRing *obj,
+    unsigned long long block_id)
+{
+    const size_t ind = (size_t) (block_id % PIPELINE_NBLOCKS);
+    if (--obj->nreaders[ind] == 0) {
+        Semaphore_post(&obj->nfree);
+    }
+}
+
+
+/**
+ * @brief Producer: fills the blocks by the generator output until all
+ * consumers are detached. Returns the number of generated values.
+ */
+static unsigned long long BroadcastRing_produce(BroadcastRing *obj, GeneratorState *gen)
+{
+    for (unsigned long long block_id = 0; ; block_id++) {
+        Semaphore_wait(&obj->nfree);
+        MUTEX_LOCK(pipeline_ring_mutex, "BroadcastRing_produce");
+        const unsigned int nactive = obj->nactive;
+        MUTEX_UNLOCK(pipeline_ring_mutex);
+        if (nactive == 0) {
+            break;
+        }
+        uint64_t *block = obj->data +
+            (size_t) (block_id % PIPELINE_NBLOCKS) * PIPELINE_BLOCK_SIZE;
+        if (gen->gi->fill != NULL) {
+            gen->gi->fill(gen->state, block, PIPELINE_BLOCK_SIZE);
+        } else {
+            uint64_t (*get_bits)(void *) = gen->gi->get_bits;
+            for (size_t i = 0; i < PIPELINE_BLOCK_SIZE; i++) {
+                block[i] = get_bits(gen->state);
+            }
+        }
+        // Broadcast the block to all consumers that are still active
+        MUTEX_LOCK(pipeline_ring_mutex, "BroadcastRing_produce");
+        if (obj->nactive == 0) {
+            MUTEX_UNLOCK(pipeline_ring_mutex);
+            break;
+        }
+        obj->nreaders[block_id % PIPELINE_NBLOCKS] = obj->nactive;
+        for (unsigned int i = 0; i < obj->nconsumers; i++) {
+            if (obj->is_active[i]) {
+                obj->nposted[i]++;
+                Semaphore_post(&obj->navail[i]);
+            }
+        }
+        obj->nblocks++;
+        MUTEX_UNLOCK(pipeline_ring_mutex);
+    }
+    return obj->nblocks * PIPELINE_BLOCK_SIZE;
+}
+
+
+/**
+ * @brief Consumer generator description: a copy of the tested generator
+ * description with callbacks that read the broadcast ring.
+ */
+typedef struct {
+    GeneratorInfo gi; ///< Must be the first field: callbacks receive a pointer to it
+    BroadcastRing *ring;
+    unsigned int ind; ///< Consumer index
+} PipelineConsumerInfo;
+
+
+/**
+ * @brief Consumer "generator" state: a pointer to the unread part
+ * of the current block.
+ */
+typedef struct {
+    BroadcastRing *ring;
+    unsigned int ind; ///< Consumer index
+    const uint64_t *pos; ///< Next unread value in the current block
+    const uint64_t *end; ///< End of the current block
+    int has_block; ///< 1 if the current block is acquired
+} PipelineConsumer;
+
+
+static void PipelineConsumer_next_block(PipelineConsumer *obj)
+{
+    BroadcastRing *ring = obj->ring;
+    if (obj->has_block) {
+        MUTEX_LOCK(pipeline_ring_mutex, "PipelineConsumer_next_block");
+        BroadcastRing_release_block(ring, ring->nreleased[obj->ind]++);
+        MUTEX_UNLOCK(pipeline_ring_mutex);
+    }
+    Semaphore_wait(&ring->navail[obj->ind]);
+    // Blocks below `nposted` are not rewritten before their release
+    const size_t block_ind = (size_t) (ring->nreleased[obj->ind] % PIPELINE_NBLOCKS);
+    obj->pos = ring->data + block_ind * PIPELINE_BLOCK_SIZE;
+    obj->end = obj->pos + PIPELINE_BLOCK_SIZE;
+    obj->has_block = 1;
+}
+
+
+static void *PipelineConsumer_create(const GeneratorInfo *gi, const CallerAPI *intf)
+{
+    const PipelineConsumerInfo *info = (const void *) gi; // gi is its first field
+    PipelineConsumer *obj = malloc(sizeof(PipelineConsumer));
+    ASSERT_MALLOC_PTR(obj, "PipelineConsumer_create");
+    obj->ring = info->ring;
+    obj->ind = info->ind;
+    obj->pos = NULL;
+    obj->end = NULL;
+    obj->has_block = 0;
+    (void) intf;
+    return obj;
+}
+
+
+/**
+ * @brief Detaches the consumer from the ring: all blocks posted to it
+ * (including the current one) are released.
+ */
+static void PipelineConsumer_free(void *state, const GeneratorInfo *gi, const CallerAPI *intf)
+{
+    PipelineConsumer *obj = state;
+    BroadcastRing *ring = obj->ring;
+    const unsigned int ind = obj->ind;
+    MUTEX_LOCK(pipeline_ring_mutex, "PipelineConsumer_free");
+    ring->is_active[ind] = 0;
+    ring->nactive--;
+    while (ring->nreleased[ind] < ring->nposted[ind]) {
+        BroadcastRing_release_block(ring, ring->nreleased[ind]++);
+    }
+    MUTEX_UNLOCK(pipeline_ring_mutex);
+    free(obj);
+    (void) gi; (void) intf;
+}
+
+
+static uint64_t PipelineConsumer_get_bits(void *state)
+{
+    PipelineConsumer *obj = state;
+    if (obj->pos == obj->end) {
+        PipelineConsumer_next_block(obj);
+    }
+    return *obj->pos++;
+}
+
+
+static void PipelineConsumer_fill(void *state, uint64_t *buf, size_t len)
+{
+    PipelineConsumer *obj = state;
+    while (len > 0) {
+        if (obj->pos == obj->end) {
+            PipelineConsumer_next_block(obj);
+        }
+        size_t n = (size_t) (obj->end - obj->pos);
+        if (n > len) {
+            n = len;
+        }
+        memcpy(buf, obj->pos, n * sizeof(uint64_t));
+        obj->pos += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+
+/**
+ * @brief Checks if the test just reads the generator output sequentially
+ * and can be run in the pipelined mode, i.e. as a consumer of the common
+ * generator output stream.
+ */
+static inline int TestDescription_is_pipelined(const TestDescription *obj)
+{
+    return obj->traits != NULL && obj->traits->is_pipelined;
+}
+
+
+/**
+ * @brief Pipelined group of tests: each test is a consumer running in its
+ * own thread, all of them read the same generator output.
+ */
+typedef struct {
+    PipelineConsumerInfo info; ///< Consumer "generator"
+    const TestsBattery *bat;
+    const CallerAPI *intf;
+    TestResults *results;
+    size_t ind; ///< Test index
+    unsigned int ord; ///< Thread ordinal
+    size_t nseeds; ///< Number of seeds used by the test
+} PipelineTask;
+
+
+static ThreadRetVal THREADFUNC_SPEC pipeline_consumer_thread(void *data)
+{
+    PipelineTask *task = data;
+    const TestsBattery *bat = task->bat;
+    task->intf->printf("vvvvv Thread %u: test #%lld: %s (pipelined) started vvvvv\n",
+        task->ord, (long long) task->ind + 1, bat->tests[task->ind].name);
+    task->results[task->ind] = TestsBattery_run_test(bat, task->ind,
+        &task->info.gi, task->intf, task->ord, &task->nseeds);
+    task->results[task->ind].thread_id = task->ord;
+    task->intf->printf("^^^^^ Thread %u: test #%lld: %s (pipelined) finished ^^^^^\n",
+        task->ord, (long long) task->ind + 1, bat->tests[task->ind].name);
+    return 0;
+}
+
+
+/**
+ * @brief Runs one batch of the pipelined tests: the producer is run in the
+ * current thread, each consumer has its own thread. The producer is seeded
+ * from the `stream_id` substream, so all batches read the same stream.
+ * @param tests   Tests of the batch.
+ * @param ntasks  Number of tests in the batch.
+ * @param[out] nseeds  Number of seeds used by the tests (indexed by tests
+ *                     indexes inside the battery).
+ * @param[out] nseeds_producer  Number of seeds used by the producer.
+ * @return Number of generated values.
+ */
+static unsigned long long TestsBattery_run_pipeline_batch(const TestsBattery *bat,
+    const GeneratorInfo *gen, const CallerAPI *intf, TestResults *results,
+    const TestIndex *tests, unsigned int ntasks, size_t stream_id,
+    size_t *nseeds, size_t *nseeds_producer)
+{
+    BroadcastRing ring;
+    BroadcastRing_init(&ring, ntasks);
+    PipelineTask *tasks = calloc(ntasks, sizeof(PipelineTask));
+    ThreadObj *thrd = calloc(ntasks, sizeof(ThreadObj));
+    if (tasks == NULL || thrd == NULL) {
+        fprintf(stderr, "***** TestsBattery_run_pipeline_batch: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int k = 0; k < ntasks; k++) {
+        PipelineTask *task = &tasks[k];
+        task->info.gi = *gen;
+        task->info.gi.create = PipelineConsumer_create;
+        task->info.gi.free = PipelineConsumer_free;
+        task->info.gi.get_bits = PipelineConsumer_get_bits;
+        task->info.gi.fill = PipelineConsumer_fill;
+        task->info.gi.self_test = NULL;
+        task->info.gi.get_sum = NULL;
+        task->info.gi.jump = NULL;
+        task->info.gi.seek = NULL;
+        task->info.gi.discard = NULL;
+        task->info.ring = &ring;
+        task->info.ind = k;
+        task->bat = bat;
+        task->intf = intf;
+        task->results = results;
+        task->ind = tests[k].ind;
+        task->ord = k + THREAD_ORD_OFFSET;
+        task->nseeds = 0;
+    }
+    // The producer is created before the consumers: the generator
+    // seeding may use the caller API from the current thread.
+    TestSeeder_start(0, stream_id);
+    GeneratorState producer = GeneratorState_create(gen, intf);
+    init_thread_dispatcher();
+    for (unsigned int k = 0; k < ntasks; k++) {
+        thrd[k] = ThreadObj_create(pipeline_consumer_thread, &tasks[k], tasks[k].ord);
+    }
+    const unsigned long long nvalues = BroadcastRing_produce(&ring, &producer);
+    for (unsigned int k = 0; k < ntasks; k++) {
+        ThreadObj_wait(&thrd[k]);
+        nseeds[tasks[k].ind] = tasks[k].nseeds;
+    }
+    GeneratorState_destruct(&producer);
+    *nseeds_producer = TestSeeder_stop(0);
+    BroadcastRing_destruct(&ring);
+    free(tasks);
+    free(thrd);
+    return nvalues;
+}
+
+
+/**
+ * @brief Runs the tests marked in the `is_pipelined` array in the pipelined
+ * mode: one generator example (producer) fills blocks of the broadcast
+ * ring and the tests (consumers) process them simultaneously in separate
+ * threads. So the generator output is computed only once for a group of
+ * tests that is especially useful for slow generators.
+ * @details The producer is run in the current thread and is seeded from
+ * the separate substream with the `ntests + 1` identifier, so the results
+ * are reproducible but differ from the ones in the ordinary mode.
+ *
+ * Tests are blocking functions that cannot be interleaved inside one thread,
+ * so the tests are run in batches of at most `nthreads` consumers. Each
+ * batch also must fit into the memory budget of tests together with the
+ * ring and the consumers buffers (a test that doesn't fit is run alone).
+ * Every batch has its own producer that replays the same stream, so the
+ * results don't depend on the number of threads.
+ */
+static void TestsBattery_run_pipeline(const TestsBattery *bat,
+    const GeneratorInfo *gen, const CallerAPI *intf, unsigned int nthreads,
+    TestResults *results, const int *is_pipelined)
+{
+    const size_t ring_nbytes = PIPELINE_NBLOCKS * PIPELINE_BLOCK_SIZE * sizeof(uint64_t);
+    const size_t consumer_nbytes = GENERATOR_STATE_BUFSIZE * sizeof(uint64_t) +
+        sizeof(PipelineConsumer);
+    const size_t ntests = TestsBattery_ntests(bat);
+    TestIndex *queue = calloc(ntests, sizeof(TestIndex));
+    size_t *nseeds = calloc(ntests, sizeof(size_t));
+    if (queue == NULL || nseeds == NULL) {
+        fprintf(stderr, "***** TestsBattery_run_pipeline: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    // Tests with similar costs are grouped into the same batch: the
+    // producer works until the longest consumer is finished.
+    size_t nqueue = 0;
+    for (size_t i = 0; i < ntests; i++) {
+        if (is_pipelined[i]) {
+            queue[nqueue].ind = i;
+            queue[nqueue].cost = bat->tests[i].cost;
+            queue[nqueue].mem = TestDescription_get_memory(&bat->tests[i]) +
+                consumer_nbytes;
+            nqueue++;
+        }
+    }
+    qsort(queue, nqueue, sizeof(TestIndex), TestIndex_cmp_cost);
+    intf->printf("===== Pipelined mode: %u tests share one generator stream =====\n",
+        (unsigned int) nqueue);
+    const size_t stream_id = ntests + 1;
+    size_t nseeds_producer = 0;
+    unsigned long long nvalues = 0;
+    unsigned int nbatches = 0;
+    for (size_t first = 0, last = 0; first < nqueue; first = last) {
+        size_t mem_used = ring_nbytes;
+        for (last = first; last < nqueue && last - first < nthreads; last++) {
+            const size_t mem = queue[last].mem;
+            if (last > first &&
+                (mem > tests_mem_budget || mem_used > tests_mem_budget - mem)) {
+                break;
+            }
+            mem_used += mem;
+        }
+        intf->printf("===== Pipelined mode: batch %u, %u tests, %.1f MiB =====\n",
+            ++nbatches, (unsigned int) (last - first), (double) mem_used / 1048576.0);
+        nvalues += TestsBattery_run_pipeline_batch(bat, gen, intf, results,
+            &queue[first], (unsigned int) (last - first), stream_id,
+            nseeds, &nseeds_producer);
+    }
+    // Seeds log: consumers don't use seeds, the producer uses its own substream
+    unsigned long long nbytes_consumed = 0;
+    for (size_t i = 0; i < nqueue; i++) {
+        Entropy_log_substream(&entropy, queue[i].ind + 1, nseeds[queue[i].ind]);
+        nbytes_consumed += results[queue[i].ind].nbytes;
+    }
+    Entropy_log_substream(&entropy, stream_id, nseeds_producer);
+    intf->printf("===== Pipelined mode: %llu bytes generated, %llu bytes consumed =====\n",
+        nvalues * (gen->nbits / 8), nbytes_consumed);
+    free(queue);
+    free(nseeds);
+}
+
+#ifndef NOTHREADS
+/**
+ * @brief Selects the tests for the pipelined mode. Returns an array
+ * of flags or NULL if there are less than two such tests.
+ */
+static int *TestsBattery_select_pipelined(const TestsBattery *bat)
+{
+    const size_t ntests = TestsBattery_ntests(bat);
+    int *is_pipelined = calloc(ntests + 1, sizeof(int));
+    ASSERT_MALLOC_PTR(is_pipelined, "TestsBattery_select_pipelined");
+    size_t npipelined = 0;
+    for (size_t i = 0; i < ntests; i++) {
+        if (TestDescription_is_pipelined(&bat->tests[i])) {
+            is_pipelined[i] = 1;
+            npipelined++;
+        }
+    }
+    if (npipelined < 2) {
+        free(is_pipelined);
+        return NULL;
+    }
+    return is_pipelined;
+}
+#endif
+
+
 static void snprintf_pvalue(char *buf, size_t len, double p, double alpha)
 {
     if (p != p || alpha != alpha) {
@@ -980,6 +2814,36 @@ TestResultsSummary_fill(TestResultsSummary *obj, const TestResults *results, siz
 }
 
 
+/**
+ * @brief Prints the tests performance table: wall time, CPU time
+ * and amount of consumed generator output.
+ */
+static void TestResults_print_performance(const TestResults *results, size_t ntests)
+{
+    double wall_total = 0.0, cpu_total = 0.0;
+    unsigned long long nbytes_total = 0;
+    printf("Tests performance\n");
+    printf("  %3s %-20s %10s %10s %16s %9s\n",
+        "#", "Test name", "Wall, s", "CPU, s", "Bytes", "GB/s");
+    print_bar();
+    for (size_t i = 0; i < ntests; i++) {
+        const double gb_per_sec = (results[i].wall_time > 0.0) ?
+            (double) results[i].nbytes / results[i].wall_time / 1.0e9 : 0.0;
+        printf("  %3u %-20s %10.2f %10.2f %16llu %9.3f\n",
+            results[i].id, results[i].name, results[i].wall_time,
+            results[i].cpu_time, results[i].nbytes, gb_per_sec);
+        wall_total += results[i].wall_time;
+        cpu_total += results[i].cpu_time;
+        nbytes_total += results[i].nbytes;
+    }
+    print_bar();
+    printf("  %3s %-20s %10.2f %10.2f %16llu %9.3f\n", "", "Total",
+        wall_total, cpu_total, nbytes_total,
+        (wall_total > 0.0) ? (double) nbytes_total / wall_total / 1.0e9 : 0.0);
+    printf("\n");
+}
+
+
 static TestResultsSummary TestResults_print_report(const TestResults *results,
     size_t ntests, time_t nseconds_total, ReportType rtype)
 {
@@ -1007,6 +2871,9 @@ static TestResultsSummary TestResults_print_report(const TestResults *results,
         }
         print_bar();
     }
+    if (rtype == REPORT_FULL) {
+        TestResults_print_performance(results, ntests);
+    }
     printf("Passed:        %u\n", summary.npassed);
     printf("Suspicious:    %u\n", summary.nwarnings);
     printf("Failed:        %u\n", summary.nfailed);
@@ -1019,6 +2886,210 @@ static TestResultsSummary TestResults_print_report(const TestResults *results,
     return summary;
 }
 
+/**
+ * @brief Information about the battery run that is saved into
+ * the machine-readable report.
+ */
+typedef struct {
+    const TestsBattery *bat;
+    const GeneratorInfo *gen;
+    const TestResults *results;
+    size_t nresults;
+    const TestResultsSummary *summary;
+    const char *seed_key_txt; ///< Base64 seed (may be NULL)
+    unsigned int nthreads;
+    double wall_time; ///< Battery wall time, seconds
+} BatteryReport;
+
+
+static void fprint_json_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (const char *c = (str != NULL) ? str : ""; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(fp, "\\%c", *c);
+        } else if ((unsigned char) *c < 0x20) {
+            fprintf(fp, "\\u%.4X", (unsigned int) (unsigned char) *c);
+        } else {
+            fputc(*c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+/**
+ * @brief Prints the floating point number to JSON, NaN and infinities
+ * are replaced by `null`.
+ */
+static void fprint_json_double(FILE *fp, double x)
+{
+    if (x != x || x > DBL_MAX || x < -DBL_MAX) {
+        fprintf(fp, "null");
+    } else {
+        fprintf(fp, "%.17g", x);
+    }
+}
+
+
+static void BatteryReport_save_json(const BatteryReport *obj, FILE *fp)
+{
+    unsigned long long nbytes_total = 0;
+    fprintf(fp, "{\n  \"smokerand_version\": ");
+    fprint_json_string(fp, SMOKERAND_VERSION_FULL);
+    fprintf(fp, ",\n  \"battery\": ");
+    fprint_json_string(fp, obj->bat->name);
+    fprintf(fp, ",\n  \"generator\": {\"name\": ");
+    fprint_json_string(fp, obj->gen->name);
+    fprintf(fp, ", \"parent\": ");
+    if (obj->gen->parent != NULL) {
+        fprint_json_string(fp, obj->gen->parent->name);
+    } else {
+        fprintf(fp, "null");
+    }
+    fprintf(fp, ", \"nbits\": %d},\n", (int) obj->gen->nbits);
+    fprintf(fp, "  \"seed\": ");
+    if (obj->seed_key_txt != NULL) {
+        fprintf(fp, "\"_00_%s\"", obj->seed_key_txt);
+    } else {
+        fprintf(fp, "null");
+    }
+    fprintf(fp, ",\n  \"nthreads\": %u,\n", obj->nthreads);
+    fprintf(fp, "  \"tests\": [\n");
+    for (size_t i = 0; i < obj->nresults; i++) {
+        const TestResults *r = &obj->results[i];
+        fprintf(fp, "    {\"id\": %u, \"name\": ", r->id);
+        fprint_json_string(fp, r->name);
+        fprintf(fp, ", \"x\": ");
+        fprint_json_double(fp, r->x);
+        fprintf(fp, ", \"p\": ");
+        fprint_json_double(fp, r->p);
+        fprintf(fp, ", \"alpha\": ");
+        fprint_json_double(fp, r->alpha);
+        fprintf(fp, ", \"penalty\": ");
+        fprint_json_double(fp, r->penalty);
+        fprintf(fp, ", \"interpretation\": ");
+        fprint_json_string(fp, interpret_pvalue(r->p));
+        fprintf(fp, ", \"thread_id\": %llu, \"wall_time\": ",
+            (unsigned long long) r->thread_id);
+        fprint_json_double(fp, r->wall_time);
+        fprintf(fp, ", \"cpu_time\": ");
+        fprint_json_double(fp, r->cpu_time);
+        fprintf(fp, ", \"nvalues\": %llu, \"nbytes\": %llu}%s\n",
+            r->nvalues, r->nbytes, (i + 1 < obj->nresults) ? "," : "");
+        nbytes_total += r->nbytes;
+    }
+    fprintf(fp, "  ],\n");
+    fprintf(fp, "  \"summary\": {\"npassed\": %u, \"nwarnings\": %u, \"nfailed\": %u, ",
+        obj->summary->npassed, obj->summary->nwarnings, obj->summary->nfailed);
+    fprintf(fp, "\"grade\": ");
+    fprint_json_double(fp, obj->summary->grade);
+    fprintf(fp, ", \"grade_text\": ");
+    fprint_json_string(fp, obj->summary->grade_text);
+    fprintf(fp, ", \"wall_time\": ");
+    fprint_json_double(fp, obj->wall_time);
+    fprintf(fp, ", \"nbytes\": %llu, \"gb_per_sec\": ", nbytes_total);
+    fprint_json_double(fp, (obj->wall_time > 0.0) ?
+        (double) nbytes_total / obj->wall_time / 1.0e9 : 0.0);
+    fprintf(fp, "},\n");
+    fprintf(fp, "  \"seeds_log\": [\n");
+    for (size_t i = 0; i < entropy.slog_pos; i++) {
+        fprintf(fp, "    {\"stream\": %llu, \"seed\": \"0x%.16llX\"}%s\n",
+            (unsigned long long) entropy.slog[i].stream_id,
+            (unsigned long long) entropy.slog[i].seed,
+            (i + 1 < entropy.slog_pos) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+/**
+ * @brief Prints seeds of the given stream (test) from the seeds log
+ * separated by spaces.
+ */
+static void fprint_stream_seeds(FILE *fp, uint64_t stream_id)
+{
+    int is_first = 1;
+    for (size_t i = 0; i < entropy.slog_pos; i++) {
+        if (entropy.slog[i].stream_id == stream_id) {
+            fprintf(fp, "%s0x%.16llX", is_first ? "" : " ",
+                (unsigned long long) entropy.slog[i].seed);
+            is_first = 0;
+        }
+    }
+}
+
+/**
+ * @brief Saves the report as CSV table: one row per test and the last
+ * row with battery totals (its `id` is 0, `x` is the quality grade and
+ * `interpretation` is the grade text). Metadata is repeated in each
+ * row to make them self-contained; the `seeds` column contains seeds
+ * from the test substream (from the main stream for the totals row).
+ */
+static void BatteryReport_save_csv(const BatteryReport *obj, FILE *fp)
+{
+    unsigned long long nvalues_total = 0, nbytes_total = 0;
+    double cpu_total = 0.0;
+    const char *parent = (obj->gen->parent != NULL) ? obj->gen->parent->name : "";
+    const char *seed = (obj->seed_key_txt != NULL) ? obj->seed_key_txt : "";
+    const char *seed_prefix = (obj->seed_key_txt != NULL) ? "_00_" : "";
+    fprintf(fp, "version,battery,generator,parent,nbits,seed,nthreads,"
+        "id,name,x,p,alpha,penalty,interpretation,thread_id,"
+        "wall_time,cpu_time,nvalues,nbytes,gb_per_sec,seeds\n");
+    for (size_t i = 0; i < obj->nresults; i++) {
+        const TestResults *r = &obj->results[i];
+        fprintf(fp, "%s,%s,%s,%s,%d,%s%s,%u,",
+            SMOKERAND_VERSION_FULL, obj->bat->name, obj->gen->name, parent,
+            (int) obj->gen->nbits, seed_prefix, seed, obj->nthreads);
+        fprintf(fp, "%u,%s,%.17g,%.17g,%.17g,%g,%s,%llu,%.6f,%.6f,%llu,%llu,%.6f,",
+            r->id, r->name, r->x, r->p, r->alpha, r->penalty,
+            interpret_pvalue(r->p), (unsigned long long) r->thread_id,
+            r->wall_time, r->cpu_time, r->nvalues, r->nbytes,
+            (r->wall_time > 0.0) ? (double) r->nbytes / r->wall_time / 1.0e9 : 0.0);
+        fprint_stream_seeds(fp, r->id);
+        fprintf(fp, "\n");
+        nvalues_total += r->nvalues;
+        nbytes_total += r->nbytes;
+        cpu_total += r->cpu_time;
+    }
+    fprintf(fp, "%s,%s,%s,%s,%d,%s%s,%u,",
+        SMOKERAND_VERSION_FULL, obj->bat->name, obj->gen->name, parent,
+        (int) obj->gen->nbits, seed_prefix, seed, obj->nthreads);
+    fprintf(fp, "0,TOTAL,%g,,,,%s,,%.6f,%.6f,%llu,%llu,%.6f,",
+        obj->summary->grade, obj->summary->grade_text,
+        obj->wall_time, cpu_total, nvalues_total, nbytes_total,
+        (obj->wall_time > 0.0) ? (double) nbytes_total / obj->wall_time / 1.0e9 : 0.0);
+    fprint_stream_seeds(fp, 0);
+    fprintf(fp, "\n");
+}
+
+/**
+ * @brief Saves the machine-readable (JSON or CSV) report to the file.
+ * @return 0 - failure, 1 - success.
+ */
+static int BatteryReport_save(const BatteryReport *obj, ReportFormat format,
+    const char *filename)
+{
+    if (format == REPORT_FORMAT_TEXT) {
+        return 1;
+    }
+    if (filename == NULL) {
+        filename = (format == REPORT_FORMAT_JSON) ?
+            "smokerand_report.json" : "smokerand_report.csv";
+    }
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot create the report file '%s'\n", filename);
+        return 0;
+    }
+    if (format == REPORT_FORMAT_JSON) {
+        BatteryReport_save_json(obj, fp);
+    } else {
+        BatteryReport_save_csv(obj, fp);
+    }
+    fclose(fp);
+    printf("Report has been saved to '%s'\n", filename);
+    return 1;
+}
+
 /**
  * @brief Prints a summary about the test battery to stdout.
  */
@@ -1036,6 +3107,168 @@ void TestsBattery_print_info(const TestsBattery *obj)
 }
 
 
+/**
+ * @brief Runs the selected tests (all or one) in the one-threaded or
+ * multithreaded mode and adds their seeds to the log.
+ * @param skip  Tests that shouldn't be run (NULL - run all tests).
+ */
+static void TestsBattery_run_tests(const TestsBattery *bat,
+    const GeneratorInfo *gen, const CallerAPI *intf, unsigned int nthreads,
+    unsigned int testid, TestResults *results, const int *skip)
+{
+    const size_t ntests = TestsBattery_ntests(bat);
+    if (nthreads == 1 || testid != TESTS_ALL) {
+        // One-threaded version
+        size_t nseeds;
+        if (testid == TESTS_ALL) {
+            for (size_t i = 0; i < ntests; i++) {
+                if (skip != NULL && skip[i]) {
+                    continue;
+                }
+                intf->printf("----- Test %u of %u (%s)\n",
+                    (unsigned int) (i + 1), (unsigned int) ntests, bat->tests[i].name);
+                results[i] = TestsBattery_run_test(bat, i, gen, intf, 0, &nseeds);
+                Entropy_log_substream(&entropy, i + 1, nseeds);
+            }
+        } else {
+            *results = TestsBattery_run_test(bat, testid - 1, gen, intf, 0, &nseeds);
+            Entropy_log_substream(&entropy, testid, nseeds);
+        }
+    } else {
+        // Multithreaded version
+        TestsBattery_run_threads(bat, gen, intf, nthreads, results, skip);
+    }
+}
+
+
+////////////////////////////////////////////
+///// Progressive mode (sample scaling) /////
+////////////////////////////////////////////
+
+/**
+ * @brief Returns the traits of the test with scalable sample size
+ * or NULL if the test cannot be scaled.
+ */
+static const TestTraits *TestDescription_get_scaler(const TestDescription *obj)
+{
+    if (obj->udata == NULL || obj->traits == NULL || obj->traits->scale == NULL) {
+        return NULL;
+    }
+    return obj->traits;
+}
+
+
+/**
+ * @brief Checks if the test result reaches the failure threshold.
+ */
+static inline int TestResults_is_failed(const TestResults *obj, double fail_pvalue)
+{
+    return obj->p < fail_pvalue || obj->alpha < fail_pvalue;
+}
+
+
+/**
+ * @brief Runs the tests in the progressive mode (similar to PractRand):
+ * the sample sizes of the tests are \f$ 2^{-n}, 2^{-n+1}, \ldots, 1 \f$
+ * of the battery ones, the run is stopped after the first stage with a
+ * failed test.
+ * @details Only tests with the `scale` function in their traits are
+ * scaled, other tests are run only at the first stage. The per-test seeds
+ * are the same at all stages, so the seeds of the rerun tests are removed
+ * from the log before each stage: the log contains the seeds of the last
+ * run of each test.
+ * @param nhalvings    Number of halvings of the sample size at the first stage.
+ * @param fail_pvalue  p-value threshold for the failure.
+ * @return Number of the stage with the first failure (1-based), 0 if
+ * all stages were passed.
+ */
+static unsigned int TestsBattery_run_progressive(const TestsBattery *bat,
+    const GeneratorInfo *gen, const CallerAPI *intf, unsigned int nthreads,
+    unsigned int testid, TestResults *results,
+    unsigned int nhalvings, double fail_pvalue)
+{
+    const size_t ntests = TestsBattery_ntests(bat);
+    const size_t nresults = (testid == TESTS_ALL) ? ntests : 1;
+    TestDescription *tests = calloc(ntests + 1, sizeof(TestDescription));
+    void **scaled_opts = calloc(ntests, sizeof(void *));
+    int *skip = calloc(ntests, sizeof(int));
+    if (tests == NULL || scaled_opts == NULL || skip == NULL) {
+        fprintf(stderr, "***** TestsBattery_run_progressive: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    const TestsBattery stage_bat = {bat->name, tests};
+    const size_t slog_pos = entropy.slog_pos;
+    unsigned long long nbytes_total = 0;
+    unsigned int failed_stage = 0, nstages = 0;
+    for (unsigned int stage = 0; stage <= nhalvings && failed_stage == 0; stage++) {
+        const unsigned int shr = nhalvings - stage;
+        size_t nscaled = 0;
+        memcpy(tests, bat->tests, (ntests + 1) * sizeof(TestDescription));
+        for (size_t i = 0; i < ntests; i++) {
+            const TestTraits *scaler = TestDescription_get_scaler(&tests[i]);
+            if (scaler != NULL) {
+                scaled_opts[i] = malloc(scaler->opts_size);
+                ASSERT_MALLOC_PTR(scaled_opts[i], "TestsBattery_run_progressive");
+                memcpy(scaled_opts[i], tests[i].udata, scaler->opts_size);
+                scaler->scale(scaled_opts[i], shr);
+                tests[i].udata = scaled_opts[i];
+                nscaled += (testid == TESTS_ALL || testid == i + 1) ? 1 : 0;
+            } else {
+                skip[i] = (stage > 0);
+            }
+        }
+        if (stage > 0 && nscaled == 0) {
+            break;
+        }
+        intf->printf("===== Progressive mode: stage %u of %u (sample size 1/%llu) =====\n",
+            stage + 1, nhalvings + 1, 1ull << shr);
+        for (size_t i = 0; i < ntests && stage > 0; i++) {
+            if (!skip[i] && (testid == TESTS_ALL || testid == i + 1)) {
+                Entropy_unlog_substream(&entropy, slog_pos, i + 1);
+            }
+        }
+        nstages++;
+        TestsBattery_run_tests(&stage_bat, gen, intf, nthreads, testid, results, skip);
+        unsigned long long nbytes_stage = 0;
+        unsigned int nfailed = 0;
+        for (size_t i = 0; i < nresults; i++) {
+            const size_t ind = (testid == TESTS_ALL) ? i : testid - 1;
+            if (skip[ind]) {
+                continue;
+            }
+            nbytes_stage += results[i].nbytes;
+            if (TestResults_is_failed(&results[i], fail_pvalue)) {
+                intf->printf("  %s: p = %.3g, 1 - p = %.3g after %llu bytes\n",
+                    results[i].name, results[i].p, results[i].alpha, results[i].nbytes);
+                nfailed++;
+            }
+        }
+        nbytes_total += nbytes_stage;
+        intf->printf("===== Progressive mode: stage %u: %u failures, %llu bytes consumed =====\n",
+            stage + 1, nfailed, nbytes_stage);
+        if (nfailed > 0) {
+            failed_stage = stage + 1;
+        }
+        for (size_t i = 0; i < ntests; i++) {
+            free(scaled_opts[i]);
+            scaled_opts[i] = NULL;
+        }
+    }
+    printf("\nProgressive mode: ");
+    if (failed_stage != 0) {
+        printf("first failure at stage %u of %u (sample size 1/%llu), ",
+            failed_stage, nhalvings + 1, 1ull << (nhalvings + 1 - failed_stage));
+    } else {
+        printf("no failures at %u stages, ", nstages);
+    }
+    printf("%llu bytes consumed at all stages\n", nbytes_total);
+    free(tests);
+    free(scaled_opts);
+    free(skip);
+    return failed_stage;
+}
+
+
 /**
  * @brief Runs the given battery of the statistical test for the given
  * pseudorandom number generator.
@@ -1054,9 +3287,21 @@ BatteryExitCode TestsBattery_run(const TestsBattery *bat,
     printf("WARNING: multithreading is not supported on this platform\n");
     printf("They will be run sequentally\n");
 #else
-    const unsigned int nthreads = (opts->nthreads == 0) ? 1 : opts->nthreads;
+    unsigned int nthreads = (opts->nthreads == 0) ? 1 : opts->nthreads;
+    if (nthreads > NTHREADS_MAX) {
+        nthreads = NTHREADS_MAX;
+    }
 #endif
     printf("===== Starting '%s' battery =====\n", bat->name);
+    set_test_nsplits(opts->nsplits);
+    tests_mem_budget = get_tests_mem_budget(opts->mem_limit);
+    tests_nthreads = nthreads;
+    tests_pin_threads = opts->pin_threads;
+    tests_static_schedule = opts->static_schedule;
+    if (nthreads > 1 && tests_mem_budget != SIZE_MAX) {
+        printf("Memory budget for tests: %.1f MiB\n",
+            (double) tests_mem_budget / 1048576.0);
+    }
     if (testid == TEST_UNKNOWN) {
         if (opts->test.id != TESTS_ALL) {
             fprintf(stderr, "Invalid test id %u\n", opts->test.id);
@@ -1077,40 +3322,47 @@ BatteryExitCode TestsBattery_run(const TestsBattery *bat,
         fprintf(stderr, "***** TestsBattery_run: not enough memory *****\n");
         return BATTERY_ERROR;
     }
-    // Create a PRNG example: either for one-threaded version or for basic
-    // sanity check for multithreaded version.
+    // The entropy source must be initialized before running the tests:
+    // per-test seeds are taken from its substreams.
+    if (!Entropy_is_init(&entropy)) {
+        Entropy_init(&entropy);
+    }
+    // Create a PRNG example for a basic sanity check.
     GeneratorState obj = GeneratorState_create(gen, intf);
-    if (GeneratorState_check_size(&obj) == 0) {
-        GeneratorState_destruct(&obj);
+    const int is_size_ok = GeneratorState_check_size(&obj);
+    GeneratorState_destruct(&obj);
+    if (!is_size_ok) {
         free(results);
         fprintf(stderr, "***** TestsBattery_run: invalid generator output size *****\n");
         return BATTERY_ERROR;            
     }
+    // Select tests for the pipelined mode
+    int *is_pipelined = NULL;
+    if (opts->pipeline && testid == TESTS_ALL && opts->progressive == 0) {
+#ifdef NOTHREADS
+        printf("WARNING: pipelined mode is not supported on this platform\n");
+#else
+        is_pipelined = TestsBattery_select_pipelined(bat);
+#endif
+    }
     // Run the tests
     tic = time(NULL);
-    if (nthreads == 1 || testid != TESTS_ALL) {
-        // One-threaded version
-        if (testid == TESTS_ALL) {
-            for (size_t i = 0; i < ntests; i++) {
-                intf->printf("----- Test %u of %u (%s)\n",
-                    (unsigned int) (i + 1), (unsigned int) ntests, bat->tests[i].name);
-                results[i] = TestDescription_run(&bat->tests[i], &obj);
-                results[i].name = bat->tests[i].name;
-                results[i].id = (unsigned int) (i + 1);
-                results[i].thread_id = 0;
-            }
-        } else {
-            *results = TestDescription_run(&bat->tests[testid - 1], &obj);
-            results->name = bat->tests[testid - 1].name;
-            results->id = testid;
-        }
-        GeneratorState_destruct(&obj);
+    const double wall_tic = get_wall_time();
+    unsigned int failed_stage = 0;
+    if (opts->progressive > 0) {
+        const double fail_pvalue = (opts->fail_pvalue > 0.0) ?
+            opts->fail_pvalue : PVALUE_FAIL_DEFAULT;
+        failed_stage = TestsBattery_run_progressive(bat, gen, intf, nthreads,
+            testid, results, opts->progressive, fail_pvalue);
     } else {
-        // Multithreaded version
-        GeneratorState_destruct(&obj);
-        TestsBattery_run_threads(bat, gen, intf, opts, results);
+        if (is_pipelined != NULL) {
+            TestsBattery_run_pipeline(bat, gen, intf, nthreads, results, is_pipelined);
+        }
+        TestsBattery_run_tests(bat, gen, intf, nthreads, testid, results, is_pipelined);
     }
+    free(is_pipelined);
     toc = time(NULL);
+    const double wall_time = get_wall_time() - wall_tic;
     printf("\n");
     if (opts->report_type == REPORT_FULL) {
         printf("==================== Seeds logger report ====================\n");
@@ -1130,22 +3382,33 @@ BatteryExitCode TestsBattery_run(const TestsBattery *bat,
     }
     printf("Output size, bits: %d\n", (int) gen->nbits);
     printf("SmokeRand version: %s\n", SMOKERAND_VERSION_FULL);
+    // The results don't depend on the number of threads, so it is not
+    // embedded into the seed anymore: `_00_` means "any number of threads".
     char *seed_key_txt = Entropy_get_base64_key(&entropy);
     if (seed_key_txt != NULL) {
-        printf("Used seed:         _%.2X_%s\n\n", opts->nthreads, seed_key_txt);
+        printf("Used seed:         _00_%s\n\n", seed_key_txt);
     } else {
         printf("Used seed:         none\n\n");
     }
+    TestArenas_free_all(1);
     TestResultsSummary summary =
         TestResults_print_report(results, nresults, toc - tic, opts->report_type);
     if (seed_key_txt != NULL) {
-        printf("Used seed:     _%.2X_%s\n", opts->nthreads, seed_key_txt);
+        printf("Used seed:     _00_%s\n", seed_key_txt);
     } else {
         printf("Used seed:     none\n");
     }
+    const BatteryReport report = {.bat = bat, .gen = gen, .results = results,
+        .nresults = nresults, .summary = &summary, .seed_key_txt = seed_key_txt,
+        .nthreads = nthreads, .wall_time = wall_time};
+    const int is_saved = BatteryReport_save(&report, opts->report_format,
+        opts->report_file);
     free(seed_key_txt);
     free(results);
-    return (summary.nfailed == 0) ? BATTERY_PASSED : BATTERY_FAILED;
+    if (!is_saved) {
+        return BATTERY_ERROR;
+    }
+    return (summary.nfailed == 0 && failed_stage == 0) ? BATTERY_PASSED : BATTERY_FAILED;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -1222,6 +3485,10 @@ GeneratorInfo define_reversed_generator(const GeneratorInfo *gi)
         gi_env.get_bits = get_bits64_reversed;
     }
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
@@ -1251,6 +3518,10 @@ GeneratorInfo define_interleaved_generator(const GeneratorInfo *gi)
     gi_env.free = free_enveloped;
     gi_env.get_bits = get_bits32_interleaved;
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
@@ -1276,6 +3547,10 @@ GeneratorInfo define_high32_generator(const GeneratorInfo *gi)
     gi_env.free = free_enveloped;
     gi_env.get_bits = get_bits64_high32;
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
@@ -1301,6 +3576,10 @@ GeneratorInfo define_low32_generator(const GeneratorInfo *gi)
     gi_env.free = free_enveloped;
     gi_env.get_bits = get_bits64_low32;
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
@@ -1367,6 +3646,10 @@ GeneratorInfo define_uint31_generator(const GeneratorInfo *gi)
     gi_env.free = free_enveloped;
     gi_env.get_bits = get_bits64_uint31;
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
@@ -1397,6 +3680,10 @@ GeneratorInfo define_uint63_generator(const GeneratorInfo *gi)
     gi_env.free = free_enveloped;
     gi_env.get_bits = get_bits64_uint63;
     gi_env.get_sum = NULL;
+    gi_env.fill = NULL;
+    gi_env.jump = NULL;
+    gi_env.seek = NULL;
+    gi_env.discard = NULL;
     return gi_env;
 }
 
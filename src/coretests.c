@@ -12,6 +12,9 @@
  */
 #include "smokerand/coretests.h"
 #include "smokerand/specfuncs.h"
+#ifdef __AVX2__
+    #include "smokerand/x86exts.h"
+#endif
 #include <math.h>
 #include <float.h>
 #include <limits.h>
@@ -26,76 +29,145 @@
 
 
 /**
- * @brief Make non-overlapping 64-bit tuples (points in n-dimensional space)
- * for birthday spacings test. It may use either higher or lower bits.
+ * @brief Layout of tuples (points in n-dimensional space) for birthday
+ * spacings and CollisionOver tests: each value of the generator output
+ * is converted to the tuple digit as `(x >> shr) & mask`.
  */
-static inline void bspace_make_tuples64(const BSpaceNDOptions *opts,
-    const GeneratorInfo *gi, void *state, uint64_t *u, size_t len)
+typedef struct {
+    unsigned int ndims; ///< Number of dimensions.
+    unsigned int nbits_per_dim; ///< Number of bits per dimension.
+    unsigned int shr; ///< Right shift of the generator output.
+    uint64_t mask; ///< Mask for the shifted generator output.
+} TuplesLayout;
+
+/**
+ * @brief Creates the tuples layout that uses either higher or lower bits
+ * of the generator output.
+ */
+static TuplesLayout TuplesLayout_create(unsigned int ndims,
+    unsigned int nbits_per_dim, int get_lower, unsigned int gen_nbits)
 {
-    if (opts->get_lower) {
+    TuplesLayout obj;
+    obj.ndims = ndims;
+    obj.nbits_per_dim = nbits_per_dim;
+    if (get_lower) {
         // Take lower bits
-        uint64_t mask;
-        if (opts->nbits_per_dim == 64) {
-            mask = 0xFFFFFFFFFFFFFFFF;
-        } else {
-            mask = (1ull << opts->nbits_per_dim) - 1ull;
-        }
-        for (size_t j = 0; j < len; j++) {
-            u[j] = 0;
-            for (size_t k = 0; k < opts->ndims; k++) {
-                u[j] <<= opts->nbits_per_dim;
-                u[j] |= gi->get_bits(state) & mask;
-            }
-        }
+        obj.shr = 0;
+        obj.mask = (nbits_per_dim == 64) ?
+            0xFFFFFFFFFFFFFFFF : ((1ull << nbits_per_dim) - 1ull);
     } else {
         // Take higher bits
-        unsigned int shl = gi->nbits - opts->nbits_per_dim;
-        for (size_t j = 0; j < len; j++) {
-            u[j] = 0;
-            for (size_t k = 0; k < opts->ndims; k++) {
-                u[j] <<= opts->nbits_per_dim;
-                u[j] |= gi->get_bits(state) >> shl;
-            }
-        }
+        obj.shr = gen_nbits - nbits_per_dim;
+        obj.mask = 0xFFFFFFFFFFFFFFFF;
     }
+    return obj;
 }
 
+/**
+ * @brief Number of generator outputs processed by tuples making kernels
+ * at once.
+ */
+#define TUPLES_CHUNK_LEN 4096
 
 /**
- * @brief Make non-overlapping 32-bit tuples (points in n-dimensional space)
- * for birthday spacings test. It may use either higher or lower bits.
+ * @brief Template for kernels that make non-overlapping tuples for the
+ * birthday spacings test from the array of generator outputs. The number
+ * of dimensions and bits per dimension are compile-time constants, so
+ * the inner loop is fully unrolled.
  */
-static inline void bspace_make_tuples32(const BSpaceNDOptions *opts,
-    const GeneratorInfo *gi, void *state, uint32_t *u, size_t len)
-{
-    if (opts->get_lower) {
-        // Take lower bits
-        uint64_t mask;
-        if (opts->nbits_per_dim == 32) {
-            mask = 0xFFFFFFFF;
-        } else {
-            mask = (1ull << opts->nbits_per_dim) - 1ull;
-        }
-        for (size_t j = 0; j < len; j++) {
-            u[j] = 0;
-            for (size_t k = 0; k < opts->ndims; k++) {
-                u[j] <<= opts->nbits_per_dim;
-                u[j] |= (uint32_t) (gi->get_bits(state) & mask);
-            }
-        }
-    } else {
-        // Take higher bits
-        unsigned int shl = gi->nbits - opts->nbits_per_dim;
-        for (size_t j = 0; j < len; j++) {
-            u[j] = 0;
-            for (size_t k = 0; k < opts->ndims; k++) {
-                u[j] <<= opts->nbits_per_dim;
-                u[j] |= (uint32_t) (gi->get_bits(state) >> shl);
-            }
-        }
-    }
+#define BSPACE_MAKE_TUPLES_FUNC_TPL(suffix, type, ndims, nbits) \
+static void bspace_make_tuples##suffix##_##ndims##x##nbits(type *u, \
+    const uint64_t *x, size_t len, const TuplesLayout *tl) \
+{ \
+    const unsigned int shr = tl->shr; \
+    const uint64_t mask = tl->mask; \
+    for (size_t j = 0; j < len; j++) { \
+        const uint64_t *xj = x + j * ndims; \
+        uint64_t t = (xj[0] >> shr) & mask; \
+        for (size_t k = 1; k < ndims; k++) { \
+            t = (t << nbits) | ((xj[k] >> shr) & mask); \
+        } \
+        u[j] = (type) t; \
+    } \
+}
+
+/**
+ * @brief Template for generic kernels that make non-overlapping tuples
+ * for the birthday spacings test (for any number of dimensions).
+ */
+#define BSPACE_MAKE_TUPLES_GENERIC_FUNC_TPL(suffix, type) \
+static void bspace_make_tuples##suffix##_generic(type *u, \
+    const uint64_t *x, size_t len, const TuplesLayout *tl) \
+{ \
+    const size_t ndims = tl->ndims; \
+    for (size_t j = 0; j < len; j++) { \
+        const uint64_t *xj = x + j * ndims; \
+        uint64_t t = (xj[0] >> tl->shr) & tl->mask; \
+        for (size_t k = 1; k < ndims; k++) { \
+            t = (t << tl->nbits_per_dim) | ((xj[k] >> tl->shr) & tl->mask); \
+        } \
+        u[j] = (type) t; \
+    } \
 }
 
+BSPACE_MAKE_TUPLES_FUNC_TPL(32, uint32_t, 1, 32)
+BSPACE_MAKE_TUPLES_FUNC_TPL(64, uint64_t, 2, 32)
+BSPACE_MAKE_TUPLES_FUNC_TPL(64, uint64_t, 3, 21)
+BSPACE_MAKE_TUPLES_FUNC_TPL(64, uint64_t, 4, 16)
+BSPACE_MAKE_TUPLES_FUNC_TPL(64, uint64_t, 8, 8)
+BSPACE_MAKE_TUPLES_FUNC_TPL(64, uint64_t, 16, 4)
+BSPACE_MAKE_TUPLES_GENERIC_FUNC_TPL(32, uint32_t)
+BSPACE_MAKE_TUPLES_GENERIC_FUNC_TPL(64, uint64_t)
+
+/**
+ * @brief Template for the dispatch table entry and the function that
+ * makes non-overlapping tuples for the birthday spacings test. The kernel
+ * is selected from the table of specialized kernels for the configurations
+ * used in the batteries; other configurations (including 1-dimensional
+ * 64-bit tuples that require no shifts) are processed by the generic kernel.
+ */
+#define BSPACE_MAKE_TUPLES_DISPATCH_TPL(suffix, type, ...) \
+typedef struct { \
+    unsigned int ndims; \
+    unsigned int nbits_per_dim; \
+    void (*make_tuples)(type *u, const uint64_t *x, size_t len, const TuplesLayout *tl); \
+} BSpaceTuplesKernel##suffix; \
+\
+static const BSpaceTuplesKernel##suffix bspace_tuples_kernels##suffix[] = { \
+    __VA_ARGS__, \
+    {0, 0, bspace_make_tuples##suffix##_generic} \
+}; \
+\
+static void bspace_make_tuples##suffix(const BSpaceNDOptions *opts, \
+    GeneratorState *obj, type *u, size_t len) \
+{ \
+    uint64_t x[TUPLES_CHUNK_LEN]; \
+    const TuplesLayout tl = TuplesLayout_create(opts->ndims, \
+        opts->nbits_per_dim, opts->get_lower, obj->gi->nbits); \
+    const BSpaceTuplesKernel##suffix *kernel = bspace_tuples_kernels##suffix; \
+    while (kernel->ndims != 0 && (kernel->ndims != tl.ndims || \
+        kernel->nbits_per_dim != tl.nbits_per_dim)) { \
+        kernel++; \
+    } \
+    const size_t chunk_len = TUPLES_CHUNK_LEN / tl.ndims; \
+    for (size_t j = 0; j < len; j += chunk_len) { \
+        const size_t ntuples = (len - j < chunk_len) ? (len - j) : chunk_len; \
+        GeneratorState_get_array(obj, x, ntuples * tl.ndims); \
+        kernel->make_tuples(u + j, x, ntuples, &tl); \
+    } \
+}
+
+BSPACE_MAKE_TUPLES_DISPATCH_TPL(32, uint32_t,
+    {1, 32, bspace_make_tuples32_1x32})
+
+BSPACE_MAKE_TUPLES_DISPATCH_TPL(64, uint64_t,
+    {2, 32, bspace_make_tuples64_2x32},
+    {3, 21, bspace_make_tuples64_3x21},
+    {4, 16, bspace_make_tuples64_4x16},
+    {8, 8,  bspace_make_tuples64_8x8},
+    {16, 4, bspace_make_tuples64_16x4})
+
+
 #define BSPACE_GET_NDUPS_FUNC_TPL(suffix, type) \
 static unsigned int bspace_get_ndups##suffix(type *x, size_t len) \
 { \
@@ -112,9 +184,97 @@ static unsigned int bspace_get_ndups##suffix(type *x, size_t len) \
     return ndups; \
 }
 
-BSPACE_GET_NDUPS_FUNC_TPL(32, uint32_t)
 BSPACE_GET_NDUPS_FUNC_TPL(64, uint64_t)
 
+/**
+ * @brief Maximal number of points in one batch of samples of the 32-bit
+ * birthday spacings test. Samples of the batch are generated into one
+ * contiguous buffer (1 MiB).
+ */
+#define BSPACE32_BATCH_LEN (1ul << 18)
+
+/**
+ * @brief LSD radix sort for small 32-bit arrays. Histograms for all digits
+ * are computed in one pass; passes with identical digits for all elements
+ * (e.g. higher bits of 24-bit tuples) are skipped.
+ * @param x    Sorted array.
+ * @param tmp  Scratch buffer, must have at least `len` elements.
+ * @param len  Number of elements.
+ * @param h    Buffer for histograms.
+ */
+void bspace32_sort_small(uint32_t *x, uint32_t *tmp, size_t len,
+    BSpace32SortHist *h)
+{
+    static const unsigned int shr[3] = {0, 11, 22};
+    memset(h, 0, sizeof(BSpace32SortHist));
+    for (size_t i = 0; i < len; i++) {
+        const uint32_t v = x[i];
+        h->counts[0][v & 0x7FF]++;
+        h->counts[1][(v >> 11) & 0x7FF]++;
+        h->counts[2][v >> 22]++;
+    }
+    uint32_t *src = x, *dst = tmp;
+    for (int k = 0; k < 3; k++) {
+        uint32_t *c = h->counts[k];
+        if (c[(src[0] >> shr[k]) & 0x7FF] == len) {
+            continue;
+        }
+        uint32_t sum = 0;
+        for (size_t j = 0; j < 2048; j++) {
+            const uint32_t cj = c[j];
+            c[j] = sum;
+            sum += cj;
+        }
+        for (size_t i = 0; i < len; i++) {
+            const uint32_t v = src[i];
+            dst[c[(v >> shr[k]) & 0x7FF]++] = v;
+        }
+        uint32_t *swp = src; src = dst; dst = swp;
+    }
+    if (src != x) {
+        memcpy(x, src, len * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Returns number of duplicates in spacings for a small sample
+ * of 32-bit points. The sample is destroyed.
+ * @param x    Sample (points).
+ * @param tmp  Scratch buffer, must have at least `len` elements.
+ * @param len  Number of points in the sample.
+ * @param h    Buffer for histograms.
+ */
+static unsigned int bspace32_get_ndups_small(uint32_t *x, uint32_t *tmp,
+    size_t len, BSpace32SortHist *h)
+{
+    unsigned int ndups = 0;
+    bspace32_sort_small(x, tmp, len, h);
+    for (size_t i = 0; i < len - 1; i++) {
+        x[i] = x[i + 1] - x[i];
+    }
+    bspace32_sort_small(x, tmp, len - 1, h);
+    for (size_t i = 0; i < len - 2; i++) {
+        ndups += (x[i] == x[i + 1]);
+    }
+    return ndups;
+}
+
+/**
+ * @brief Returns the number of samples in one batch of the 32-bit
+ * birthday spacings test.
+ */
+static size_t bspace32_get_batch_nsamples(size_t len, unsigned long nsamples)
+{
+    size_t batch_nsamples = BSPACE32_BATCH_LEN / len;
+    if (batch_nsamples == 0) {
+        batch_nsamples = 1;
+    }
+    if (batch_nsamples > nsamples) {
+        batch_nsamples = nsamples;
+    }
+    return batch_nsamples;
+}
+
 
 static unsigned long bspace_calc_len(unsigned int nbits_total)
 {
@@ -128,26 +288,34 @@ static double bspace_calc_lambda(size_t len, unsigned int nbits_total)
 
 /**
  * @brief 32-bit version of n-dimensional birthday spacings test.
+ * @details Samples are small (up to 4096 points), so they are processed
+ * by batches: points of many samples are generated into one contiguous
+ * buffer, then each sample is sorted by the cache-resident radix sort.
  * @return Number of duplicates.
  */
 static unsigned long bspace32_nd_test(GeneratorState *obj, const BSpaceNDOptions *opts)
 {
     const unsigned int nbits_total = opts->ndims * opts->nbits_per_dim;
     const size_t len = bspace_calc_len(nbits_total);
-    uint32_t *u = calloc(len, sizeof(uint32_t));
+    const size_t batch_nsamples = bspace32_get_batch_nsamples(len, opts->nsamples);
+    uint32_t *u = TestArena_calloc(obj->arena, batch_nsamples * len, sizeof(uint32_t));
     ASSERT_MALLOC_PTR(u, "bspace32_nd_test")
-    unsigned long *ndups = calloc(opts->nsamples, sizeof(unsigned long));
-    ASSERT_MALLOC_PTR(ndups, "bspace32_nd_test")
-    for (size_t i = 0; i < opts->nsamples; i++) {
-        bspace_make_tuples32(opts, obj->gi, obj->state, u, len);
-            ndups[i] = bspace_get_ndups32(u, len);
-    }
+    uint32_t *tmp = TestArena_calloc(obj->arena, len, sizeof(uint32_t));
+    ASSERT_MALLOC_PTR(tmp, "bspace32_nd_test")
+    BSpace32SortHist *hist = malloc(sizeof(BSpace32SortHist));
+    ASSERT_MALLOC_PTR(hist, "bspace32_nd_test")
     unsigned long ndups_total = 0;
-    for (size_t i = 0; i < opts->nsamples; i++) {
-        ndups_total += ndups[i];
+    for (size_t i = 0; i < opts->nsamples; i += batch_nsamples) {
+        const size_t nsamples = (opts->nsamples - i < batch_nsamples) ?
+            (opts->nsamples - i) : batch_nsamples;
+        bspace_make_tuples32(opts, obj, u, nsamples * len);
+        for (size_t j = 0; j < nsamples; j++) {
+            ndups_total += bspace32_get_ndups_small(u + j * len, tmp, len, hist);
+        }
     }
-    free(u);
-    free(ndups);
+    free(hist);
+    TestArena_free(obj->arena, tmp);
+    TestArena_free(obj->arena, u);
     return ndups_total;
 }
 
@@ -159,19 +327,19 @@ static unsigned long bspace64_nd_test(GeneratorState *obj, const BSpaceNDOptions
 {
     const unsigned int nbits_total = opts->ndims * opts->nbits_per_dim;
     const size_t len = bspace_calc_len(nbits_total);
-    uint64_t *u = calloc(len, sizeof(uint64_t));
+    uint64_t *u = TestArena_calloc(obj->arena, len, sizeof(uint64_t));
     ASSERT_MALLOC_PTR(u, "bspace64_nd_test")
     unsigned long *ndups = calloc(opts->nsamples, sizeof(unsigned long));
     ASSERT_MALLOC_PTR(ndups, "bspace64_nd_test")
     for (size_t i = 0; i < opts->nsamples; i++) {
-        bspace_make_tuples64(opts, obj->gi, obj->state, u, len);
+        bspace_make_tuples64(opts, obj, u, len);
             ndups[i] = bspace_get_ndups64(u, len);
     }
     unsigned long ndups_total = 0;
     for (size_t i = 0; i < opts->nsamples; i++) {
         ndups_total += ndups[i];
     }
-    free(u);
+    TestArena_free(obj->arena, u);
     free(ndups);
     return ndups_total;
 }
@@ -261,7 +429,13 @@ TestResults bspace_nd_test(GeneratorState *obj, const BSpaceNDOptions *opts)
 static void bspace4_8d_decimated_pvalue(TestResults *ans, const char *name,
     uint32_t *u, size_t len, double lambda, const CallerAPI *intf)
 {
-    const double x = (double) bspace_get_ndups32(u, len);
+    uint32_t *tmp = calloc(len, sizeof(uint32_t));
+    ASSERT_MALLOC_PTR(tmp, "bspace4_8d_decimated_pvalue")
+    BSpace32SortHist *hist = malloc(sizeof(BSpace32SortHist));
+    ASSERT_MALLOC_PTR(hist, "bspace4_8d_decimated_pvalue")
+    const double x = (double) bspace32_get_ndups_small(u, tmp, len, hist);
+    free(tmp);
+    free(hist);
     const double p = sr_poisson_pvalue(x, lambda);
     const double alpha = sr_poisson_cdf(x, lambda);
     intf->printf("  %-30s x = %6.0f; p = %g\n", name, x, p);
@@ -340,7 +514,7 @@ TestResults bspace4_8d_decimated_test(GeneratorState *obj, unsigned long step)
 
     for (size_t i = 0; i < len; i++) {
         for (int j = 0; j < 8; j++) {
-            const uint64_t x = obj->gi->get_bits(obj->state);
+            const uint64_t x = GeneratorState_get_bits(obj);
             const uint32_t x_hi4 = (uint32_t) (x >> (obj->gi->nbits - 4));
             // Take lower 4 bits
             u[i] <<= 4;
@@ -352,9 +526,7 @@ TestResults bspace4_8d_decimated_test(GeneratorState *obj, unsigned long step)
             u_high_norev[i] <<= 4;
             u_high_norev[i] |= x_hi4;
             // Decimation
-            for (unsigned long k = 0; k < step - 1; k++) {
-                (void) obj->gi->get_bits(obj->state);
-            }
+            GeneratorState_discard(obj, step - 1);
         }
     }
     ans.penalty = PENALTY_BSPACE_DEC;
@@ -378,49 +550,313 @@ TestResults bspace4_8d_decimated_test(GeneratorState *obj, unsigned long step)
 ///// CollisionOver test implementation /////
 /////////////////////////////////////////////
 
+/**
+ * @brief Template for kernels that make overlapping tuples for the
+ * CollisionOver test from the array of generator outputs. The number
+ * of dimensions and bits per dimension are compile-time constants.
+ */
+#define COLLOVER_MAKE_TUPLES_FUNC_TPL(ndims, nbits) \
+static uint64_t collisionover_make_tuples_##ndims##x##nbits(uint64_t *u, \
+    const uint64_t *x, size_t len, uint64_t cur_tuple, const TuplesLayout *tl) \
+{ \
+    const unsigned int shr = tl->shr; \
+    const uint64_t mask = tl->mask; \
+    for (size_t i = 0; i < len; i++) { \
+        cur_tuple >>= nbits; \
+        cur_tuple |= ((x[i] >> shr) & mask) << ((ndims - 1) * nbits); \
+        u[i] = cur_tuple; \
+    } \
+    return cur_tuple; \
+}
+
+COLLOVER_MAKE_TUPLES_FUNC_TPL(2, 20)
+COLLOVER_MAKE_TUPLES_FUNC_TPL(3, 13)
+COLLOVER_MAKE_TUPLES_FUNC_TPL(5, 8)
+COLLOVER_MAKE_TUPLES_FUNC_TPL(8, 5)
+COLLOVER_MAKE_TUPLES_FUNC_TPL(13, 3)
+COLLOVER_MAKE_TUPLES_FUNC_TPL(20, 2)
+
+/**
+ * @brief Generic kernel that makes overlapping tuples for the
+ * CollisionOver test (for any number of dimensions).
+ */
+static uint64_t collisionover_make_tuples_generic(uint64_t *u,
+    const uint64_t *x, size_t len, uint64_t cur_tuple, const TuplesLayout *tl)
+{
+    const unsigned int rshift = (tl->ndims - 1) * tl->nbits_per_dim;
+    for (size_t i = 0; i < len; i++) {
+        cur_tuple >>= tl->nbits_per_dim;
+        cur_tuple |= ((x[i] >> tl->shr) & tl->mask) << rshift;
+        u[i] = cur_tuple;
+    }
+    return cur_tuple;
+}
+
+/**
+ * @brief Dispatch table entry for the CollisionOver tuples making kernels.
+ */
+typedef struct {
+    unsigned int ndims;
+    unsigned int nbits_per_dim;
+    uint64_t (*make_tuples)(uint64_t *u, const uint64_t *x, size_t len,
+        uint64_t cur_tuple, const TuplesLayout *tl);
+} CollOverTuplesKernel;
+
+/**
+ * @brief Specialized kernels for configurations used in the batteries,
+ * the last entry is the generic kernel for all other configurations.
+ */
+static const CollOverTuplesKernel collover_tuples_kernels[] = {
+    {2, 20, collisionover_make_tuples_2x20},
+    {3, 13, collisionover_make_tuples_3x13},
+    {5, 8,  collisionover_make_tuples_5x8},
+    {8, 5,  collisionover_make_tuples_8x5},
+    {13, 3, collisionover_make_tuples_13x3},
+    {20, 2, collisionover_make_tuples_20x2},
+    {0, 0,  collisionover_make_tuples_generic}
+};
+
 /**
  * @brief Make overlapping tuples (points in n-dimensional space) for
  * collisionover test. It may use either higher or lower bits.
+ * @details The function may be called several times for subsequent
+ * chunks of the sample: the current tuple is kept in `cur_tuple` that
+ * must be initialized by `collisionover_init_tuple`.
  */
-static inline void collisionover_make_tuples(const CollOverNDOptions *opts,
-    const GeneratorInfo *gi, void *state, uint64_t *u, size_t len)
+static void collisionover_make_tuples(const CollOverNDOptions *opts,
+    GeneratorState *obj, uint64_t *u, size_t len, uint64_t *cur_tuple_ptr)
 {
-    uint64_t cur_tuple = 0;
-    const unsigned int rshift = (opts->ndims - 1) * opts->nbits_per_dim;
-    if (opts->get_lower) {
-        // Take lower bits
-        uint64_t mask;
-        if (opts->nbits_per_dim == 64) {
-            mask = 0xFFFFFFFFFFFFFFFF;
+    uint64_t x[TUPLES_CHUNK_LEN];
+    const TuplesLayout tl = TuplesLayout_create(opts->ndims,
+        opts->nbits_per_dim, opts->get_lower, obj->gi->nbits);
+    const CollOverTuplesKernel *kernel = collover_tuples_kernels;
+    while (kernel->ndims != 0 && (kernel->ndims != tl.ndims ||
+        kernel->nbits_per_dim != tl.nbits_per_dim)) {
+        kernel++;
+    }
+    uint64_t cur_tuple = *cur_tuple_ptr;
+    for (size_t i = 0; i < len; i += TUPLES_CHUNK_LEN) {
+        const size_t chunk_len = (len - i < TUPLES_CHUNK_LEN) ? (len - i) : TUPLES_CHUNK_LEN;
+        GeneratorState_get_array(obj, x, chunk_len);
+        cur_tuple = kernel->make_tuples(u + i, x, chunk_len, cur_tuple, &tl);
+    }
+    *cur_tuple_ptr = cur_tuple;
+}
+
+/**
+ * @brief Initializes the first tuple for `collisionover_make_tuples`.
+ */
+static inline uint64_t collisionover_init_tuple(const CollOverNDOptions *opts,
+    GeneratorState *obj)
+{
+    uint64_t u[8], cur_tuple = 0;
+    collisionover_make_tuples(opts, obj, u, 8, &cur_tuple);
+    return cur_tuple;
+}
+
+
+enum {
+    COLLOVER_STREAM_MAX_NBITS = 40, ///< Maximal tuple size for the streaming counter
+    COLLOVER_NPART_BITS = 8, ///< Number of bits used for partitioning
+    COLLOVER_BLOCK_LEN = 4096, ///< Number of keys in one block of partition
+    COLLOVER_CHUNK_LEN = 4096 ///< Number of tuples generated at once
+};
+
+#define COLLOVER_BLOCK_NONE UINT32_MAX
+
+/**
+ * @brief Streaming counter of cells occupancy for the CollisionOver test.
+ * @details Used instead of sorting for tuples with not more than 40 bits.
+ * Tuples are scattered into \f$ 2^8 \f$ partitions by their higher bits, only
+ * lower (not more than 32) bits are stored. Each partition is a linked list
+ * of fixed size blocks from the common pool, so the memory consumption
+ * is about 4 bytes per tuple instead of 8. Then the partitions are
+ * processed one by one by means of a small open addressing hash table
+ * that is usually kept in CPU cache: it counts how many tuples hit each
+ * cell of the partition.
+ */
+typedef struct {
+    uint32_t *pool; ///< Pool of blocks with the stored keys
+    uint32_t *next; ///< Next block in the partition (or COLLOVER_BLOCK_NONE)
+    size_t nblocks_max; ///< Pool size (in blocks)
+    size_t nblocks_used; ///< Number of used blocks
+    uint32_t *first; ///< First block of each partition
+    uint32_t *last; ///< Last block of each partition
+    size_t *count; ///< Number of keys in each partition
+    size_t npart; ///< Number of partitions
+    unsigned int key_nbits; ///< Number of bits in the stored key
+    uint32_t *ht_keys; ///< Hash table: keys
+    uint8_t *ht_freq; ///< Hash table: saturated frequencies (0 - empty cell)
+    unsigned int ht_log2cap; ///< Hash table: log2 of capacity
+    size_t ht_nkeys; ///< Hash table: number of occupied cells
+    TestArena *arena; ///< Arena for the blocks pool
+} CollOverCounter;
+
+
+static void CollOverCounter_alloc_ht(CollOverCounter *obj, unsigned int log2cap)
+{
+    const size_t cap = (size_t) 1 << log2cap;
+    obj->ht_keys = malloc(cap * sizeof(uint32_t));
+    obj->ht_freq = calloc(cap, sizeof(uint8_t));
+    ASSERT_MALLOC_PTR(obj->ht_keys, "CollOverCounter_alloc_ht")
+    ASSERT_MALLOC_PTR(obj->ht_freq, "CollOverCounter_alloc_ht")
+    obj->ht_log2cap = log2cap;
+    obj->ht_nkeys = 0;
+}
+
+
+static void CollOverCounter_init(CollOverCounter *obj, unsigned int nbits, size_t n,
+    TestArena *arena)
+{
+    const unsigned int npart_bits = (nbits < COLLOVER_NPART_BITS) ? nbits : COLLOVER_NPART_BITS;
+    obj->npart = (size_t) 1 << npart_bits;
+    obj->key_nbits = nbits - npart_bits;
+    obj->nblocks_max = n / COLLOVER_BLOCK_LEN + obj->npart + 1;
+    obj->nblocks_used = 0;
+    obj->arena = arena;
+    obj->pool = TestArena_calloc(arena, obj->nblocks_max * COLLOVER_BLOCK_LEN, sizeof(uint32_t));
+    obj->next = TestArena_calloc(arena, obj->nblocks_max, sizeof(uint32_t));
+    obj->first = malloc(obj->npart * sizeof(uint32_t));
+    obj->last = malloc(obj->npart * sizeof(uint32_t));
+    obj->count = calloc(obj->npart, sizeof(size_t));
+    ASSERT_MALLOC_PTR(obj->pool, "CollOverCounter_init")
+    ASSERT_MALLOC_PTR(obj->next, "CollOverCounter_init")
+    ASSERT_MALLOC_PTR(obj->first, "CollOverCounter_init")
+    ASSERT_MALLOC_PTR(obj->last, "CollOverCounter_init")
+    ASSERT_MALLOC_PTR(obj->count, "CollOverCounter_init")
+    // Hash table is sized for the doubled average partition size
+    unsigned int log2cap = 4;
+    while (((size_t) 1 << log2cap) < 2 * (n / obj->npart) && log2cap < 32) {
+        log2cap++;
+    }
+    CollOverCounter_alloc_ht(obj, log2cap);
+}
+
+
+static void CollOverCounter_destruct(CollOverCounter *obj)
+{
+    TestArena_free(obj->arena, obj->pool);
+    TestArena_free(obj->arena, obj->next);
+    free(obj->first);
+    free(obj->last);
+    free(obj->count);
+    free(obj->ht_keys);
+    free(obj->ht_freq);
+}
+
+/**
+ * @brief Adds the tuple to the corresponding partition.
+ */
+static inline void CollOverCounter_add(CollOverCounter *obj, uint64_t tuple)
+{
+    const size_t part = (size_t) (tuple >> obj->key_nbits);
+    const uint32_t key = (uint32_t) (tuple & ((1ull << obj->key_nbits) - 1ull));
+    const size_t pos = obj->count[part] % COLLOVER_BLOCK_LEN;
+    if (pos == 0) {
+        // Append a new block to the partition
+        const uint32_t block = (uint32_t) obj->nblocks_used++;
+        obj->next[block] = COLLOVER_BLOCK_NONE;
+        if (obj->count[part] == 0) {
+            obj->first[part] = block;
         } else {
-            mask = (1ull << opts->nbits_per_dim) - 1ull;
+            obj->next[obj->last[part]] = block;
         }
-        // Initialize the first tuple
-        for (int j = 0; j < 8; j++) {
-            cur_tuple >>= opts->nbits_per_dim;
-            cur_tuple |= (gi->get_bits(state) & mask) << rshift;
+        obj->last[part] = block;
+    }
+    obj->pool[(size_t) obj->last[part] * COLLOVER_BLOCK_LEN + pos] = key;
+    obj->count[part]++;
+}
+
+
+static inline size_t CollOverCounter_ht_index(const CollOverCounter *obj, uint32_t key)
+{
+    return (size_t) ((key * 0x9E3779B97F4A7C15ull) >> (64 - obj->ht_log2cap));
+}
+
+/**
+ * @brief Doubles the hash table capacity.
+ */
+static void CollOverCounter_ht_grow(CollOverCounter *obj)
+{
+    const size_t cap = (size_t) 1 << obj->ht_log2cap;
+    uint32_t *keys = obj->ht_keys;
+    uint8_t *freq = obj->ht_freq;
+    CollOverCounter_alloc_ht(obj, obj->ht_log2cap + 1);
+    const size_t mask = ((size_t) 1 << obj->ht_log2cap) - 1;
+    for (size_t i = 0; i < cap; i++) {
+        if (freq[i] != 0) {
+            size_t j = CollOverCounter_ht_index(obj, keys[i]);
+            while (obj->ht_freq[j] != 0) {
+                j = (j + 1) & mask;
+            }
+            obj->ht_keys[j] = keys[i];
+            obj->ht_freq[j] = freq[i];
+            obj->ht_nkeys++;
         }
-        // Generate other tuples
-        for (size_t i = 0; i < len; i++) {
-            cur_tuple >>= opts->nbits_per_dim;
-            cur_tuple |= (gi->get_bits(state) & mask) << rshift;
-            u[i] = cur_tuple;
+    }
+    free(keys);
+    free(freq);
+}
+
+/**
+ * @brief Inserts the key into the hash table or increases its frequency
+ * (saturated at 3). The load factor of the table is kept below 1/2.
+ */
+static inline void CollOverCounter_ht_insert(CollOverCounter *obj, uint32_t key)
+{
+    const size_t mask = ((size_t) 1 << obj->ht_log2cap) - 1;
+    size_t i = CollOverCounter_ht_index(obj, key);
+    while (obj->ht_freq[i] != 0) {
+        if (obj->ht_keys[i] == key) {
+            if (obj->ht_freq[i] < 3) {
+                obj->ht_freq[i]++;
+            }
+            return;
         }
-    } else {
-        // Take higher bits
-        unsigned int shr = gi->nbits - opts->nbits_per_dim;
-        // Initialize the first tuple
-        for (int j = 0; j < 8; j++) {
-            cur_tuple >>= opts->nbits_per_dim;
-            cur_tuple |= (gi->get_bits(state) >> shr) << rshift;
+        i = (i + 1) & mask;
+    }
+    if (2 * (obj->ht_nkeys + 1) > mask + 1) {
+        CollOverCounter_ht_grow(obj);
+        CollOverCounter_ht_insert(obj, key);
+        return;
+    }
+    obj->ht_keys[i] = key;
+    obj->ht_freq[i] = 1;
+    obj->ht_nkeys++;
+}
+
+/**
+ * @brief Counts cells occupancy in all partitions and updates the
+ * frequency table: `Oi[0]` is decreased by the number of occupied cells,
+ * `Oi[1]`, `Oi[2]` and `Oi[3]` are increased by the numbers of cells with
+ * one, two and three or more tuples. Resets the partitions.
+ */
+static void CollOverCounter_count(CollOverCounter *obj, uint64_t *Oi)
+{
+    for (size_t part = 0; part < obj->npart; part++) {
+        size_t nleft = obj->count[part];
+        if (nleft == 0) {
+            continue;
         }
-        // Generate other tuples
-        for (size_t i = 0; i < len; i++) {
-            cur_tuple >>= opts->nbits_per_dim;
-            cur_tuple |= (gi->get_bits(state) >> shr) << rshift;
-            u[i] = cur_tuple;
+        for (uint32_t b = obj->first[part]; b != COLLOVER_BLOCK_NONE; b = obj->next[b]) {
+            const uint32_t *keys = obj->pool + (size_t) b * COLLOVER_BLOCK_LEN;
+            const size_t len = (nleft < COLLOVER_BLOCK_LEN) ? nleft : COLLOVER_BLOCK_LEN;
+            for (size_t i = 0; i < len; i++) {
+                CollOverCounter_ht_insert(obj, keys[i]);
+            }
+            nleft -= len;
+        }
+        // Frequencies for the partition
+        const size_t cap = (size_t) 1 << obj->ht_log2cap;
+        for (size_t i = 0; i < cap; i++) {
+            Oi[obj->ht_freq[i]]++;
         }
+        Oi[0] -= cap; // Empty cells were counted in the previous loop
+        memset(obj->ht_freq, 0, cap);
+        obj->ht_nkeys = 0;
+        obj->count[part] = 0;
     }
+    obj->nblocks_used = 0;
 }
 
 
@@ -445,13 +881,17 @@ static inline void collisionover_make_tuples(const CollOverNDOptions *opts,
  * only when \f$ n \ll d^t \f$.
  *
  * The formula are taken from the TestU01 user manual.
+ *
+ * Tuples with not more than 40 bits are processed by the streaming
+ * counter (see `CollOverCounter`) that doesn't store the whole tuples and
+ * doesn't sort them. Larger tuples are stored and sorted.
  */
 TestResults collisionover_test(GeneratorState *obj, const CollOverNDOptions *opts)
 {
     const size_t n = opts->n;
-    uint64_t *u = calloc(n, sizeof(uint64_t));
-    ASSERT_MALLOC_PTR(u, "collisionover_test")
-    const uint64_t nstates_u64 = 1ull << opts->ndims * opts->nbits_per_dim;
+    const unsigned int nbits = opts->ndims * opts->nbits_per_dim;
+    const int use_counter = nbits <= COLLOVER_STREAM_MAX_NBITS;
+    const uint64_t nstates_u64 = 1ull << nbits;
     uint64_t Oi[4] = {0, 0, 0, 0};
     Oi[0] = nstates_u64;
     const double nstates = (double) nstates_u64;
@@ -464,23 +904,51 @@ TestResults collisionover_test(GeneratorState *obj, const CollOverNDOptions *opt
         opts->ndims, opts->nbits_per_dim, opts->n, opts->get_lower);
     obj->intf->printf("  nsamples = %lu; len = %lu, mu = %g * %d\n",
         opts->nsamples, n, mu, (int) opts->nsamples);
+    obj->intf->printf("  Collisions search: %s\n",
+        use_counter ? "partitioned hash table" : "sorting");
 
     ans.penalty = PENALTY_COLLOVER;
     ans.x = 0;
-    for (unsigned long i = 0; i < opts->nsamples; i++) {
-        collisionover_make_tuples(opts, obj->gi, obj->state, u, n);
+    if (use_counter) {
+        // Find collisions by streaming counter: tuples are not stored
+        CollOverCounter counter;
+        CollOverCounter_init(&counter, nbits, n, obj->arena);
+        uint64_t u[COLLOVER_CHUNK_LEN];
+        for (unsigned long i = 0; i < opts->nsamples; i++) {
+            uint64_t cur_tuple = collisionover_init_tuple(opts, obj);
+            for (size_t j = 0; j < n; j += COLLOVER_CHUNK_LEN) {
+                const size_t len = (n - j < COLLOVER_CHUNK_LEN) ? (n - j) : COLLOVER_CHUNK_LEN;
+                collisionover_make_tuples(opts, obj, u, len, &cur_tuple);
+                for (size_t k = 0; k < len; k++) {
+                    CollOverCounter_add(&counter, u[k]);
+                }
+            }
+            CollOverCounter_count(&counter, Oi);
+        }
+        CollOverCounter_destruct(&counter);
+    } else {
         // Find collisions by sorting the array
-        fastsort64(u, n);
-        size_t ncopies = 0;
-        for (size_t j = 0; j < n - 1; j++) {
-            if (u[j] == u[j + 1]) {
-                ncopies++;
-            } else {
-                Oi[(ncopies < 3) ? (ncopies + 1) : 3]++;
-                Oi[0]--;
-                ncopies = 0;
+        uint64_t *u = TestArena_calloc(obj->arena, n, sizeof(uint64_t));
+        ASSERT_MALLOC_PTR(u, "collisionover_test")
+        for (unsigned long i = 0; i < opts->nsamples; i++) {
+            uint64_t cur_tuple = collisionover_init_tuple(opts, obj);
+            collisionover_make_tuples(opts, obj, u, n, &cur_tuple);
+            fastsort64_mt(u, n, opts->nthreads);
+            size_t ncopies = 0;
+            for (size_t j = 0; j < n - 1; j++) {
+                if (u[j] == u[j + 1]) {
+                    ncopies++;
+                } else {
+                    Oi[(ncopies < 3) ? (ncopies + 1) : 3]++;
+                    Oi[0]--;
+                    ncopies = 0;
+                }
             }
+            // The last cell
+            Oi[(ncopies < 3) ? (ncopies + 1) : 3]++;
+            Oi[0]--;
         }
+        TestArena_free(obj->arena, u);
     }
     ans.x += (double) Oi[2];
     ans.p = sr_poisson_pvalue(ans.x, mu * (double) opts->nsamples);
@@ -501,7 +969,6 @@ TestResults collisionover_test(GeneratorState *obj, const CollOverNDOptions *opt
         lambda, mu, (int) opts->nsamples);
     obj->intf->printf("  x = %g; p = %g\n", ans.x, ans.p);
     obj->intf->printf("\n");
-    free(u);
     return ans;
 }
 
@@ -521,50 +988,77 @@ static unsigned long long GapOptions_max_gaplen(const GapOptions *opts, double p
     return (unsigned long long) ((log(pgap_fail) - log(p)) / log(1.0 - p));
 }
 
+/**
+ * @brief Gap test settings for its kernel.
+ */
+typedef struct {
+    uint64_t beta; ///< Upper bound of the gap in the generator output units
+    size_t nbins; ///< Number of bins (the last one is for longer gaps)
+    unsigned long long max_gap_len; ///< Gap length for failure
+} GapKernelOptions;
+
+
+/**
+ * @brief Gap test kernel: collects the histogram of gap lengths.
+ */
+static int gap_test_kernel(GeneratorState *obj, unsigned long long *Oi,
+    unsigned long long ngaps, const void *udata)
+{
+    const GapKernelOptions *opts = udata;
+    const uint64_t beta = opts->beta;
+    const size_t nbins = opts->nbins;
+    for (unsigned long long i = 0; i < ngaps; i++) {
+        size_t gap_len = 0;
+        uint64_t u = GeneratorState_get_bits(obj);
+        while (u > beta) {
+            gap_len++;
+            u = GeneratorState_get_bits(obj);
+            if (gap_len >= opts->max_gap_len) {
+                return 0;
+            }
+        }
+        Oi[(gap_len < nbins) ? gap_len : nbins]++;
+    }
+    return 1;
+}
+
+
 /**
  * @brief Knuth's gap test for detecting lagged Fibonacci generators.
  * @details Gap is \f$ [0;\beta) \f$ where \f$\beta = 1 / (2^{shl}) \f$.
+ * Supports the split/merge mode.
  */
 TestResults gap_test(GeneratorState *obj, const GapOptions *opts)
 {
     const double pgap_fail = 1.0e-15;
     const double Ei_min = 10.0;
     const double p = 1.0 / (double) (1ull << opts->shl); // beta in the floating point format
-    const uint64_t beta = 1ull << (obj->gi->nbits - opts->shl);
-    uint64_t u;
     const unsigned long long ngaps = opts->ngaps;
-    const size_t nbins = (size_t) (log(Ei_min / ((double) ngaps * p)) / log(1 - p));
-    size_t *Oi = calloc(nbins + 1, sizeof(size_t));
+    GapKernelOptions kopts;
+    kopts.beta = 1ull << (obj->gi->nbits - opts->shl);
+    kopts.nbins = (size_t) (log(Ei_min / ((double) ngaps * p)) / log(1 - p));
+    kopts.max_gap_len = GapOptions_max_gaplen(opts, pgap_fail);
+    const size_t nbins = kopts.nbins;
+    unsigned long long *Oi = calloc(nbins + 1, sizeof(unsigned long long));
     ASSERT_MALLOC_PTR(Oi, "gap_test")
-    unsigned long long nvalues = 0;
-    const unsigned long long max_gap_len = GapOptions_max_gaplen(opts, pgap_fail);
+    const unsigned long long nvalues0 = GeneratorState_get_nvalues(obj);
     TestResults ans = TestResults_create("Gap");
     obj->intf->printf("Gap test\n");
     obj->intf->printf("  alpha = 0.0; beta = %g; shl = %u;\n", p, opts->shl);
     obj->intf->printf("  ngaps = %llu (2^%.2f or 10^%.2f); nbins = %llu\n",
         ngaps, sr_log2((double) ngaps), log10((double) ngaps),
         (unsigned long long) nbins);
-    obj->intf->printf("  max_gap_len = %llu\n", max_gap_len);
-
-    for (unsigned long long i = 0; i < ngaps; i++) {
-        size_t gap_len = 0;
-        u = obj->gi->get_bits(obj->state);
-        nvalues++;
-        while (u > beta) {
-            gap_len++;
-            u = obj->gi->get_bits(obj->state);
-            nvalues++;
-            if (gap_len >= max_gap_len) {
-                obj->intf->printf("  Generator output doesn't hit the gap! p <= %g\n", pgap_fail);
-                ans.p = pgap_fail;
-                ans.alpha = 1.0 - ans.p;
-                ans.x = NAN;
-                free(Oi);
-                return ans;
-            }
-        }
-        Oi[(gap_len < nbins) ? gap_len : nbins]++;
+    obj->intf->printf("  max_gap_len = %llu\n", kopts.max_gap_len);
+    if (!GeneratorState_collect_counts(obj, gap_test_kernel, &kopts,
+        Oi, nbins + 1, ngaps)) {
+        obj->intf->printf("  Generator output doesn't hit the gap! p <= %g\n", pgap_fail);
+        ans.p = pgap_fail;
+        ans.alpha = 1.0 - ans.p;
+        ans.x = NAN;
+        free(Oi);
+        return ans;
     }
+    const unsigned long long nvalues = GeneratorState_get_nvalues(obj) - nvalues0;
     ans.penalty = PENALTY_GAP;
     ans.x = 0.0; // chi2emp
     for (size_t i = 0; i < nbins; i++) {
@@ -710,7 +1204,8 @@ void gap16_count0_mainloop(GapFrequencyArray *gapfreq, GapFrequencyArray *gapfre
     const unsigned long long nbins = (unsigned long long) gapfreq->nbins;
     unsigned long long last0_pos = ULLONG_MAX;
     uint64_t u = 0;
-    unsigned long long *lastw16_pos = calloc(65536, sizeof(unsigned long long));
+    unsigned long long *lastw16_pos = TestArena_calloc(obj->arena, 65536,
+        sizeof(unsigned long long));
     ASSERT_MALLOC_PTR(lastw16_pos, "gap16_count0")
     for (size_t i = 0; i < 65536; i++) {
         lastw16_pos[i] = ULLONG_MAX;
@@ -718,7 +1213,7 @@ void gap16_count0_mainloop(GapFrequencyArray *gapfreq, GapFrequencyArray *gapfre
     for (unsigned long long pos = 0; pos < ngaps; pos++) {
         // Generate 16-bit word
         if ((pos & mod_mask) == 0) {
-            u = obj->gi->get_bits(obj->state);
+            u = GeneratorState_get_bits(obj);
         }
         uint64_t w16 = u & 0xFFFF;
         u >>= 16;
@@ -751,7 +1246,7 @@ void gap16_count0_mainloop(GapFrequencyArray *gapfreq, GapFrequencyArray *gapfre
         // c) Update beginning
         lastw16_pos[w16] = pos;
     }
-    free(lastw16_pos);
+    TestArena_free(obj->arena, lastw16_pos);
 }
 
 
@@ -950,10 +1445,35 @@ static void sumcollector_calc_p(double *p, unsigned int g, unsigned int nmax)
     free(g_mat);
 }
 
+static int sumcollector_test_kernel(GeneratorState *obj, unsigned long long *Oi_vec,
+    unsigned long long nvalues, const void *udata)
+{
+    const unsigned int g = 10, nmax = 49;
+    size_t y_cur = 0;
+    uint64_t sum = 0, sum_max = (1ull << 32) * g;
+    unsigned int shr = (obj->gi->nbits == 32) ? 0 : 32;
+    for (unsigned long long i = 0; i < nvalues; i++) {
+        uint64_t u = GeneratorState_get_bits(obj) >> shr;
+        uint64_t sum_new = u + sum;
+        if (sum_new <= sum_max) {
+            sum = sum_new;
+            y_cur++;
+        } else {
+            if (y_cur > nmax) y_cur = nmax;
+            Oi_vec[y_cur]++;
+            sum = GeneratorState_get_bits(obj) >> shr;
+            y_cur = 1;
+        }
+    }
+    (void) udata;
+    return 1;
+}
+
 /**
  * @brief SumCollector test from TestU01 test suite.
  * @details Sensitive to the SWB (subtract with borrow) algorithm, in some cases
- * - even to its versions with lower "luxury levels".
+ * - even to its versions with lower "luxury levels". Supports the split/merge
+ * mode.
  *
  * References:
  * 1. G. Ugrin-Sparac. On a distribution encountered in the renewal process based
@@ -967,9 +1487,6 @@ TestResults sumcollector_test(GeneratorState *obj, const SumCollectorOptions *op
 {
     TestResults ans = TestResults_create("sumcollector");
     const unsigned int g = 10, nmax = 49;
-    size_t y_cur = 0;
-    uint64_t sum = 0, sum_max = (1ull << 32) * g;
-    unsigned int shr = (obj->gi->nbits == 32) ? 0 : 32;
     unsigned long long *Oi_vec = calloc(nmax + 1, sizeof(unsigned long long));
     ASSERT_MALLOC_PTR(Oi_vec, "sumcollector_test")
     double *p_vec = calloc(nmax + 1, sizeof(double));
@@ -978,20 +1495,8 @@ TestResults sumcollector_test(GeneratorState *obj, const SumCollectorOptions *op
     obj->intf->printf("  Number of values: %llu (2^%g)\n",
         opts->nvalues, sr_log2((double) opts->nvalues));
     sumcollector_calc_p(p_vec, g, nmax);
-
-    for (unsigned long long i = 0; i < opts->nvalues; i++) {
-        uint64_t u = obj->gi->get_bits(obj->state) >> shr;
-        uint64_t sum_new = u + sum;
-        if (sum_new <= sum_max) {
-            sum = sum_new;
-            y_cur++;
-        } else {
-            if (y_cur > nmax) y_cur = nmax;
-            Oi_vec[y_cur]++;
-            sum = obj->gi->get_bits(obj->state) >> shr;
-            y_cur = 1;
-        }
-    }
+    GeneratorState_collect_counts(obj, sumcollector_test_kernel, NULL,
+        Oi_vec, nmax + 1, opts->nvalues);
     unsigned long long Oi_sum = 0;
     for (int i = 0; i < 50; i++) {
         Oi_sum += Oi_vec[i];
@@ -1022,11 +1527,154 @@ TestResults sumcollector_test(GeneratorState *obj, const SumCollectorOptions *op
 }
 
 
-static inline uint32_t mod3_update_tuple(GeneratorState *obj,
-    uint32_t tuple, unsigned int ntuples)
+/**
+ * @brief Number of 9-digit base 3 tuples in the `mod3` test, i.e. 3^9.
+ */
+#define MOD3_NTUPLES 19683u
+
+/**
+ * @brief Maximal number of increments of 32-bit counters in the `mod3`
+ * kernel before spilling them into the 64-bit histogram.
+ */
+#define MOD3_SPILL_PERIOD (1ull << 31)
+
+/**
+ * @brief Residue of a 64-bit value modulo 3 without 64-bit division.
+ * @details Uses 2^16 = 1 (mod 3) to fold the value into a 16-bit sum
+ * and then computes the remainder by multiply-high by 0xAAAB = (2^17 + 1)/3
+ * that is exact for arguments below 2^17. Only 32-bit arithmetic is used,
+ * so the loop over the block is easily vectorized by the compiler.
+ */
+static inline uint32_t mod3_residue(uint64_t x)
+{
+    const uint32_t a = (uint32_t) x, b = (uint32_t) (x >> 32);
+    uint32_t s = (a & 0xFFFF) + (a >> 16) + (b & 0xFFFF) + (b >> 16);
+    s = (s & 0xFFFF) + (s >> 16);
+    return s - 3u * ((s * 0xAAABu) >> 17);
+}
+
+/**
+ * @brief Computes residues modulo 3 for a block of generator outputs:
+ * portable version, also processes the tail of the AVX2 one.
+ */
+void mod3_residues_block_portable(uint32_t *r, const uint64_t *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        r[i] = mod3_residue(x[i]);
+    }
+}
+
+/**
+ * @brief Computes residues modulo 3 for a block of generator outputs.
+ * The AVX2 version processes 4 values at once, its output must be
+ * identical to mod3_residues_block_portable.
+ */
+void mod3_residues_block(uint32_t *r, const uint64_t *x, size_t n)
 {
-    const uint32_t d = (uint32_t) (obj->gi->get_bits(obj->state) % 3u);
-    return (tuple * 3u + d) % ntuples;
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256i mask16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i mul = _mm256_set1_epi32(0xAAAB);
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (const void *) (x + i));
+        // Sums of 16-bit digits of both 32-bit halves in 32-bit lanes
+        __m256i s = _mm256_add_epi32(_mm256_and_si256(v, mask16),
+            _mm256_srli_epi32(v, 16));
+        s = _mm256_add_epi32(s, _mm256_srli_epi64(s, 32));
+        s = _mm256_add_epi32(_mm256_and_si256(s, mask16),
+            _mm256_srli_epi32(s, 16));
+        // s - 3 * floor(s / 3) in the lower 32-bit lane of each 64-bit lane
+        __m256i q = _mm256_srli_epi32(_mm256_mullo_epi32(s, mul), 17);
+        s = _mm256_sub_epi32(s, _mm256_mullo_epi32(q, three));
+        s = _mm256_permutevar8x32_epi32(s, perm);
+        _mm_storeu_si128((__m128i *) (void *) (r + i),
+            _mm256_castsi256_si128(s));
+    }
+#endif
+    mod3_residues_block_portable(r + i, x + i, n - i);
+}
+
+/**
+ * @brief Builds base 3 tuples from residues: `t[i]` is made of the 9 digits
+ * `r[i]`,...,`r[i + 8]` (the last one is the lowest digit). The tuples
+ * of the sliding window are independent and built by the Horner scheme
+ * without divisions, so the loop is vectorized by the compiler (unlike
+ * the `(3 * tuple + d) mod 3^9` recurrence).
+ */
+static inline void mod3_tuples_block(uint32_t *t, const uint32_t *r, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint32_t tuple = r[i];
+        for (size_t j = 1; j < 9; j++) {
+            tuple = tuple * 3u + r[i + j];
+        }
+        t[i] = tuple;
+    }
+}
+
+/**
+ * @brief Adds 32-bit counters to the 64-bit histogram and resets them.
+ */
+static void mod3_spill_counts(unsigned long long *Oi, uint32_t *Oi32)
+{
+    for (unsigned int i = 0; i < MOD3_NTUPLES; i++) {
+        Oi[i] += Oi32[i];
+        Oi32[i] = 0;
+    }
+}
+
+/**
+ * @brief `mod3` test kernel: processes the generator output by blocks
+ * taken directly from the GeneratorState buffer. Residues of the whole
+ * block are computed first, then the tuples are built and counted in the
+ * compact histogram with 32-bit counters (78 KiB instead of 157 KiB) that
+ * is periodically spilled into `Oi`. The last 8 residues are carried over
+ * to the next block. Consumes exactly the same values as the value-by-value
+ * implementation: 8 values for the initial tuple, `nvalues` counted values
+ * and one trailing value.
+ */
+static int mod3_test_kernel(GeneratorState *obj, unsigned long long *Oi,
+    unsigned long long nvalues, const void *udata)
+{
+    uint32_t r[GENERATOR_STATE_BUFSIZE + 8], t[GENERATOR_STATE_BUFSIZE];
+    uint32_t *Oi32 = calloc(MOD3_NTUPLES, sizeof(uint32_t));
+    ASSERT_MALLOC_PTR(Oi32, "mod3_test_kernel")
+    for (size_t i = 0; i < 8; i++) {
+        r[i] = mod3_residue(GeneratorState_get_bits(obj));
+    }
+    unsigned long long nspill = 0;
+    while (nvalues > 0) {
+        if (obj->buf_pos >= obj->buf_len) {
+            GeneratorState_refill(obj);
+        }
+        size_t len = obj->buf_len - obj->buf_pos;
+        if (len > nvalues) {
+            len = (size_t) nvalues;
+        }
+        if (len > MOD3_SPILL_PERIOD - nspill) {
+            len = (size_t) (MOD3_SPILL_PERIOD - nspill);
+        }
+        mod3_residues_block(r + 8, obj->buf + obj->buf_pos, len);
+        obj->buf_pos += len;
+        mod3_tuples_block(t, r, len);
+        for (size_t i = 0; i < len; i++) {
+            Oi32[t[i]]++;
+        }
+        memmove(r, r + len, 8 * sizeof(uint32_t));
+        nvalues -= len;
+        nspill += len;
+        if (nspill == MOD3_SPILL_PERIOD) {
+            mod3_spill_counts(Oi, Oi32);
+            nspill = 0;
+        }
+    }
+    GeneratorState_discard(obj, 1);
+    mod3_spill_counts(Oi, Oi32);
+    free(Oi32);
+    (void) udata;
+    return 1;
 }
 
 /**
@@ -1037,26 +1685,20 @@ static inline uint32_t mod3_update_tuple(GeneratorState *obj,
  * by 3 can be represented as a combination of left shift and addition.
  *
  * At larger samples (about 2^30 values) it catches 32-bit LCGs with (even
- * with prime modulus and shr3 (xorshift32).
+ * with prime modulus and shr3 (xorshift32). Supports the split/merge mode.
  * @param opts  Test options (nvalues - sample size, number of values)
  */
 TestResults mod3_test(GeneratorState *obj, const Mod3Options *opts)
 {
     TestResults ans = TestResults_create("mod3");
-    const unsigned int ntuples = 19683; // 3^9
+    const unsigned int ntuples = MOD3_NTUPLES;
     unsigned long long *Oi = calloc(ntuples, sizeof(unsigned long long));
     ASSERT_MALLOC_PTR(Oi, "mod3_test")
-    uint32_t tuple = 0;
     obj->intf->printf("mod3 test\n");
     obj->intf->printf("  Sample size: %llu (2^%.2f) values\n",
         opts->nvalues, sr_log2((double) opts->nvalues));
-    for (int i = 0; i < 9; i++) {
-        tuple = mod3_update_tuple(obj, tuple, ntuples);
-    }
-    for (unsigned long long i = 0; i < opts->nvalues; i++) {
-        Oi[tuple]++;
-        tuple = mod3_update_tuple(obj, tuple, ntuples);
-    }
+    GeneratorState_collect_counts(obj, mod3_test_kernel, NULL,
+        Oi, ntuples, opts->nvalues);
     double Ei = (double) opts->nvalues / (double) ntuples;
     ans.x = 0.0;
     for (unsigned int i = 0; i < ntuples; i++) {
@@ -1077,38 +1719,52 @@ TestResults mod3_test(GeneratorState *obj, const Mod3Options *opts)
 //////////////////////////////////////////
 
 /**
- * @brief Monobit frequency test.
+ * @brief Monobit frequency test kernel: counts the number of ones.
  */
-TestResults monobit_freq_test(GeneratorState *obj, const MonobitFreqOptions *opts)
+static int monobit_freq_test_kernel(GeneratorState *obj, unsigned long long *nones,
+    unsigned long long len, const void *udata)
 {
-    int sum_per_byte[256];
-    unsigned long long len = opts->nvalues;
-    unsigned long long nbits_total = len * obj->gi->nbits;
-    TestResults ans;
-    ans.name = "MonobitFreq";
-    obj->intf->printf("Monobit frequency test\n");
-    obj->intf->printf("  Number of bits: %llu (2^%.2f)\n", nbits_total,
-        log((double) nbits_total) / log(2.0));
+    unsigned int ones_per_byte[256];
     for (size_t i = 0; i < 256; i++) {
         uint8_t u = (uint8_t) i;
-        sum_per_byte[i] = 0;
+        ones_per_byte[i] = 0;
         for (size_t j = 0; j < 8; j++) {
             if ((u & 0x1) != 0) {
-                sum_per_byte[i]++;
+                ones_per_byte[i]++;
             }
             u >>= 1;
         }
-        sum_per_byte[i] -= 4;
     }
-    int64_t bitsum = 0;
+    unsigned long long sum = 0;
     unsigned int nbytes = obj->gi->nbits / 8;
     for (unsigned long long i = 0; i < len; i++) {
-        uint64_t u = obj->gi->get_bits(obj->state);
+        uint64_t u = GeneratorState_get_bits(obj);
         for (unsigned int j = 0; j < nbytes; j++) {
-            bitsum += sum_per_byte[u & 0xFF];
+            sum += ones_per_byte[u & 0xFF];
             u >>= 8;
         }
     }
+    *nones += sum;
+    (void) udata;
+    return 1;
+}
+
+/**
+ * @brief Monobit frequency test. Supports the split/merge mode.
+ */
+TestResults monobit_freq_test(GeneratorState *obj, const MonobitFreqOptions *opts)
+{
+    unsigned long long len = opts->nvalues;
+    unsigned long long nbits_total = len * obj->gi->nbits;
+    TestResults ans;
+    ans.name = "MonobitFreq";
+    obj->intf->printf("Monobit frequency test\n");
+    obj->intf->printf("  Number of bits: %llu (2^%.2f)\n", nbits_total,
+        log((double) nbits_total) / log(2.0));
+    unsigned long long nones = 0;
+    GeneratorState_collect_counts(obj, monobit_freq_test_kernel, NULL,
+        &nones, 1, len);
+    const int64_t bitsum = (int64_t) nones - (int64_t) (nbits_total / 2);
     ans.penalty = PENALTY_FREQ;
     ans.x = fabs((double) bitsum) / sqrt((double) (len * obj->gi->nbits));
     ans.p = sr_stdnorm_pvalue(ans.x);
@@ -1159,7 +1815,7 @@ TestResults nbit_words_freq_test(GeneratorState *obj,
             wfreq[i] = 0;
         }
         for (size_t i = 0; i < block_len; i++) {
-            uint64_t u = obj->gi->get_bits(obj->state);
+            uint64_t u = GeneratorState_get_bits(obj);
             for (size_t j = 0; j < nwords_per_num; j++) {
                 wfreq[u & mask]++;
                 u >>= opts->bits_per_word;
@@ -1282,3 +1938,86 @@ TestResults sumcollector_test_wrap(GeneratorState *obj, const void *udata)
 {
     return sumcollector_test(obj, udata);
 }
+
+///////////////////////////////////////////////////////
+///// Memory estimations for the tests dispatcher /////
+///////////////////////////////////////////////////////
+
+/**
+ * @brief Estimated peak memory consumption of the n-dimensional birthday
+ * spacings test, bytes.
+ */
+static size_t bspace_nd_test_memory(const void *udata)
+{
+    const BSpaceNDOptions *opts = udata;
+    const unsigned int nbits_total = opts->ndims * opts->nbits_per_dim;
+    const size_t len = bspace_calc_len(nbits_total);
+    if (nbits_total > 32) {
+        return len * sizeof(uint64_t) + opts->nsamples * sizeof(unsigned long);
+    } else {
+        const size_t batch_nsamples = bspace32_get_batch_nsamples(len, opts->nsamples);
+        return (batch_nsamples + 1) * len * sizeof(uint32_t) + sizeof(BSpace32SortHist);
+    }
+}
+
+/**
+ * @brief Estimated peak memory consumption of the CollisionOver test, bytes.
+ * @details The streaming counter keeps about 4 bytes per tuple plus
+ * the partially filled blocks and the hash table, sorting requires
+ * 8 bytes per tuple.
+ */
+static size_t collisionover_test_memory(const void *udata)
+{
+    const CollOverNDOptions *opts = udata;
+    const unsigned int nbits = opts->ndims * opts->nbits_per_dim;
+    if (nbits <= COLLOVER_STREAM_MAX_NBITS) {
+        const size_t npart = (size_t) 1 << COLLOVER_NPART_BITS;
+        const size_t nblocks = opts->n / COLLOVER_BLOCK_LEN + npart + 1;
+        return nblocks * (COLLOVER_BLOCK_LEN + 1) * sizeof(uint32_t) +
+            4 * (opts->n / npart) * (sizeof(uint32_t) + sizeof(uint8_t));
+    } else {
+        return opts->n * sizeof(uint64_t);
+    }
+}
+
+//////////////////////////////////////////////////////
+///// Properties of tests for the battery runner /////
+//////////////////////////////////////////////////////
+
+OPTIONS_SCALE_FUNC_TPL(BSpaceNDOptions, nsamples)
+OPTIONS_SCALE_FUNC_TPL(CollOverNDOptions, nsamples)
+OPTIONS_SCALE_FUNC_TPL(GapOptions, ngaps)
+OPTIONS_SCALE_FUNC_TPL(Gap16Count0Options, ngaps)
+OPTIONS_SCALE_FUNC_TPL(Mod3Options, nvalues)
+OPTIONS_SCALE_FUNC_TPL(MonobitFreqOptions, nvalues)
+OPTIONS_SCALE_FUNC_TPL(SumCollectorOptions, nvalues)
+
+const TestTraits bspace_nd_test_traits = {
+    .memory = bspace_nd_test_memory,
+    TEST_TRAITS_SCALER(BSpaceNDOptions)
+};
+
+const TestTraits collisionover_test_traits = {
+    .memory = collisionover_test_memory,
+    TEST_TRAITS_SCALER(CollOverNDOptions)
+};
+
+const TestTraits sumcollector_test_traits = {
+    TEST_TRAITS_SCALER(SumCollectorOptions)
+};
+
+// Tests that just read the generator output sequentially
+const TestTraits monobit_freq_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(MonobitFreqOptions)
+};
+const TestTraits byte_freq_test_traits = {.is_pipelined = 1};
+const TestTraits word16_freq_test_traits = {.is_pipelined = 1};
+const TestTraits gap_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(GapOptions)
+};
+const TestTraits gap16_count0_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(Gap16Count0Options)
+};
+const TestTraits mod3_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(Mod3Options)
+};
@@ -213,3 +213,50 @@ uint64_t cpuclock()
     return emulate_cpuclock();
 #endif
 }
+
+
+/**
+ * @brief Returns the time from some fixed moment in seconds. Uses
+ * the monotonic clock if it is available, i.e. its result is not affected
+ * by changes of the system time.
+ */
+double get_wall_time(void)
+{
+#ifdef WINDOWS_PLATFORM
+    LARGE_INTEGER freq, ctr;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&ctr);
+    return (double) ctr.QuadPart / (double) freq.QuadPart;
+#elif !defined(NO_POSIX) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+#else
+    return (double) time(NULL);
+#endif
+}
+
+/**
+ * @brief Returns CPU time consumed by the current thread in seconds.
+ * If the thread CPU time is not supported then CPU time consumed by
+ * the whole process is returned.
+ */
+double get_thread_cpu_time(void)
+{
+#ifdef WINDOWS_PLATFORM
+    FILETIME t_create, t_exit, t_kernel, t_user;
+    if (GetThreadTimes(GetCurrentThread(), &t_create, &t_exit, &t_kernel, &t_user)) {
+        ULARGE_INTEGER k, u;
+        k.LowPart = t_kernel.dwLowDateTime; k.HighPart = t_kernel.dwHighDateTime;
+        u.LowPart = t_user.dwLowDateTime; u.HighPart = t_user.dwHighDateTime;
+        return 1.0e-7 * (double) (k.QuadPart + u.QuadPart);
+    }
+    return (double) clock() / CLOCKS_PER_SEC;
+#elif !defined(NO_POSIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
@@ -577,15 +577,10 @@ char *Entropy_get_base64_key(const Entropy *obj)
 }
 
 /**
- * @brief Returns 64-bit random seed. Hardware RNG is used
- * when possible. WARNING! THIS FUNCTION IS NOT THREAD SAFE!
+ * @brief Saves the seed to the seeds log.
  */
-uint64_t Entropy_seed64(Entropy *obj, uint64_t thread_id)
+static void Entropy_log_seed(Entropy *obj, uint64_t stream_id, uint64_t seed)
 {
-    if (!Entropy_is_init(obj)) {
-        Entropy_init(obj);
-    }
-    uint64_t seed = ChaCha20State_next64(&obj->gen);
     if (obj->slog_pos != obj->slog_maxlen - 1) {
         // Check if buffer resizing is needed
         if (obj->slog_pos >= obj->slog_len - 1) {
@@ -597,22 +592,87 @@ uint64_t Entropy_seed64(Entropy *obj, uint64_t thread_id)
         // Save seed to the log
         SeedLogEntry log_entry;
         log_entry.seed = seed;
-        log_entry.thread_id = thread_id;
+        log_entry.stream_id = stream_id;
         obj->slog[obj->slog_pos++] = log_entry;
     }
+}
+
+/**
+ * @brief Returns 64-bit random seed. Hardware RNG is used
+ * when possible. WARNING! THIS FUNCTION IS NOT THREAD SAFE!
+ */
+uint64_t Entropy_seed64(Entropy *obj, uint64_t stream_id)
+{
+    if (!Entropy_is_init(obj)) {
+        Entropy_init(obj);
+    }
+    uint64_t seed = ChaCha20State_next64(&obj->gen);
+    Entropy_log_seed(obj, stream_id, seed);
     return seed;
 }
 
+/**
+ * @brief Initializes an independent ChaCha20 substream for seeds generation.
+ * @details It uses the same key as the main stream but the stream identifier
+ * is used as a nonce instead of `CHACHA_DEFAULT_NONCE`. So the substream
+ * output depends only on the key and the identifier: e.g. each test
+ * in the battery may have its own seeds independent of the tests execution
+ * order. The substream doesn't change the state of the main stream and
+ * is not logged, see Entropy_log_substream.
+ * @param obj        Initialized entropy source (will be initialized
+ *                   if it is not). NOT THREAD SAFE in the last case.
+ * @param gen        Output ChaCha20 state.
+ * @param stream_id  Substream identifier, shouldn't be equal to 0.
+ */
+void Entropy_init_substream(Entropy *obj, ChaCha20State *gen, uint64_t stream_id)
+{
+    if (!Entropy_is_init(obj)) {
+        Entropy_init(obj);
+    }
+    ChaCha20State_init(gen, Entropy_get_key(obj), stream_id);
+}
+
+/**
+ * @brief Regenerates the first `nseeds` seeds from the given substream
+ * and saves them to the seeds log. Allows to keep the log deterministic
+ * in the multithreaded environment without locking it on each call.
+ */
+void Entropy_log_substream(Entropy *obj, uint64_t stream_id, size_t nseeds)
+{
+    ChaCha20State gen;
+    Entropy_init_substream(obj, &gen, stream_id);
+    for (size_t i = 0; i < nseeds; i++) {
+        Entropy_log_seed(obj, stream_id, ChaCha20State_next64(&gen));
+    }
+}
+
+/**
+ * @brief Removes the seeds of the given substream from the seeds log
+ * starting from the `pos` position, the order of other seeds is preserved.
+ * Allows to rerun the test with the same substream without duplicates
+ * in the log.
+ */
+void Entropy_unlog_substream(Entropy *obj, size_t pos, uint64_t stream_id)
+{
+    size_t j = pos;
+    for (size_t i = pos; i < obj->slog_pos; i++) {
+        if (obj->slog[i].stream_id != stream_id) {
+            obj->slog[j++] = obj->slog[i];
+        }
+    }
+    obj->slog_pos = j;
+}
+
 void Entropy_print_seeds_log(const Entropy *obj, FILE *fp)
 {
     const size_t max_log_length = 1024;
     int filler_printed = 0;
     fprintf(fp, "Number of seeds: %llu\n", (unsigned long long) obj->slog_pos);
-    fprintf(fp, "%10s %18s %20s\n", "Thread", "Seed(HEX)", "Seed(DEC)");
+    fprintf(fp, "%10s %18s %20s\n", "Stream", "Seed(HEX)", "Seed(DEC)");
     for (size_t i = 0; i < obj->slog_pos; i++) {
         if (i < max_log_length || i > obj->slog_pos - 5) {
             fprintf(fp, "%10" PRIX64 " 0x%.16" PRIX64 " %.20" PRIu64 "\n",
-                obj->slog[i].thread_id, obj->slog[i].seed, obj->slog[i].seed);
+                obj->slog[i].stream_id, obj->slog[i].seed, obj->slog[i].seed);
         } else if (!filler_printed) {
             fprintf(fp, "    ...................................................\n");
             filler_printed = 1;
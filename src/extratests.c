@@ -14,6 +14,7 @@
 #include "smokerand/cpuinfo.h"
 #include "smokerand/extratests.h"
 #include "smokerand/specfuncs.h"
+#include "smokerand/threads_intf.h"
 #include <math.h>
 #include <float.h>
 #include <stdio.h>
@@ -59,6 +60,7 @@ CollOver64DecimatedOptions_create(const GeneratorInfo *gi,
     opts.mvalue = 0;
     opts.is_dynamic_mvalue = 1;
     opts.niters_max = 10000;
+    opts.nthreads = 1;
     return opts;
 }
 
@@ -125,6 +127,7 @@ CollOver64DecimatedOptions_print(const CollOver64DecimatedOptions *opts, const C
     intf->printf("  Raw sample size:  2^%.2f values (2^%.2f bytes)\n",
         sr_log2((double) nvalues_raw), sr_log2(8.0 * (double) nvalues_raw));
     intf->printf("  lambda = %g\n", lambda);
+    intf->printf("  Sorting threads:  %u\n", opts->nthreads);
 }
 
 /**
@@ -138,13 +141,13 @@ static inline uint64_t collover64dec_gen_trvalue(GeneratorState *obj,
     static const long ctr_max = 100000000;
     if (obj->gi->nbits == 64) {
         do {            
-            u = obj->gi->get_bits(obj->state);
+            u = GeneratorState_get_bits(obj);
             ctr++;
         } while ((u & mask) != mvalue && ctr < ctr_max);
     } else {
         do {
-            const uint64_t lo = obj->gi->get_bits(obj->state);
-            const uint64_t hi = obj->gi->get_bits(obj->state);
+            const uint64_t lo = GeneratorState_get_bits(obj);
+            const uint64_t hi = GeneratorState_get_bits(obj);
             u = (hi << 32) | lo;
             ctr++;
         } while ((u & mask) != mvalue && ctr < ctr_max);
@@ -187,12 +190,13 @@ collover64dec_get_bytes_per_sec(GeneratorState *obj,
  * @brief Calculate the number of duplicated in the generated array.
  */
 static unsigned long long collover64dec_calc_ndups(const CallerAPI *intf,
-    uint64_t *x, size_t len)
+    uint64_t *x, size_t len, unsigned int nthreads)
 {
     char buf[16];
     intf->printf("\n  Sorting the array...");
     const time_t tic = time(NULL);
-    radixsort64_inplace(x, len); // "In place": to prevent "out of memory"
+    // "In place": to prevent "out of memory"
+    radixsort64_inplace_mt(x, len, nthreads);
     snprintf_elapsed_time(buf, 15, (unsigned long long) (time(NULL) - tic));
     intf->printf("  Time elapsed: %s\n", buf);
     intf->printf("  Searching collisions");
@@ -220,6 +224,112 @@ static unsigned long long CollOver64DecimatedOptions_get_chunk_size(
     return chunk_size;
 }
 
+/**
+ * @brief Progress indicator for the filling phase, aggregates progress
+ * of all fillers. Updated and printed by any running filler under
+ * `collover64dec_progress_mutex`.
+ */
+typedef struct {
+    const CallerAPI *intf;
+    unsigned long long nfilled; ///< Number of filled elements in all slices
+    unsigned long long n; ///< Total number of elements
+    unsigned long long bytes_per_trvalue;
+    unsigned long long chunk_size;
+    time_t tic;
+    uint64_t cpu_tic;
+} CollOver64DecProgress;
+
+/**
+ * @brief A filler of the array slice for the 64-bit collision test: each
+ * filler has its own generator, i.e. its own substream.
+ */
+typedef struct {
+    GeneratorState *obj; ///< Generator (substream)
+    const CollOver64DecimatedOptions *opts; ///< Test options
+    uint64_t *x; ///< Slice of the array
+    unsigned long long len; ///< Slice length
+    CollOver64DecProgress *progress; ///< Progress indicator shared by fillers
+    int is_ok; ///< 0 - the generator cannot return a truncated value
+} CollOver64DecFiller;
+
+DECLARE_MUTEX(collover64dec_progress_mutex)
+
+
+static void CollOver64DecProgress_print(CollOver64DecProgress *obj)
+{
+    const unsigned long long i = obj->nfilled;
+    const uint64_t cpu_toc = cpuclock();
+    if (cpu_toc < obj->cpu_tic) {
+        obj->cpu_tic = cpu_toc;
+    }
+    const double cpb = (double) (cpu_toc - obj->cpu_tic) /
+        (double) (i * obj->bytes_per_trvalue);
+    const unsigned long long nseconds_total = (unsigned long long) (time(NULL) - obj->tic);
+    const unsigned long long nseconds_left = (unsigned long long) (
+        ((unsigned long long) nseconds_total * (obj->n - i)) / (i + 1)
+    );
+    const double mib_per_sec = (double) (i * obj->bytes_per_trvalue) /
+                               (double) nseconds_total / (1ul << 20);
+    char buf_total[16], buf_left[16];
+    snprintf_elapsed_time(buf_total, 15, nseconds_total);
+    snprintf_elapsed_time(buf_left, 15, nseconds_left);
+    obj->intf->printf("\r    %.1f %% completed; ",
+        100.0 * (double) i / (double) obj->n);
+    obj->intf->printf("time elapsed: %s, left: %s", buf_total, buf_left);
+    if (mib_per_sec > 1024.0) {
+        obj->intf->printf("; %.2f GiB/s (%.3g cpb)",
+            mib_per_sec / 1024.0, cpb);
+    } else if (mib_per_sec == mib_per_sec && mib_per_sec < 1e100) {
+        obj->intf->printf("; %.1f MiB/s (%.3g cpb)",
+            mib_per_sec, cpb);
+    }
+    obj->intf->printf("    ");
+}
+
+/**
+ * @brief Adds the number of newly filled elements to the progress indicator
+ * and prints it. Can be called by any filler.
+ */
+static void CollOver64DecProgress_update(CollOver64DecProgress *obj,
+    unsigned long long nfilled)
+{
+    MUTEX_LOCK(collover64dec_progress_mutex, "CollOver64DecProgress_update");
+    obj->nfilled += nfilled;
+    CollOver64DecProgress_print(obj);
+    MUTEX_UNLOCK(collover64dec_progress_mutex);
+}
+
+/**
+ * @brief Fills the slice of the array and updates the progress indicator
+ * shared by all fillers, so the progress is shown while any of them
+ * is running.
+ */
+static void CollOver64DecFiller_run(CollOver64DecFiller *filler)
+{
+    const CollOver64DecimatedOptions *opts = filler->opts;
+    const uint64_t mask = CollOver64DecimatedOptions_get_mask(opts);
+    const unsigned long long chunk_size = filler->progress->chunk_size;
+    unsigned long long nreported = 0;
+    for (unsigned long long i = 0; i < filler->len; i++) {
+        int is_ok;
+        filler->x[i] = collover64dec_gen_trvalue(filler->obj, mask, opts->mvalue, &is_ok);
+        if (!is_ok) {
+            filler->is_ok = 0;
+            return;
+        }
+        if (i % chunk_size == 0) {
+            CollOver64DecProgress_update(filler->progress, i + 1 - nreported);
+            nreported = i + 1;
+        }
+    }
+}
+
+static ThreadRetVal THREADFUNC_SPEC CollOver64DecFiller_thread(void *udata)
+{
+    CollOver64DecFiller_run(udata);
+    return 0;
+}
+
 /**
  * @brief 64-bit collision test (the former birthday paradox test) for 64-bit
  * pseudorandom number generators. Detects 64-bit uniformly distributed PRNGS
@@ -242,14 +352,27 @@ static unsigned long long CollOver64DecimatedOptions_get_chunk_size(
  * In the case of 32-bit generators it makes 64-integers by two subsequent calls
  * of the 32-bit PRNG.
  *
+ * If substreams of the generator are supplied (see
+ * `GeneratorState_create_substreams`) then the array is split into
+ * `nsubstreams` slices filled in parallel threads, each slice is filled
+ * from its own substream.
+ *
  * References:
  *
  * 1. M.E. O'Neill. A Birthday Test: Quickly Failing Some Popular PRNGs
  *    https://www.pcg-random.org/posts/birthday-test.html
+ *
+ * @param obj          Generator (used for speed estimation and for filling
+ *                     if there are no substreams).
+ * @param opts         Test options.
+ * @param buf          Buffer for `opts->n` values.
+ * @param substreams   Substreams of the generator (may be NULL).
+ * @param nsubstreams  Number of substreams (0 - use `obj`).
  */
 static unsigned long long
 collover64dec_test_ndups(GeneratorState *obj,
-    const CollOver64DecimatedOptions *opts, uint64_t *buf)
+    const CollOver64DecimatedOptions *opts, uint64_t *buf,
+    GeneratorState *substreams, unsigned int nsubstreams)
 {
     const unsigned long long ndups_failure = 10000000000ULL;
     if (opts->n < 8) {
@@ -258,49 +381,52 @@ collover64dec_test_ndups(GeneratorState *obj,
     }
     obj->intf->printf("  Filling the array with values (the lowest bits are 0x%llX)\n",
         (unsigned long long) opts->mvalue);
-    const uint64_t mask = CollOver64DecimatedOptions_get_mask(opts);
-    const time_t tic = time(NULL);
-    uint64_t cpu_tic = cpuclock();
-    unsigned long long chunk_size = CollOver64DecimatedOptions_get_chunk_size(opts, obj);
-    uint64_t *x = buf;
-    const unsigned long long bytes_per_trvalue = 1ull << (opts->e + 3);
-    for (unsigned long long i = 0; i < opts->n; i++) {
-        int is_ok;
-        x[i] = collover64dec_gen_trvalue(obj, mask, opts->mvalue, &is_ok);
-        if (!is_ok) {
-            obj->intf->printf("  The generator is too flawed to return a truncated value\n");
-            return ndups_failure;
-        }
-        if (i % chunk_size == 0) {
-            const uint64_t cpu_toc = cpuclock();
-            if (cpu_toc < cpu_tic) {
-                cpu_tic = cpu_toc;
-            }
-            const double cpb = (double) (cpu_toc - cpu_tic) / (double) (i * bytes_per_trvalue);
-            const unsigned long long nseconds_total = (unsigned long long) (time(NULL) - tic);
-            const unsigned long long nseconds_left = (unsigned long long) (
-                ((unsigned long long) nseconds_total * (opts->n - i)) / (i + 1)
-            );
-            const double mib_per_sec = (double) (i * bytes_per_trvalue) /
-                                       (double) nseconds_total / (1ul << 20);
-            char buf_total[16], buf_left[16];
-            snprintf_elapsed_time(buf_total, 15, nseconds_total);
-            snprintf_elapsed_time(buf_left, 15, nseconds_left);
-            obj->intf->printf("\r    %.1f %% completed; ",
-                100.0 * (double) i / (double) opts->n);
-            obj->intf->printf("time elapsed: %s, left: %s", buf_total, buf_left);
-            if (mib_per_sec > 1024.0) {
-                obj->intf->printf("; %.2f GiB/s (%.3g cpb)",
-                    mib_per_sec / 1024.0, cpb);
-            } else if (mib_per_sec == mib_per_sec && mib_per_sec < 1e100) {
-                obj->intf->printf("; %.1f MiB/s (%.3g cpb)",
-                    mib_per_sec, cpb);
-            }
-            obj->intf->printf("    ");
-        }
+    CollOver64DecProgress progress;
+    progress.intf = obj->intf;
+    progress.nfilled = 0;
+    progress.n = opts->n;
+    progress.bytes_per_trvalue = 1ull << (opts->e + 3);
+    progress.tic = time(NULL);
+    progress.cpu_tic = cpuclock();
+    progress.chunk_size = CollOver64DecimatedOptions_get_chunk_size(opts, obj);
+    // Split the array into slices
+    const unsigned int nfillers = (nsubstreams > 0) ? nsubstreams : 1;
+    CollOver64DecFiller *fillers = calloc(nfillers, sizeof(CollOver64DecFiller));
+    ThreadObj *thrd = calloc(nfillers, sizeof(ThreadObj));
+    if (fillers == NULL || thrd == NULL) {
+        fprintf(stderr, "***** collover64dec_test_ndups: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int k = 0; k < nfillers; k++) {
+        const unsigned long long i_begin = opts->n * k / nfillers;
+        const unsigned long long i_end = opts->n * (k + 1) / nfillers;
+        fillers[k].obj = (nsubstreams > 0) ? &substreams[k] : obj;
+        fillers[k].opts = opts;
+        fillers[k].x = buf + i_begin;
+        fillers[k].len = i_end - i_begin;
+        fillers[k].progress = &progress;
+        fillers[k].is_ok = 1;
+    }
+    // Fill the slices: the main thread fills the first slice
+    INIT_MUTEX(collover64dec_progress_mutex);
+    for (unsigned int k = 1; k < nfillers; k++) {
+        thrd[k] = ThreadObj_create(CollOver64DecFiller_thread, &fillers[k],
+            THREAD_ORD_HELPER + k);
+    }
+    CollOver64DecFiller_run(&fillers[0]);
+    int is_ok = fillers[0].is_ok;
+    for (unsigned int k = 1; k < nfillers; k++) {
+        ThreadObj_wait(&thrd[k]);
+        is_ok = is_ok && fillers[k].is_ok;
+    }
+    free(fillers);
+    free(thrd);
+    if (!is_ok) {
+        obj->intf->printf("  The generator is too flawed to return a truncated value\n");
+        return ndups_failure;
     }
     // Frequencies analysis
-    return collover64dec_calc_ndups(obj->intf, x, (size_t) opts->n);
+    return collover64dec_calc_ndups(obj->intf, buf, (size_t) opts->n, opts->nthreads);
 }
 
 /**
@@ -355,6 +481,7 @@ battery_collover64_get_options(const GeneratorInfo *gen,
 {
     const unsigned int log2_n = collover64dec_get_log2_n(intf);
     CollOver64DecimatedOptions opts = CollOver64DecimatedOptions_create(gen, log2_n, 2);
+    opts.nthreads = bat_opts->nthreads;
     if (strcmp(bat_opts->param, "")) {
         errno = 0;
         char *endptr;
@@ -417,12 +544,34 @@ BatteryExitCode battery_collover64_decimated(const GeneratorInfo *gen,
     }
     char *seed_key_txt = get_entropy_base64_seed();
     if (seed_key_txt != NULL) {
-        intf->printf("  Used seed:        _01_%s\n", seed_key_txt);
+        intf->printf("  Used seed:        _00_%s\n", seed_key_txt);
     } else {
         intf->printf("  Used seed:        none\n");
     }
     free(seed_key_txt);
     CollOver64DecimatedOptions_print(&opts, intf);
+    // Substreams for the parallel filling of the array
+    GeneratorState *substreams = NULL;
+    unsigned int nsubstreams = 0;
+    if (opts.nthreads > 1) {
+        static const unsigned int log2_dists[] = {128, 96, 64, 56, 0};
+        substreams = calloc(opts.nthreads, sizeof(GeneratorState));
+        if (substreams == NULL) {
+            fprintf(stderr, "***** battery_collover64_decimated: not enough memory *****\n");
+            exit(EXIT_FAILURE);
+        }
+        const unsigned int log2_dist = GeneratorState_create_substreams(
+            substreams, opts.nthreads, gen, intf, log2_dists);
+        if (log2_dist != 0) {
+            nsubstreams = opts.nthreads;
+            intf->printf("  Filling threads:  %u (substreams are 2^%u values apart)\n",
+                nsubstreams, log2_dist);
+        } else {
+            intf->printf("  Filling threads:  1 (the generator doesn't support jumps)\n");
+            free(substreams);
+            substreams = NULL;
+        }
+    }
 
     TestResults ans = TestResults_create("collover64dec");
     ans.x = 0.0;
@@ -434,7 +583,8 @@ BatteryExitCode battery_collover64_decimated(const GeneratorInfo *gen,
         lambda += CollOver64DecimatedOptions_calc_lambda(&opts);
         n_total += CollOver64DecimatedOptions_calc_nvalues_raw(&opts);
         intf->printf("--- Iter %u of %u: ", i + 1, opts.niters_max);
-        ans.x += (double) collover64dec_test_ndups(&obj, &opts, buf);
+        ans.x += (double) collover64dec_test_ndups(&obj, &opts, buf,
+            substreams, nsubstreams);
         collover64dec_update_pvalue(&ans, lambda, n_total, intf);
         snprintf_elapsed_time(strbuf, 15, (unsigned long long) (time(NULL) - tic));
         intf->printf("  Time elapsed: %s\n", strbuf);
@@ -445,6 +595,10 @@ BatteryExitCode battery_collover64_decimated(const GeneratorInfo *gen,
             break;
         }
     }
+    for (unsigned int k = 0; k < nsubstreams; k++) {
+        GeneratorState_destruct(&substreams[k]);
+    }
+    free(substreams);
     GeneratorState_destruct(&obj);
     free(buf);
     return exitcode;
@@ -557,12 +711,12 @@ BatteryExitCode battery_blockfreq(const GeneratorInfo *gen, const CallerAPI *int
     while (is_ok) {
         if (gen->nbits == 64) {
             for (size_t i = 0; i < block_size; i++) {
-                const uint64_t u = obj.gi->get_bits(obj.state);
+                const uint64_t u = GeneratorState_get_bits(&obj);
                 BlockFrequency_count(&freq, u, 8);
             }
         } else {
             for (size_t i = 0; i < block_size; i++) {
-                const uint64_t u = obj.gi->get_bits(obj.state);
+                const uint64_t u = GeneratorState_get_bits(&obj);
                 BlockFrequency_count(&freq, u, 4);
             }
         }
@@ -669,7 +823,7 @@ static void Ising2DLattice_flip_wolff_internal(Ising2DLattice *obj, size_t ind,
     // Go to neighbours
     for (size_t i = 0; i < 4; i++) {
         size_t nn_ind = obj->nn[ind].inds[i];
-        uint64_t rnd = gs->gi->get_bits(gs->state);
+        uint64_t rnd = GeneratorState_get_bits(gs);
         if (obj->s[nn_ind] == s0 && rnd <= p_int) {
             Ising2DLattice_flip_wolff_internal(obj, nn_ind, s0, gs, p_int);
         }
@@ -697,7 +851,7 @@ void Ising2DLattice_flip_wolff(Ising2DLattice *obj, size_t ind, GeneratorState *
 static inline size_t
 Ising2DLattice_rand_index(Ising2DLattice *obj, GeneratorState *gs)
 {
-    return (size_t) (gs->gi->get_bits(gs->state) % obj->N);
+    return (size_t) (GeneratorState_get_bits(gs) % obj->N);
 }
 
 /**
@@ -726,7 +880,7 @@ void Ising2DLattice_pass_metropolis(Ising2DLattice *obj, GeneratorState *gs)
         if (dE < 0) {
             obj->s[i] = (int8_t) (-obj->s[i]);
         } else {
-            if (n_same_to_p_int[n_same] > gs->gi->get_bits(gs->state)) {
+            if (n_same_to_p_int[n_same] > GeneratorState_get_bits(gs)) {
                 obj->s[i] = (int8_t) (-obj->s[i]);
             }
         }
@@ -870,17 +1024,40 @@ static double calc_usphere_volplus(unsigned int ndims)
     return exp(n_half * log(M_PI) - lgamma(1.0 + n_half) - ndims*log(2.0));
 }
 
+/**
+ * @brief Unit sphere volume test kernel: counts points inside the sphere.
+ */
+static int unit_sphere_volume_test_kernel(GeneratorState *gs,
+    unsigned long long *n_inside, unsigned long long npoints, const void *udata)
+{
+    const UnitSphereOptions *opts = udata;
+    const double tof_coeff = pow(2.0, -((int) gs->gi->nbits));
+    unsigned long long n = 0;
+    for (unsigned long long i = 0; i < npoints; i++) {
+        double d = 0.0;
+        for (unsigned int j = 0; j < opts->ndims; j++) {
+            const double x = (double) GeneratorState_get_bits(gs) * tof_coeff;
+            d += x * x;
+        }
+        if (d <= 1.0) {
+            n++;
+        }
+    }
+    *n_inside += n;
+    return 1;
+}
+
 /**
  * @brief This test is based on computation of n-dimensional (n >= 2)
  * (hyper)sphere volume by means of Monte-Carlo method.
  * @details This test is not very sensitive and catches only some rare low-grade
  * generators, e.g. RANDU and shr3 (xorshift32). It is useful for educational
- * purposes and as a component of performance benchmarks.
+ * purposes and as a component of performance benchmarks. Supports the
+ * split/merge mode.
  */
 TestResults unit_sphere_volume_test(GeneratorState *gs, const UnitSphereOptions *opts)
 {
-    const double tof_coeff = pow(2.0, -((int) gs->gi->nbits));
-    long long n_inside = 0;
+    unsigned long long n_inside_cnt = 0;
     TestResults ans = TestResults_create("usphere");
     if (opts->ndims < 2 || opts->ndims > 20 || opts->npoints < 1000) {
         return ans;
@@ -890,16 +1067,9 @@ TestResults unit_sphere_volume_test(GeneratorState *gs, const UnitSphereOptions
         opts->ndims, opts->npoints,
         log10((double) opts->npoints),
         sr_log2((double) opts->npoints));
-    for (unsigned long long i = 0; i < opts->npoints; i++) {
-        double d = 0.0;
-        for (unsigned int j = 0; j < opts->ndims; j++) {
-            const double x = (double) gs->gi->get_bits(gs->state) * tof_coeff;
-            d += x * x;
-        }
-        if (d <= 1.0) {
-            n_inside++;
-        }
-    }
+    GeneratorState_collect_counts(gs, unit_sphere_volume_test_kernel, opts,
+        &n_inside_cnt, 1, opts->npoints);
+    const long long n_inside = (long long) n_inside_cnt;
     const double v_theor = calc_usphere_volplus(opts->ndims);
     const double v_num = (double) n_inside / (double) opts->npoints;
     const double s_theor = sqrt((double) opts->npoints * v_theor * (1.0 - v_theor));
@@ -926,6 +1096,16 @@ TestResults unit_sphere_volume_test_wrap(GeneratorState *gs, const void *udata)
     return unit_sphere_volume_test(gs, udata);
 }
 
+//////////////////////////////////////////////////////
+///// Properties of tests for the battery runner /////
+//////////////////////////////////////////////////////
+
+OPTIONS_SCALE_FUNC_TPL(UnitSphereOptions, npoints)
+
+const TestTraits unit_sphere_volume_test_traits = {
+    TEST_TRAITS_SCALER(UnitSphereOptions)
+};
+
 
 /////////////////////
 ///// Batteries /////
@@ -939,9 +1119,9 @@ BatteryExitCode battery_ising(const GeneratorInfo *gen, const CallerAPI *intf,
         wolff = {.sample_len = 5000000, .nsamples = 20, .algorithm = ISING_WOLFF};
     
     static const TestDescription tests[] = {
-        {"ising16_metropolis", ising2d_test_wrap, &metr},
-        {"ising16_wolff",      ising2d_test_wrap, &wolff},
-        {NULL, NULL, NULL}
+        {"ising16_metropolis", ising2d_test_wrap, &metr, 60, NULL},
+        {"ising16_wolff",      ising2d_test_wrap, &wolff, 60, NULL},
+        {NULL, NULL, NULL, 0, NULL}
     };
     const TestsBattery bat = {
         "ising", tests
@@ -970,15 +1150,15 @@ BatteryExitCode battery_unit_sphere_volume(const GeneratorInfo *gen, const Calle
 
 
     static const TestDescription tests[] = {
-        {"usphere_2d", unit_sphere_volume_test_wrap, &usphere_2d},
-        {"usphere_3d", unit_sphere_volume_test_wrap, &usphere_3d},
-        {"usphere_4d", unit_sphere_volume_test_wrap, &usphere_4d},
-        {"usphere_5d", unit_sphere_volume_test_wrap, &usphere_5d},
-        {"usphere_6d", unit_sphere_volume_test_wrap, &usphere_6d},
-        {"usphere_10d", unit_sphere_volume_test_wrap, &usphere_10d},
-        {"usphere_12d", unit_sphere_volume_test_wrap, &usphere_12d},
-        {"usphere_15d", unit_sphere_volume_test_wrap, &usphere_15d},
-        {NULL, NULL, NULL}
+        {"usphere_2d", unit_sphere_volume_test_wrap, &usphere_2d, 6, &unit_sphere_volume_test_traits},
+        {"usphere_3d", unit_sphere_volume_test_wrap, &usphere_3d, 9, &unit_sphere_volume_test_traits},
+        {"usphere_4d", unit_sphere_volume_test_wrap, &usphere_4d, 12, &unit_sphere_volume_test_traits},
+        {"usphere_5d", unit_sphere_volume_test_wrap, &usphere_5d, 15, &unit_sphere_volume_test_traits},
+        {"usphere_6d", unit_sphere_volume_test_wrap, &usphere_6d, 18, &unit_sphere_volume_test_traits},
+        {"usphere_10d", unit_sphere_volume_test_wrap, &usphere_10d, 30, &unit_sphere_volume_test_traits},
+        {"usphere_12d", unit_sphere_volume_test_wrap, &usphere_12d, 36, &unit_sphere_volume_test_traits},
+        {"usphere_15d", unit_sphere_volume_test_wrap, &usphere_15d, 45, &unit_sphere_volume_test_traits},
+        {NULL, NULL, NULL, 0, NULL}
     };
     const TestsBattery bat = {
         "unitsphere", tests
@@ -1,6 +1,40 @@
 /**
  * @file fileio.c
- * @brief Implementation of PRNG based on reading binary data from stdin.
+ * @brief Implementation of PRNG based on reading binary data from stdin
+ * or from a file.
+ * @details Three ways of reading are supported:
+ *
+ * 1. Memory mapped files (POSIX only): the whole file is mapped into
+ *    the address space, no copying is required.
+ * 2. Reading by the separate thread into the lane buffers: the thread
+ *    reads the next chunks while the battery processes the current ones.
+ *    Used for stdin (including pipes) and for files that cannot be mapped.
+ * 3. Reading in the same thread: used if there is no multithreading API.
+ *
+ * The input is divided into 4 MiB chunks that are distributed among
+ * \f$ N \f$ lanes: the \f$ i \f$-th chunk always goes to the lane
+ * \f$ i \bmod N \f$. Each lane is consumed by one worker thread (the lane
+ * index is the worker index, the main thread uses the lane 0), generator
+ * states of the thread continue the data of its lane, so no bytes are lost
+ * and no locks are required for reading. Together with the static schedule
+ * of tests (see `BatteryOptions`) it makes the data consumed by each test
+ * independent of the threads timing: the results are reproducible for
+ * the same input and number of threads. Values that were read into
+ * the block buffers of GeneratorState but not used by tests are not
+ * counted as consumed.
+ *
+ * If the lane of a memory mapped file is exhausted then its thread takes
+ * over the unread chunks of the lane of a finished thread (and waits for
+ * the finish of other threads if there are no such lanes yet), so the whole
+ * file can be used. The data consumed after the take-over depend on the
+ * order in which threads finish. Streams are read sequentially, so a lane
+ * is exhausted only at the end of the stream; chunks of the lanes of
+ * finished threads are skipped.
+ *
+ * The reader thread fills two buffers per lane in the order of chunks and
+ * waits if the next lane is full. Lanes of the finished worker threads are
+ * closed (their chunks are skipped), so the reader never waits for them.
+ *
  * @copyright
  * (c) 2024-2025 Alexey L. Voskov, Lomonosov Moscow State University.
  * alvoskov@gmail.com
@@ -9,40 +43,556 @@
  */
 #include "smokerand/fileio.h"
 #include "smokerand/specfuncs.h"
+#include "smokerand/threads_intf.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
-#define STDIN_COLLECTOR_BUFFER_SIZE 1024
+#if !defined(USE_LOADLIBRARY) && !defined(USE_PE32_DOS) && !defined(NO_POSIX) && !defined(__DJGPP__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(USE_PTHREADS) || defined(USE_WINTHREADS)
+#define USE_READER_THREAD
+#endif
+
+#define STDIN_COLLECTOR_BUFFER_SIZE (1 << 22)
+#define STDIN_COLLECTOR_LANE_NBUFFERS 2
+
+/**
+ * @brief A lane of input data: every \f$ N \f$-th chunk of the input
+ * consumed by one worker thread. It is the read position shared by all
+ * generator states of this thread.
+ * @details The lane buffers are used as a ring: the reader fills them in
+ * the order of chunks, the consumer takes them in the same order and
+ * returns the previous buffer when it takes the next one. Fields are
+ * written either only by the consumer or only by the reader; `nfree`
+ * and `nfull` semaphores pass the buffers between them.
+ */
+typedef struct StdinCollectorLane_ {
+    const uint8_t *ptr; ///< Current position inside the current chunk
+    const uint8_t *end; ///< End of the current chunk
+    const uint8_t *begin; ///< Beginning of the unaccounted part of the chunk
+    int has_buffer; ///< 1 - the current chunk is one of the lane buffers
+    unsigned int ind; ///< Lane index
+    unsigned long long nclaimed; ///< Number of chunks taken by the consumer
+    unsigned long long nposted; ///< Number of chunks posted by the reader
+    unsigned long long nbytes_consumed; ///< Bytes returned by the generators
+    uint8_t *buffers[STDIN_COLLECTOR_LANE_NBUFFERS]; ///< Buffers for the stream
+    size_t buf_len[STDIN_COLLECTOR_LANE_NBUFFERS]; ///< Number of bytes in buffers
+    int is_closed; ///< The consumer thread is finished (under `src_mutex`)
+    int is_adopted; ///< The lane is taken over by another thread (under `src_mutex`)
+    struct StdinCollectorLane_ *next; ///< Lane taken over after the exhaustion of this one
+#ifdef USE_READER_THREAD
+    Semaphore nfree; ///< Number of buffers available to the reader
+    Semaphore nfull; ///< Number of buffers available to the consumer
+#endif
+} StdinCollectorLane;
 
-static unsigned long long nbytes_total = 0;
+/**
+ * @brief Input source shared by all generator states (and all threads).
+ */
+typedef struct {
+    FILE *fp; ///< Input stream (NULL for memory mapped files)
+    StdinCollectorLane *lanes; ///< Lanes of the input data
+    unsigned int nlanes; ///< Number of lanes
+    unsigned int nopen; ///< Number of lanes that are not closed
+    unsigned int nwaiting; ///< Number of exhausted lanes waiting for the take-over
+    uint8_t *scratch; ///< Buffer for chunks of the closed lanes
+    int is_closing; ///< The reader thread must be stopped
+    const uint8_t *map; ///< Memory mapped file (or NULL)
+    size_t map_len; ///< Length of the memory mapped file
+    unsigned long long nbytes_read; ///< Bytes obtained from the source
+    unsigned long long nbytes_skipped; ///< Bytes of the closed lanes skipped by the reader
+    unsigned long long nbytes_available; ///< Input size (0 if unknown)
+    const char *method; ///< Reading method (for reports)
+#ifdef USE_READER_THREAD
+    ThreadObj reader;
+    int has_reader; ///< 1 - the reader thread was started
+    Semaphore lane_closed; ///< Wakes up the lanes waiting for the take-over
+#endif
+} StdinCollectorSource;
 
+/**
+ * @brief Generator state: the lane of the thread that created it.
+ */
 typedef struct {
-    uint8_t buffer[STDIN_COLLECTOR_BUFFER_SIZE];
-    size_t pos;
+    StdinCollectorSource *src;
+    StdinCollectorLane *lane;
 } StdinCollector;
 
+static StdinCollectorSource src;
+static int src_is_open = 0;
+static const char *src_filename = NULL;
+DECLARE_MUTEX(src_mutex)
+
+/**
+ * @brief Reads the whole buffer from the stream; short read is possible
+ * only at the end of stream.
+ * @return Number of bytes read.
+ */
+static size_t StdinCollectorSource_read(StdinCollectorSource *obj, uint8_t *buf)
+{
+    size_t nbytes = 0;
+    while (nbytes < STDIN_COLLECTOR_BUFFER_SIZE) {
+        const size_t len = fread(buf + nbytes, 1,
+            STDIN_COLLECTOR_BUFFER_SIZE - nbytes, obj->fp);
+        if (len == 0) {
+            break;
+        }
+        nbytes += len;
+    }
+    obj->nbytes_read += nbytes;
+    return nbytes;
+}
+
+#ifdef USE_READER_THREAD
+/**
+ * @brief Waits for an empty buffer of the lane. Returns 0 if the lane is
+ * closed (its chunks must be skipped) or the source is closing.
+ */
+static int StdinCollectorSource_wait_lane(StdinCollectorSource *obj,
+    StdinCollectorLane *lane)
+{
+    MUTEX_LOCK(src_mutex, "StdinCollectorSource_wait_lane");
+    int is_open = !lane->is_closed && !obj->is_closing;
+    MUTEX_UNLOCK(src_mutex);
+    if (!is_open) {
+        return 0;
+    }
+    // Closing of the lane or of the source wakes the reader up
+    Semaphore_wait(&lane->nfree);
+    MUTEX_LOCK(src_mutex, "StdinCollectorSource_wait_lane");
+    is_open = !lane->is_closed && !obj->is_closing;
+    MUTEX_UNLOCK(src_mutex);
+    return is_open;
+}
+
+/**
+ * @brief Posts the filled buffer (or the empty one at the end of stream)
+ * to the lane consumer.
+ */
+static void StdinCollectorLane_post(StdinCollectorLane *lane, size_t len)
+{
+    lane->buf_len[lane->nposted % STDIN_COLLECTOR_LANE_NBUFFERS] = len;
+    lane->nposted++;
+    Semaphore_post(&lane->nfull);
+}
 
-static void StdinCollector_fill_buffer(StdinCollector *obj)
+/**
+ * @brief Reader thread: reads chunks and sends the i-th chunk to the lane
+ * i mod N. Chunks of the closed lanes are read into the scratch buffer
+ * and skipped. At the end of stream the empty chunk is sent to each lane.
+ */
+static ThreadRetVal THREADFUNC_SPEC StdinCollectorSource_reader(void *udata)
 {
-    size_t nbytes = fread(obj->buffer, 1, STDIN_COLLECTOR_BUFFER_SIZE, stdin);
-    nbytes_total += nbytes;
-    obj->pos = 0;
-    if (nbytes != STDIN_COLLECTOR_BUFFER_SIZE) {
-        fprintf(stderr, "Reading from stdin failed");
+    StdinCollectorSource *obj = udata;
+    size_t len = STDIN_COLLECTOR_BUFFER_SIZE;
+    for (unsigned long long i = 0; len == STDIN_COLLECTOR_BUFFER_SIZE; i++) {
+        StdinCollectorLane *lane = &obj->lanes[i % obj->nlanes];
+        MUTEX_LOCK(src_mutex, "StdinCollectorSource_reader");
+        const int must_stop = obj->is_closing || obj->nopen == 0;
+        MUTEX_UNLOCK(src_mutex);
+        if (must_stop) {
+            return 0;
+        }
+        if (StdinCollectorSource_wait_lane(obj, lane)) {
+            len = StdinCollectorSource_read(obj,
+                lane->buffers[lane->nposted % STDIN_COLLECTOR_LANE_NBUFFERS]);
+            StdinCollectorLane_post(lane, len);
+        } else {
+            len = StdinCollectorSource_read(obj, obj->scratch);
+            obj->nbytes_skipped += len;
+        }
+    }
+    for (unsigned int i = 0; i < obj->nlanes; i++) {
+        StdinCollectorLane *lane = &obj->lanes[i];
+        if (StdinCollectorSource_wait_lane(obj, lane)) {
+            StdinCollectorLane_post(lane, 0);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Closes the lane of the finished worker thread: the reader won't
+ * wait for its consumer anymore, the lanes taken over by the thread are
+ * released and the unread chunks of all of them may be taken over by
+ * other threads. Called by threads_intf after the thread function of each
+ * thread (see ThreadObj_set_exit_handler).
+ */
+static void StdinCollectorSource_on_thread_exit(unsigned int ord)
+{
+    if (ord < 1 || ord > src.nlanes) { // Not a worker thread with the lane
+        return;
+    }
+    StdinCollectorLane *lane = &src.lanes[ord - 1];
+    MUTEX_LOCK(src_mutex, "StdinCollectorSource_on_thread_exit");
+    const int was_closed = lane->is_closed;
+    if (!was_closed) {
+        lane->is_closed = 1;
+        src.nopen--;
+    }
+    for (StdinCollectorLane *cur = lane; cur != NULL; ) {
+        StdinCollectorLane *next = cur->next;
+        cur->next = NULL;
+        cur->is_adopted = 0;
+        cur = next;
+    }
+    const unsigned int nwaiting = src.nwaiting;
+    MUTEX_UNLOCK(src_mutex);
+    if (!was_closed) {
+        Semaphore_post(&lane->nfree);
+    }
+    for (unsigned int i = 0; i < nwaiting; i++) {
+        Semaphore_post(&src.lane_closed);
+    }
+}
+#endif
+
+/**
+ * @brief Tries to map the file into the memory.
+ * @return 1 - success, 0 - the file must be read as a stream.
+ */
+static int StdinCollectorSource_map(StdinCollectorSource *obj, const char *filename)
+{
+#ifdef USE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (unsigned long long) st.st_size > (unsigned long long) (SIZE_MAX / 2)) {
+        close(fd);
+        return 0;
+    }
+    const size_t len = (size_t) st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+    (void) madvise(map, len, MADV_SEQUENTIAL);
+    obj->map = map;
+    obj->map_len = len;
+    obj->nbytes_read = len;
+    obj->nbytes_available = len;
+    obj->method = "memory mapped file";
+    return 1;
+#else
+    (void) obj; (void) filename;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Allocates the lanes and (for streams) their buffers.
+ */
+static void StdinCollectorSource_alloc_lanes(StdinCollectorSource *obj,
+    unsigned int nlanes)
+{
+    obj->nlanes = nlanes;
+    obj->nopen = nlanes;
+    obj->lanes = calloc(nlanes, sizeof(StdinCollectorLane));
+    if (obj->lanes == NULL) {
+        fprintf(stderr, "***** StdinCollectorSource_open: not enough memory *****\n");
         exit(EXIT_FAILURE);
     }
+    for (unsigned int i = 0; i < nlanes; i++) {
+        StdinCollectorLane *lane = &obj->lanes[i];
+        lane->ind = i;
+        for (unsigned int j = 0; obj->map == NULL && j < STDIN_COLLECTOR_LANE_NBUFFERS; j++) {
+            lane->buffers[j] = malloc(STDIN_COLLECTOR_BUFFER_SIZE);
+            if (lane->buffers[j] == NULL) {
+                fprintf(stderr, "***** StdinCollectorSource_open: not enough memory *****\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+#ifdef USE_READER_THREAD
+        Semaphore_init(&lane->nfree, STDIN_COLLECTOR_LANE_NBUFFERS);
+        Semaphore_init(&lane->nfull, 0);
+#endif
+    }
+}
+
+/**
+ * @brief Opens the input source: file (if `filename` is not NULL)
+ * or stdin.
+ * @param obj           Source to be initialized.
+ * @param filename      Name of the file or NULL for stdin.
+ * @param nlanes        Number of lanes for memory mapped files.
+ * @param nlanes_stream Number of lanes for streams.
+ */
+static void StdinCollectorSource_open(StdinCollectorSource *obj,
+    const char *filename, unsigned int nlanes, unsigned int nlanes_stream)
+{
+    memset(obj, 0, sizeof(StdinCollectorSource));
+    INIT_MUTEX(src_mutex);
+#ifdef USE_READER_THREAD
+    Semaphore_init(&obj->lane_closed, 0);
+#endif
+    if (filename != NULL && StdinCollectorSource_map(obj, filename)) {
+        StdinCollectorSource_alloc_lanes(obj, nlanes);
+#ifdef USE_READER_THREAD
+        if (obj->nlanes > 1) {
+            ThreadObj_set_exit_handler(StdinCollectorSource_on_thread_exit);
+        }
+#endif
+        return;
+    }
+    if (filename != NULL) {
+        obj->fp = fopen(filename, "rb");
+        if (obj->fp == NULL) {
+            fprintf(stderr, "Cannot open the file '%s'\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        if (fseek(obj->fp, 0, SEEK_END) == 0) {
+            const long len = ftell(obj->fp);
+            obj->nbytes_available = (len > 0) ? (unsigned long long) len : 0;
+        }
+        rewind(obj->fp);
+    } else {
+        set_bin_stdin();
+        obj->fp = stdin;
+    }
+#ifdef USE_READER_THREAD
+    StdinCollectorSource_alloc_lanes(obj, nlanes_stream);
+    obj->scratch = malloc(STDIN_COLLECTOR_BUFFER_SIZE);
+    if (obj->scratch == NULL) {
+        fprintf(stderr, "***** StdinCollectorSource_open: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    if (obj->nlanes > 1) {
+        ThreadObj_set_exit_handler(StdinCollectorSource_on_thread_exit);
+    }
+    obj->reader = ThreadObj_create(StdinCollectorSource_reader, obj,
+        THREAD_ORD_HELPER);
+    obj->has_reader = 1;
+    obj->method = "stream, reader thread";
+#else
+    (void) nlanes_stream;
+    StdinCollectorSource_alloc_lanes(obj, 1);
+    obj->method = "stream";
+#endif
+}
+
+/**
+ * @brief Closes the input source: stops the reader thread, unmaps
+ * the memory mapped file and frees the buffers.
+ */
+static void StdinCollectorSource_close(StdinCollectorSource *obj)
+{
+#ifdef USE_READER_THREAD
+    if (obj->has_reader) {
+        MUTEX_LOCK(src_mutex, "StdinCollectorSource_close");
+        obj->is_closing = 1;
+        MUTEX_UNLOCK(src_mutex);
+        for (unsigned int i = 0; i < obj->nlanes; i++) {
+            Semaphore_post(&obj->lanes[i].nfree);
+        }
+        ThreadObj_wait(&obj->reader);
+        obj->has_reader = 0;
+    }
+    ThreadObj_set_exit_handler(NULL);
+    Semaphore_destruct(&obj->lane_closed);
+#endif
+    for (unsigned int i = 0; i < obj->nlanes; i++) {
+        StdinCollectorLane *lane = &obj->lanes[i];
+        for (unsigned int j = 0; j < STDIN_COLLECTOR_LANE_NBUFFERS; j++) {
+            free(lane->buffers[j]);
+        }
+#ifdef USE_READER_THREAD
+        Semaphore_destruct(&lane->nfree);
+        Semaphore_destruct(&lane->nfull);
+#endif
+    }
+    free(obj->lanes);
+    free(obj->scratch);
+    obj->lanes = NULL;
+    obj->scratch = NULL;
+    obj->nlanes = 0;
+#ifdef USE_MMAP
+    if (obj->map != NULL) {
+        munmap((void *) obj->map, obj->map_len);
+        obj->map = NULL;
+    }
+#endif
+    if (obj->fp != NULL && obj->fp != stdin) {
+        fclose(obj->fp);
+    }
+    obj->fp = NULL;
+}
+
+/**
+ * @brief Takes the next chunk of the lane: the k-th chunk of the lane j
+ * is the chunk \f$ kN + j \f$ of the input. The previous buffer is
+ * returned to the reader. Returns the chunk with `ptr == end` if
+ * the input is exhausted.
+ */
+static void StdinCollectorLane_claim(StdinCollectorLane *lane,
+    StdinCollectorSource *source)
+{
+    lane->nbytes_consumed += (unsigned long long) (lane->ptr - lane->begin);
+    if (source->map != NULL) {
+        unsigned long long pos = (lane->nclaimed * source->nlanes + lane->ind) *
+            (unsigned long long) STDIN_COLLECTOR_BUFFER_SIZE;
+        size_t len = 0;
+        if (pos < source->map_len) {
+            len = (source->map_len - pos < STDIN_COLLECTOR_BUFFER_SIZE) ?
+                (size_t) (source->map_len - pos) : STDIN_COLLECTOR_BUFFER_SIZE;
+        } else {
+            pos = source->map_len;
+        }
+        lane->ptr = lane->begin = source->map + pos;
+        lane->end = lane->ptr + len;
+        lane->nclaimed++;
+        return;
+    }
+    const unsigned int ind = (unsigned int) (lane->nclaimed % STDIN_COLLECTOR_LANE_NBUFFERS);
+#ifdef USE_READER_THREAD
+    if (lane->has_buffer) {
+        Semaphore_post(&lane->nfree);
+    }
+    Semaphore_wait(&lane->nfull);
+#else
+    lane->buf_len[ind] = StdinCollectorSource_read(source, lane->buffers[ind]);
+#endif
+    lane->has_buffer = 1;
+    lane->ptr = lane->begin = lane->buffers[ind];
+    lane->end = lane->ptr + lane->buf_len[ind];
+    lane->nclaimed++;
+}
+
+/**
+ * @brief Checks if the lane of a memory mapped file has unread data:
+ * either in the current chunk or in the next chunks.
+ */
+static int StdinCollectorLane_has_data(const StdinCollectorLane *lane,
+    const StdinCollectorSource *source)
+{
+    const unsigned long long pos = (lane->nclaimed * source->nlanes + lane->ind) *
+        (unsigned long long) STDIN_COLLECTOR_BUFFER_SIZE;
+    return lane->ptr < lane->end || pos < source->map_len;
+}
+
+/**
+ * @brief Gives the exhausted lane of a memory mapped file the lane of
+ * a finished thread with unread data: it becomes the `next` lane of
+ * the exhausted one. Waits for the finish of other threads if there are
+ * no such lanes yet.
+ * @return 1 - success, 0 - there are no unread data in all lanes (or
+ * the input is a stream).
+ */
+static int StdinCollectorSource_adopt_lane(StdinCollectorSource *obj,
+    StdinCollectorLane *lane)
+{
+#ifdef USE_READER_THREAD
+    if (obj->map == NULL || obj->nlanes < 2) {
+        return 0;
+    }
+    MUTEX_LOCK(src_mutex, "StdinCollectorSource_adopt_lane");
+    obj->nwaiting++;
+    for (;;) {
+        for (unsigned int i = 0; i < obj->nlanes; i++) {
+            StdinCollectorLane *cand = &obj->lanes[i];
+            if (cand->is_closed && !cand->is_adopted &&
+                StdinCollectorLane_has_data(cand, obj)) {
+                cand->is_adopted = 1;
+                lane->next = cand;
+                obj->nwaiting--;
+                MUTEX_UNLOCK(src_mutex);
+                return 1;
+            }
+        }
+        // All running threads wait for the take-over: no data will be released
+        if (obj->nwaiting == obj->nopen) {
+            obj->nwaiting--;
+            MUTEX_UNLOCK(src_mutex);
+            return 0;
+        }
+        MUTEX_UNLOCK(src_mutex);
+        Semaphore_wait(&obj->lane_closed);
+        MUTEX_LOCK(src_mutex, "StdinCollectorSource_adopt_lane");
+    }
+#else
+    (void) obj; (void) lane;
+    return 0;
+#endif
 }
 
+/**
+ * @brief Terminates the program if the input is exhausted.
+ */
+static void StdinCollectorSource_exhausted(const StdinCollectorSource *obj)
+{
+    if (obj->map != NULL) {
+        fprintf(stderr, "Input data are exhausted (all %llu bytes of the file were used)\n",
+            obj->nbytes_read);
+    } else if (obj->nbytes_skipped > 0) {
+        fprintf(stderr, "Input data are exhausted (%llu bytes were read, %llu of them "
+            "were skipped in the lanes of finished threads; use fewer threads)\n",
+            obj->nbytes_read, obj->nbytes_skipped);
+    } else {
+        fprintf(stderr, "Input data are exhausted (%llu bytes were read)\n",
+            obj->nbytes_read);
+    }
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Replaces the exhausted chunk by the new one. Goes to the lanes
+ * taken over by the thread after the exhaustion of its own lane. Terminates
+ * the program if the input is exhausted.
+ * @return The lane with the new chunk.
+ */
+static StdinCollectorLane *StdinCollector_next_chunk(StdinCollector *obj,
+    size_t value_size)
+{
+    StdinCollectorLane *lane = obj->lane;
+    while ((size_t) (lane->end - lane->ptr) < value_size) {
+        if (lane->next != NULL) { // Taken over by another state of the thread
+            lane = lane->next;
+            continue;
+        }
+        StdinCollectorLane_claim(lane, obj->src);
+        if ((size_t) (lane->end - lane->ptr) < value_size &&
+            !StdinCollectorSource_adopt_lane(obj->src, lane)) {
+            StdinCollectorSource_exhausted(obj->src);
+        }
+    }
+    obj->lane = lane;
+    return lane;
+}
+
+/**
+ * @brief Creates the generator state that reads the lane of the current
+ * thread: the lane with the worker index for worker threads and the lane 0
+ * for the main thread.
+ */
 static void *StdinCollector_create(const GeneratorInfo *gi, const CallerAPI *intf)
 {
+    (void) gi;
+    if (!src_is_open) {
+        StdinCollector_open(1, 1);
+    }
+    const unsigned int ord = ThreadObj_current().ord;
     StdinCollector *obj = intf->malloc(sizeof(StdinCollector));
-    (void) *gi;
-    obj->pos = STDIN_COLLECTOR_BUFFER_SIZE;
-    set_bin_stdin();
-    return (void *) obj;
+    obj->src = &src;
+    obj->lane = &src.lanes[(ord >= 1 && ord <= NTHREADS_MAX) ?
+        (ord - 1) % src.nlanes : 0];
+    return obj;
 }
 
+/**
+ * @brief Destroys the generator state. The unused part of the current
+ * chunk is left in the lane for the next states of the same thread.
+ */
 static void StdinCollector_free(void *state, const GeneratorInfo *gi, const CallerAPI *intf)
 {
     (void) gi;
@@ -56,13 +606,13 @@ static void StdinCollector_free(void *state, const GeneratorInfo *gi, const Call
 static inline uint64_t get_bits32_raw(void *state)
 {
     StdinCollector *obj = state;
-    if (obj->pos >= STDIN_COLLECTOR_BUFFER_SIZE) {
-        StdinCollector_fill_buffer(obj);
-        obj->pos = 0;
+    StdinCollectorLane *lane = obj->lane;
+    if ((size_t) (lane->end - lane->ptr) < sizeof(uint32_t)) {
+        lane = StdinCollector_next_chunk(obj, sizeof(uint32_t));
     }
-    void *ptr = (void *) (obj->buffer + obj->pos);
-    uint32_t x = *( (uint32_t *) ptr );
-    obj->pos += sizeof(uint32_t);
+    uint32_t x;
+    memcpy(&x, lane->ptr, sizeof(uint32_t));
+    lane->ptr += sizeof(uint32_t);
     return x;
 }
 
@@ -87,14 +637,14 @@ static uint64_t get_bits32(void *state)
 static inline uint64_t get_bits64_raw(void *state)
 {
     StdinCollector *obj = state;
-    if (obj->pos >= STDIN_COLLECTOR_BUFFER_SIZE) {
-        StdinCollector_fill_buffer(obj);
-        obj->pos = 0;
+    StdinCollectorLane *lane = obj->lane;
+    if ((size_t) (lane->end - lane->ptr) < sizeof(uint64_t)) {
+        lane = StdinCollector_next_chunk(obj, sizeof(uint64_t));
     }
-    void *ptr = (void *) (obj->buffer + obj->pos);
-    uint64_t x = *( (uint64_t *) ptr );
-    obj->pos += sizeof(uint64_t);
-    return x;    
+    uint64_t x;
+    memcpy(&x, lane->ptr, sizeof(uint64_t));
+    lane->ptr += sizeof(uint64_t);
+    return x;
 }
 
 static uint64_t get_sum64(void *state, size_t len)
@@ -116,10 +666,104 @@ static uint64_t get_bits64(void *state)
 ///// Interface /////
 /////////////////////
 
+/**
+ * @brief Opens the input source (stdin or the file). Must be called before
+ * creation of generator states in multithreaded mode.
+ * @details Each lane must be consumed by its own worker thread (the worker
+ * index is the lane index), and tests must be assigned to threads by
+ * the static schedule. Streams are read sequentially, so their lanes must
+ * be consumed simultaneously: all worker threads must be started at once,
+ * e.g. in the pipelined and progressive modes only one lane may be used.
+ * @param nlanes         Number of lanes for memory mapped files.
+ * @param nlanes_stream  Number of lanes for streams.
+ * @return Number of lanes that will be used.
+ */
+unsigned int StdinCollector_open(unsigned int nlanes, unsigned int nlanes_stream)
+{
+    if (nlanes < 1) {
+        nlanes = 1;
+    } else if (nlanes > NTHREADS_MAX) {
+        nlanes = NTHREADS_MAX;
+    }
+    if (nlanes_stream < 1) {
+        nlanes_stream = 1;
+    } else if (nlanes_stream > nlanes) {
+        nlanes_stream = nlanes;
+    }
+    if (!src_is_open) {
+        StdinCollectorSource_open(&src, src_filename, nlanes, nlanes_stream);
+        src_is_open = 1;
+    }
+    return src.nlanes;
+}
+
+/**
+ * @brief Closes the input source opened by StdinCollector_open. Must be
+ * called after destruction of all generator states.
+ */
+void StdinCollector_close(void)
+{
+    if (src_is_open) {
+        StdinCollectorSource_close(&src);
+        src_is_open = 0;
+    }
+}
+
+/**
+ * @brief Returns the number of bytes consumed by tests, i.e. the sum
+ * of GeneratorState_get_nvalues of all generator states. Must be called
+ * after the finish of worker threads. Bytes read into
+ * the block buffers of GeneratorState but not used by tests are excluded.
+ */
+unsigned long long StdinCollector_get_nbytes_consumed(void)
+{
+    if (!src_is_open) {
+        return 0;
+    }
+    unsigned long long nbytes = 0;
+    for (unsigned int i = 0; i < src.nlanes; i++) {
+        const StdinCollectorLane *lane = &src.lanes[i];
+        nbytes += lane->nbytes_consumed +
+            (unsigned long long) (lane->ptr - lane->begin);
+    }
+    return nbytes - GeneratorState_get_nbytes_unused();
+}
+
+/**
+ * @brief Returns the size of the input file or 0 if it is unknown
+ * (e.g. for stdin).
+ */
+unsigned long long StdinCollector_get_nbytes_available(void)
+{
+    return src_is_open ? src.nbytes_available : 0;
+}
+
+
 void StdinCollector_print_report(void)
 {
+    const unsigned long long nbytes_total = StdinCollector_get_nbytes_consumed();
     printf("  Bytes processed: %llu (2^%.2f, 10^%.2f)\n", nbytes_total,
         sr_log2((double) nbytes_total), log10((double) nbytes_total));
+    if (src_is_open && src.nbytes_available > 0) {
+        printf("  Bytes available: %llu (%.2f %% processed)\n",
+            src.nbytes_available,
+            100.0 * (double) nbytes_total / (double) src.nbytes_available);
+    }
+}
+
+/**
+ * @brief Prints information about the input source: its size and
+ * the reading method.
+ */
+void StdinCollector_print_source_info(void)
+{
+    const unsigned long long nbytes = StdinCollector_get_nbytes_available();
+    printf("Input source:      %s (%s)\n",
+        (src_filename != NULL) ? src_filename : "stdin", src.method);
+    if (nbytes > 0) {
+        printf("Input size, bytes: %llu (2^%.2f)\n",
+            nbytes, sr_log2((double) nbytes));
+    }
 }
 
 
@@ -130,12 +774,12 @@ GeneratorInfo StdinCollector_get_info(StdinCollectorType type)
         .get_bits = NULL, .get_sum = NULL, .self_test = NULL,
         .parent = NULL};
     if (type == stdin_collector_32bit) {
-        gen.name = "stdin32";
+        gen.name = (src_filename == NULL) ? "stdin32" : "file32";
         gen.get_bits = get_bits32;
         gen.get_sum = get_sum32;
         gen.nbits = 32;
     } else if (type == stdin_collector_64bit) {
-        gen.name = "stdin64";
+        gen.name = (src_filename == NULL) ? "stdin64" : "file64";
         gen.get_bits = get_bits64;
         gen.get_sum = get_sum64;
         gen.nbits = 64;
@@ -145,3 +789,15 @@ GeneratorInfo StdinCollector_get_info(StdinCollectorType type)
     }
     return gen;
 }
+
+/**
+ * @brief Returns the generator that reads data from the binary file.
+ * @param type      32-bit or 64-bit generator.
+ * @param filename  Name of the file. Must be valid during the
+ *                  generator lifetime.
+ */
+GeneratorInfo StdinCollector_get_file_info(StdinCollectorType type, const char *filename)
+{
+    src_filename = filename;
+    return StdinCollector_get_info(type);
+}
@@ -11,8 +11,12 @@
  */
 #include "smokerand/hwtests.h"
 #include "smokerand/specfuncs.h"
+#ifdef __AVX2__
+    #include "smokerand/x86exts.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <float.h>
 
@@ -20,91 +24,235 @@
 ///// hamming_ot test implementation /////
 //////////////////////////////////////////
 
-typedef struct _ByteStreamGenerator {
-    const GeneratorInfo *gen; ///< Used generator
-    void *state; ///< PRNG state
-    uint64_t buffer; ///< Buffer with PRNG raw data
-    size_t nbytes; ///< Number of bytes returned by the generator
-    size_t bytes_left; ///< Number of bytes left in the buffer
-    uint8_t (*get_byte)(struct _ByteStreamGenerator *obj);
-} ByteStreamGenerator;
+/**
+ * @brief Number of codes (tuple digits) processed by the Hamming weights
+ * overlapping tuples tests at once. Must be divisible by 8.
+ */
+#define HAMMING_OT_BLOCK_LEN 1024
+
+/**
+ * @brief Number of codes (digits) in the overlapping tuple.
+ */
+#define HAMMING_OT_TUPLE_SIZE 9
 
+/**
+ * @brief Maximal number of increments of 32-bit tuples counters before
+ * spilling them into the table of tuples.
+ */
+#define HAMMING_OT_SPILL_PERIOD (1ull << 31)
 
-uint8_t ByteStreamGenerator_getbyte(ByteStreamGenerator *obj)
+/**
+ * @brief Converts bytes to the codes of their Hamming weights: portable
+ * version, also processes the tail of the AVX2 one.
+ * @param codes       Output buffer for codes.
+ * @param bytes       Input buffer with bytes.
+ * @param n           Number of bytes.
+ * @param hw_to_code  Table for conversion of Hamming weights (0-8) to codes.
+ */
+void hamming_bytes_to_codes_portable(uint8_t *codes, const uint8_t *bytes,
+    size_t n, const uint8_t *hw_to_code)
 {
-    if (obj->bytes_left == 0) {
-        obj->buffer = obj->gen->get_bits(obj->state);
-        obj->bytes_left = obj->nbytes;
+    for (size_t i = 0; i < n; i++) {
+        codes[i] = hw_to_code[get_byte_hamming_weight(bytes[i])];
     }
-    uint8_t out = obj->buffer & 0xFF;
-    obj->buffer >>= 8;
-    obj->bytes_left--;
-    return out;
 }
 
-uint8_t ByteStreamGenerator_getbyte_low1(ByteStreamGenerator *obj)
+/**
+ * @brief Converts bytes to the codes of their Hamming weights. The AVX2
+ * version processes 32 bytes at once: Hamming weights are computed by
+ * `vpshufb` lookups for nibbles and converted to codes by one more lookup.
+ * Its output must be identical to hamming_bytes_to_codes_portable.
+ * @param codes       Output buffer for codes.
+ * @param bytes       Input buffer with bytes.
+ * @param n           Number of bytes.
+ * @param hw_to_code  Table for conversion of Hamming weights (0-8) to codes.
+ */
+void hamming_bytes_to_codes(uint8_t *codes, const uint8_t *bytes,
+    size_t n, const uint8_t *hw_to_code)
 {
-    if (obj->bytes_left == 0) {
-        obj->buffer = 0;
-        for (int i = 0; i < 64; i++) {
-            obj->buffer = (obj->buffer >> 1) | (obj->gen->get_bits(obj->state) << 63);
-        }
-        obj->bytes_left = 8;
+    size_t i = 0;
+#ifdef __AVX2__
+    char lut[16] = {0};
+    for (int j = 0; j <= 8; j++) {
+        lut[j] = (char) hw_to_code[j];
     }
-    uint8_t out = obj->buffer & 0xFF;
-    obj->buffer >>= 8;
-    obj->bytes_left--;
-    return out;
+    const __m256i lut_code = _mm256_setr_epi8(
+        lut[0], lut[1], lut[2],  lut[3],  lut[4],  lut[5],  lut[6],  lut[7],
+        lut[8], lut[9], lut[10], lut[11], lut[12], lut[13], lut[14], lut[15],
+        lut[0], lut[1], lut[2],  lut[3],  lut[4],  lut[5],  lut[6],  lut[7],
+        lut[8], lut[9], lut[10], lut[11], lut[12], lut[13], lut[14], lut[15]);
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *) (const void *) (bytes + i));
+        const __m256i hw = mm256_popcnt_epi8_def(v);
+        _mm256_storeu_si256((__m256i *) (void *) (codes + i),
+            _mm256_shuffle_epi8(lut_code, hw));
+    }
+#endif
+    hamming_bytes_to_codes_portable(codes + i, bytes + i, n - i, hw_to_code);
 }
 
-uint8_t ByteStreamGenerator_getbyte_low8(ByteStreamGenerator *obj)
+/**
+ * @brief Returns the sum of Hamming weights of `a[i] ^ b[i]` values:
+ * portable version, also processes the tail of the AVX2 one.
+ */
+unsigned int hamming_xorsum_u64_portable(const uint64_t *a,
+    const uint64_t *b, size_t n)
 {
-    if (obj->bytes_left == 0) {
-        obj->buffer = 0;
-        for (int i = 0; i < 8; i++) {
-            obj->buffer = (obj->buffer >> 8) | (obj->gen->get_bits(obj->state) << 56);
-        }
-        obj->bytes_left = 8;
+    unsigned int hw = 0;
+    for (size_t i = 0; i < n; i++) {
+        hw += get_uint64_hamming_weight(a[i] ^ b[i]);
     }
-    uint8_t out = obj->buffer & 0xFF;
-    obj->buffer >>= 8;
-    obj->bytes_left--;
-    return out;
+    return hw;
 }
 
+/**
+ * @brief Returns the sum of Hamming weights of `a[i] ^ b[i]` values.
+ * The AVX2 version processes 4 values at once, its output must be
+ * identical to hamming_xorsum_u64_portable.
+ */
+unsigned int hamming_xorsum_u64(const uint64_t *a, const uint64_t *b, size_t n)
+{
+    unsigned int hw = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    if (n >= 4) {
+        __m256i sum = _mm256_setzero_si256();
+        uint64_t sum_lanes[4];
+        for (; i + 4 <= n; i += 4) {
+            const __m256i ai = _mm256_loadu_si256((const __m256i *) (const void *) (a + i));
+            const __m256i bi = _mm256_loadu_si256((const __m256i *) (const void *) (b + i));
+            sum = _mm256_add_epi64(sum, mm256_popcnt_epi64_def(_mm256_xor_si256(ai, bi)));
+        }
+        _mm256_storeu_si256((__m256i *) (void *) sum_lanes, sum);
+        hw = (unsigned int) (sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3]);
+    }
+#endif
+    return hw + hamming_xorsum_u64_portable(a + i, b + i, n - i);
+}
 
+/**
+ * @brief Returns the sum of Hamming weights of `x[i]` values.
+ * The AVX2 version processes 4 values at once.
+ */
+static inline unsigned int hamming_sum_u64(const uint64_t *x, size_t n)
+{
+    unsigned int hw = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    if (n >= 4) {
+        __m256i sum = _mm256_setzero_si256();
+        uint64_t sum_lanes[4];
+        for (; i + 4 <= n; i += 4) {
+            const __m256i xi = _mm256_loadu_si256((const __m256i *) (const void *) (x + i));
+            sum = _mm256_add_epi64(sum, mm256_popcnt_epi64_def(xi));
+        }
+        _mm256_storeu_si256((__m256i *) (void *) sum_lanes, sum);
+        hw = (unsigned int) (sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3]);
+    }
+#endif
+    for (; i < n; i++) {
+        hw += get_uint64_hamming_weight(x[i]);
+    }
+    return hw;
+}
 
 /**
+ * @brief Converter of PRNG output to the stream of codes of Hamming
+ * weights for the `hamming_ot` test. Codes are produced by groups: e.g.
+ * one 64-bit value gives 8 codes in the `HAMMING_OT_BYTES` mode and
+ * 64 values give 8 codes in the `HAMMING_OT_BYTES_LOW1` mode.
  * @details It DOESN'T OWN the PRNG state kept in gs->state!
  */
-void ByteStreamGenerator_init(ByteStreamGenerator *obj,
-    GeneratorState *gs, UseBitsMode use_bits)
+typedef struct {
+    GeneratorState *gs; ///< Used generator and its state
+    HammingOtMode mode; ///< Selector of processed bits subset
+    const uint8_t *hw_to_code; ///< Table for conversion of Hamming weights to codes
+    unsigned int nbytes; ///< Number of bytes returned by the generator
+    unsigned int codes_per_group; ///< Number of codes made of one group of values
+    unsigned int values_per_group; ///< Number of values in one group
+} HammingOtStream;
+
+
+static void HammingOtStream_init(HammingOtStream *obj, GeneratorState *gs,
+    HammingOtMode mode, const uint8_t *hw_to_code)
 {
-    obj->gen = gs->gi;
-    obj->state = gs->state;
+    obj->gs = gs;
+    obj->mode = mode;
+    obj->hw_to_code = hw_to_code;
     obj->nbytes = gs->gi->nbits / 8;
-    obj->bytes_left = 0;
-    switch (use_bits) {
-    case USE_BITS_ALL:
-        obj->get_byte = ByteStreamGenerator_getbyte;
+    switch (mode) {
+    case HAMMING_OT_VALUES:
+        obj->codes_per_group = 1;
+        obj->values_per_group = 1;
         break;
-
-    case USE_BITS_LOW8:
-        obj->get_byte = ByteStreamGenerator_getbyte_low8;
+    case HAMMING_OT_BYTES:
+        obj->codes_per_group = obj->nbytes;
+        obj->values_per_group = 1;
         break;
-
-    case USE_BITS_LOW1:
-        obj->get_byte = ByteStreamGenerator_getbyte_low1;
+    case HAMMING_OT_BYTES_LOW8:
+        obj->codes_per_group = 8;
+        obj->values_per_group = 8;
         break;
-
-    default:
-        obj->get_byte = ByteStreamGenerator_getbyte;
+    case HAMMING_OT_BYTES_LOW1:
+        obj->codes_per_group = 8;
+        obj->values_per_group = 64;
         break;
+    default:
+        fprintf(stderr, "Internal error");
+        exit(1);
     }
 }
 
+/**
+ * @brief Fills the buffer with `ncodes` codes. The number of generated
+ * codes is rounded up to the whole number of groups, so `ncodes` shouldn't
+ * exceed HAMMING_OT_BLOCK_LEN (or should be divisible by the group size).
+ */
+static void HammingOtStream_get_codes(const HammingOtStream *obj,
+    uint8_t *codes, size_t ncodes)
+{
+    const size_t ngroups = (ncodes + obj->codes_per_group - 1) / obj->codes_per_group;
+    const uint8_t *hw_to_code = obj->hw_to_code;
+    GeneratorState *gs = obj->gs;
+    switch (obj->mode) {
+    case HAMMING_OT_VALUES:
+        for (size_t i = 0; i < ngroups; i++) {
+            codes[i] = hw_to_code[get_uint64_hamming_weight(GeneratorState_get_bits(gs))];
+        }
+        break;
 
+    case HAMMING_OT_BYTES: {
+        uint8_t bytes[HAMMING_OT_BLOCK_LEN];
+        size_t nbytes_total = 0;
+        for (size_t i = 0; i < ngroups; i++) {
+            uint64_t u = GeneratorState_get_bits(gs);
+            for (unsigned int j = 0; j < obj->nbytes; j++) {
+                bytes[nbytes_total++] = (uint8_t) u;
+                u >>= 8;
+            }
+        }
+        hamming_bytes_to_codes(codes, bytes, nbytes_total, hw_to_code);
+        break;
+    }
+
+    case HAMMING_OT_BYTES_LOW8:
+        for (size_t i = 0; i < ngroups * 8; i++) {
+            const uint8_t u = (uint8_t) GeneratorState_get_bits(gs);
+            codes[i] = hw_to_code[get_byte_hamming_weight(u)];
+        }
+        break;
 
+    case HAMMING_OT_BYTES_LOW1:
+        for (size_t i = 0; i < ngroups * 8; i++) {
+            unsigned int hw = 0;
+            for (int j = 0; j < 8; j++) {
+                hw += (unsigned int) (GeneratorState_get_bits(gs) & 1);
+            }
+            codes[i] = hw_to_code[hw];
+        }
+        break;
+    }
+}
 
 /**
  * @brief Keeps the Hamming weight tuple counter and theoretical probability
@@ -233,6 +381,100 @@ void HammingTuplesTable_destruct(HammingTuplesTable *obj)
 }
 
 
+/**
+ * @brief Counter of overlapping tuples of 2-bit codes for the table of
+ * tuples. Codes are processed by blocks: the block is preceded by the last
+ * codes of the previous block, so the tuples are built from the sliding
+ * window by shifts without dependencies between them. Compact 32-bit
+ * counters (1 MiB instead of 4 MiB for the table with interleaved counters
+ * and probabilities) are periodically spilled into the table.
+ */
+typedef struct {
+    HammingTuplesTable *table; ///< Table of tuples that receives the counters
+    uint32_t *counts; ///< Compact 32-bit counters
+    unsigned long long nspill; ///< Number of tuples counted after the last spill
+    uint8_t codes[HAMMING_OT_TUPLE_SIZE - 1 + HAMMING_OT_BLOCK_LEN]; ///< Codes buffer
+    uint32_t tuples[HAMMING_OT_BLOCK_LEN]; ///< Tuples built from the current block
+} HammingTuplesCounter;
+
+
+static void HammingTuplesCounter_init(HammingTuplesCounter *obj,
+    HammingTuplesTable *table)
+{
+    obj->table = table;
+    obj->counts = calloc(table->len, sizeof(uint32_t));
+    ASSERT_MALLOC_PTR(obj->counts, "HammingTuplesCounter_init")
+    obj->nspill = 0;
+}
+
+/**
+ * @brief Returns the pointer to the buffer for the new block of codes.
+ * The first `HAMMING_OT_TUPLE_SIZE - 1` codes must be filled before
+ * the first call of this function directly in the `codes` buffer.
+ */
+static inline uint8_t *HammingTuplesCounter_get_block(HammingTuplesCounter *obj)
+{
+    return obj->codes + HAMMING_OT_TUPLE_SIZE - 1;
+}
+
+static void HammingTuplesCounter_spill(HammingTuplesCounter *obj)
+{
+    for (size_t i = 0; i < obj->table->len; i++) {
+        obj->table->tuples[i].count += obj->counts[i];
+        obj->counts[i] = 0;
+    }
+    obj->nspill = 0;
+}
+
+/**
+ * @brief Counts tuples that end in the new block of `n` codes.
+ */
+static void HammingTuplesCounter_count(HammingTuplesCounter *obj, size_t n)
+{
+    const uint8_t *codes = obj->codes;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t tuple = codes[i];
+        for (size_t j = 1; j < HAMMING_OT_TUPLE_SIZE; j++) {
+            tuple = (tuple << 2) | codes[i + j];
+        }
+        obj->tuples[i] = tuple;
+    }
+    for (size_t i = 0; i < n; i++) {
+        obj->counts[obj->tuples[i]]++;
+    }
+    memmove(obj->codes, obj->codes + n, HAMMING_OT_TUPLE_SIZE - 1);
+    obj->nspill += n;
+    if (obj->nspill >= HAMMING_OT_SPILL_PERIOD) {
+        HammingTuplesCounter_spill(obj);
+    }
+}
+
+static void HammingTuplesCounter_destruct(HammingTuplesCounter *obj)
+{
+    HammingTuplesCounter_spill(obj);
+    free(obj->counts);
+    obj->counts = NULL;
+}
+
+/**
+ * @brief Skips the values corresponding to 2 extra codes at the end of the
+ * stream: they are not used in tuples but are included into the sample size
+ * for compatibility with the earlier versions of SmokeRand.
+ * @param obj              Generator state.
+ * @param ntuples          Number of counted tuples.
+ * @param codes_per_group  Number of codes made of one group of values.
+ * @param values_per_group Number of values in one group.
+ */
+static void hamming_ot_skip_tail(GeneratorState *obj, unsigned long long ntuples,
+    unsigned int codes_per_group, unsigned int values_per_group)
+{
+    const unsigned long long ncodes = ntuples + HAMMING_OT_TUPLE_SIZE - 1;
+    const unsigned long long ngroups = (ncodes + codes_per_group - 1) / codes_per_group,
+        ngroups_total = (ncodes + 2 + codes_per_group - 1) / codes_per_group;
+    GeneratorState_discard(obj, (ngroups_total - ngroups) * values_per_group);
+}
+
+
 /**
  * @brief Converts number of samples (bytes or words) to number of generated
  * tuples (not tuples types)
@@ -433,14 +675,11 @@ TestResults hamming_ot_test(GeneratorState *obj, const HammingOtOptions *opts)
     double code_to_prob[4];
     const uint8_t *hw_to_code = hamming_ot_fill_hw_tables(obj, opts, code_to_prob);
     // Parameters for 18-bit tuple with 2-bit digits
-    static const unsigned int code_nbits = 2, tuple_size = 9;
-    const uint64_t tuple_mask = (1ull << code_nbits * tuple_size) - 1;
+    static const unsigned int code_nbits = 2, tuple_size = HAMMING_OT_TUPLE_SIZE;
     //
     HammingTuplesTable table;
     HammingTuplesTable_init(&table, code_nbits, tuple_size, code_to_prob);
 
-    uint64_t tuple = 0; // 9 4-bit Hamming weights + 1 extra Hamming weight
-    uint8_t cur_weight; // Current Hamming weight
     unsigned long long ntuples = hamming_ot_nbytes_to_ntuples(opts->nbytes,
         obj->gi->nbits, opts->mode);
     hamming_ot_test_print_info(obj, opts, ntuples);
@@ -448,49 +687,23 @@ TestResults hamming_ot_test(GeneratorState *obj, const HammingOtOptions *opts)
     for (int i = 0; i < 4; i++) {
         obj->intf->printf("    p(%d) = %10.8f\n", i, code_to_prob[i]);
     }
-    if (opts->mode == HAMMING_OT_VALUES) {
-        // Process input as a sequence of 32/64-bit words
-        // Pre-fill tuple
-        cur_weight = get_uint64_hamming_weight(obj->gi->get_bits(obj->state));
-        for (unsigned int i = 0; i < tuple_size; i++) {
-            tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-            cur_weight = get_uint64_hamming_weight(obj->gi->get_bits(obj->state));
-        }
-        // Generate other overlapping tuples
-        for (unsigned long long i = 0; i < ntuples; i++) {
-            // Process current tuple
-            table.tuples[tuple].count++;
-            // Update tuple
-            tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-            cur_weight = get_uint64_hamming_weight(obj->gi->get_bits(obj->state));
-        }
-    } else {
-        ByteStreamGenerator bs;
-        if (opts->mode == HAMMING_OT_BYTES) {
-            ByteStreamGenerator_init(&bs, obj, USE_BITS_ALL);
-        } else if (opts->mode == HAMMING_OT_BYTES_LOW8) {
-            ByteStreamGenerator_init(&bs, obj, USE_BITS_LOW8);
-        } else if (opts->mode == HAMMING_OT_BYTES_LOW1) {
-            ByteStreamGenerator_init(&bs, obj, USE_BITS_LOW1);
-        } else {
-            fprintf(stderr, "Internal error");
-            exit(1);
-        }
-        // Pre-fill tuple
-        cur_weight = get_byte_hamming_weight(bs.get_byte(&bs));
-        for (unsigned int i = 0; i < tuple_size; i++) {
-            tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-            cur_weight = get_byte_hamming_weight(bs.get_byte(&bs));
-        }
-        // Generate other overlapping tuples
-        for (unsigned long long i = 0; i < ntuples; i++) {
-            // Process current tuple
-            table.tuples[tuple].count++;
-            // Update tuple
-            tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-            cur_weight = get_byte_hamming_weight(bs.get_byte(&bs));
-        }
+    HammingOtStream stream;
+    HammingOtStream_init(&stream, obj, opts->mode, hw_to_code);
+    HammingTuplesCounter *counter = calloc(1, sizeof(HammingTuplesCounter));
+    ASSERT_MALLOC_PTR(counter, "hamming_ot_test")
+    HammingTuplesCounter_init(counter, &table);
+    // Pre-fill tuple
+    HammingOtStream_get_codes(&stream, counter->codes, tuple_size - 1);
+    // Generate other overlapping tuples by blocks
+    for (unsigned long long i = 0; i < ntuples; i += HAMMING_OT_BLOCK_LEN) {
+        const size_t len = (ntuples - i < HAMMING_OT_BLOCK_LEN) ?
+            (size_t) (ntuples - i) : HAMMING_OT_BLOCK_LEN;
+        HammingOtStream_get_codes(&stream, HammingTuplesCounter_get_block(counter), len);
+        HammingTuplesCounter_count(counter, len);
     }
+    HammingTuplesCounter_destruct(counter);
+    free(counter);
+    hamming_ot_skip_tail(obj, ntuples, stream.codes_per_group, stream.values_per_group);
     // Convert tuples counters to the test results (p-value etc.)
     obj->intf->printf("   Number of tuples types: %llu\n",
         (unsigned long long) table.len);
@@ -553,12 +766,26 @@ static void hamming_ot_long_fill_hw_tables(unsigned short *hw_to_code,
 }
 
 
+/**
+ * @brief Returns the Hamming weight of the long word made of `values_per_word`
+ * PRNG outputs. Values are taken directly from the GeneratorState buffer.
+ */
 static inline unsigned int get_wlong_hamming_weight(GeneratorState *obj,
     unsigned int values_per_word)
 {
     unsigned int hw = 0;
-    for (unsigned int i = 0; i < values_per_word; i++) {
-        hw += get_uint64_hamming_weight(obj->gi->get_bits(obj->state));
+    size_t nleft = values_per_word;
+    while (nleft > 0) {
+        if (obj->buf_pos >= obj->buf_len) {
+            GeneratorState_refill(obj);
+        }
+        size_t len = obj->buf_len - obj->buf_pos;
+        if (len > nleft) {
+            len = nleft;
+        }
+        hw += hamming_sum_u64(obj->buf + obj->buf_pos, len);
+        obj->buf_pos += len;
+        nleft -= len;
     }
     return hw;
 }
@@ -584,14 +811,11 @@ TestResults hamming_ot_long_test(GeneratorState *obj, const HammingOtLongOptions
     ASSERT_MALLOC_PTR(hw_to_code, "hamming_ot_long_test")
     hamming_ot_long_fill_hw_tables(hw_to_code, code_to_prob, bits_per_word);
     // Parameters for 18-bit tuple with 2-bit digits
-    static const unsigned int code_nbits = 2, tuple_size = 9;
-    const uint64_t tuple_mask = (1ull << code_nbits * tuple_size) - 1;
+    static const unsigned int code_nbits = 2, tuple_size = HAMMING_OT_TUPLE_SIZE;
     //
     HammingTuplesTable table;
     HammingTuplesTable_init(&table, code_nbits, tuple_size, code_to_prob);
 
-    uint64_t tuple = 0; // 9 4-bit Hamming weights + 1 extra Hamming weight
-    unsigned int cur_weight; // Current Hamming weight
     unsigned int values_per_word = bits_per_word / obj->gi->nbits;
     unsigned long long ntuples = opts->nvalues / values_per_word;
     obj->intf->printf("Hamming weights based test (overlapping tuples), long version\n");
@@ -603,20 +827,28 @@ TestResults hamming_ot_long_test(GeneratorState *obj, const HammingOtLongOptions
         obj->intf->printf("    p(%d) = %10.8f\n", i, code_to_prob[i]);
     }
     // Process input as a sequence of 256-bit words
+    HammingTuplesCounter *counter = calloc(1, sizeof(HammingTuplesCounter));
+    ASSERT_MALLOC_PTR(counter, "hamming_ot_long_test")
+    HammingTuplesCounter_init(counter, &table);
     // Pre-fill tuple
-    cur_weight = get_wlong_hamming_weight(obj, values_per_word);
-    for (unsigned int i = 0; i < tuple_size; i++) {
-        tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-        cur_weight = get_wlong_hamming_weight(obj, values_per_word);
-    }
-    // Generate other overlapping tuples
-    for (unsigned long long i = 0; i < ntuples; i++) {
-        // Process current tuple
-        table.tuples[tuple].count++;
-        // Update tuple
-        tuple = ((tuple << code_nbits) | hw_to_code[cur_weight]) & tuple_mask;
-        cur_weight = get_wlong_hamming_weight(obj, values_per_word);
+    for (unsigned int i = 0; i < tuple_size - 1; i++) {
+        const unsigned int hw = get_wlong_hamming_weight(obj, values_per_word);
+        counter->codes[i] = (uint8_t) hw_to_code[hw];
     }
+    // Generate other overlapping tuples by blocks
+    for (unsigned long long i = 0; i < ntuples; i += HAMMING_OT_BLOCK_LEN) {
+        const size_t len = (ntuples - i < HAMMING_OT_BLOCK_LEN) ?
+            (size_t) (ntuples - i) : HAMMING_OT_BLOCK_LEN;
+        uint8_t *codes = HammingTuplesCounter_get_block(counter);
+        for (size_t j = 0; j < len; j++) {
+            const unsigned int hw = get_wlong_hamming_weight(obj, values_per_word);
+            codes[j] = (uint8_t) hw_to_code[hw];
+        }
+        HammingTuplesCounter_count(counter, len);
+    }
+    HammingTuplesCounter_destruct(counter);
+    free(counter);
+    hamming_ot_skip_tail(obj, ntuples, 1, values_per_word);
     // Convert tuples counters to the test results (p-value etc.)
     obj->intf->printf("   Number of tuples types: %llu\n",
         (unsigned long long) table.len);
@@ -707,28 +939,25 @@ static void HammingDistrHist_destruct(HammingDistrHist *obj)
 }
 
 
+/**
+ * @brief Sums Hamming weights of neighbouring blocks pairwise (in place),
+ * i.e. converts weights of `2 * nblocks` blocks to weights of `nblocks`
+ * twice longer blocks, and updates the histogram.
+ */
 static inline void calc_block_hw_sums(unsigned long long *hw_freq,
-    const int *hw_vals, int block_len, int total_len)
+    int *hw_vals, size_t nblocks)
 {
-    for (int i = 0; i < total_len; i += block_len) {
-        int hw_sum = 0;
-        for (int j = 0; j < block_len; j++) {
-            hw_sum += hw_vals[i + j];
-        }
-        hw_freq[hw_sum]++;
+    for (size_t i = 0; i < nblocks; i++) {
+        hw_vals[i] = hw_vals[2 * i] + hw_vals[2 * i + 1];
+        hw_freq[hw_vals[i]]++;
     }
 }
 
 static inline void calc_block_hw_xorsums(unsigned long long *hw_freq,
-    const uint64_t *x, int block_len, int total_len)
+    const uint64_t *x, size_t block_len, size_t total_len)
 {
-    for (int i = 0; i < total_len; i += block_len * 2) {
-        int hw_xorsum = 0;
-        for (int j = 0; j < block_len; j++) {
-            uint64_t xored = x[i + j] ^ x[i + j + block_len];
-            hw_xorsum += get_uint64_hamming_weight(xored);
-        }
-        hw_freq[hw_xorsum]++;
+    for (size_t i = 0; i < total_len; i += block_len * 2) {
+        hw_freq[hamming_xorsum_u64(x + i, x + i + block_len, block_len)]++;
     }
 }
 
@@ -781,7 +1010,7 @@ TestResults hamming_distr_test(GeneratorState *obj, const HammingDistrOptions *o
     uint64_t bad_or = 0;
     for (unsigned long long i = 0; i < opts->nvalues; i += block_len) {
         for (unsigned int j = 0; j < block_len; j++) {
-            uint64_t u = obj->gi->get_bits(obj->state);
+            uint64_t u = GeneratorState_get_bits(obj);
             x[j] = u & mask;
             bad_or |= u & not_mask;
             hw[j] = get_uint64_hamming_weight(x[j]);
@@ -791,10 +1020,11 @@ TestResults hamming_distr_test(GeneratorState *obj, const HammingDistrOptions *o
             h[0].o[hw[j]]++; h[0].o[hw[j + 1]]++;
             h[0].o_xor[get_uint64_hamming_weight(x[j] ^ x[j + 1])]++;
         }
-        // 2, 4, 8, 16 - value blocks
+        // 2, 4, 8, 16 - value blocks: weights of blocks are obtained
+        // from weights of twice shorter blocks from the previous level
         for (int j = 1; j < opts->nlevels; j++) {
-            calc_block_hw_sums(h[j].o,        hw, 1 << j, (int) block_len);
-            calc_block_hw_xorsums(h[j].o_xor, x,  1 << j, (int) block_len);
+            calc_block_hw_sums(h[j].o,        hw, block_len >> j);
+            calc_block_hw_xorsums(h[j].o_xor, x,  1UL << j, block_len);
         }
     }
     if (bad_or != 0) {
@@ -846,4 +1076,21 @@ TestResults hamming_distr_test_wrap(GeneratorState *obj, const void *udata)
     return hamming_distr_test(obj, udata);
 }
 
+//////////////////////////////////////////////////////
+///// Properties of tests for the battery runner /////
+//////////////////////////////////////////////////////
+
+// All tests just read the generator output sequentially
+OPTIONS_SCALE_FUNC_TPL(HammingOtOptions, nbytes)
+OPTIONS_SCALE_FUNC_TPL(HammingOtLongOptions, nvalues)
+OPTIONS_SCALE_FUNC_TPL(HammingDistrOptions, nvalues)
 
+const TestTraits hamming_ot_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(HammingOtOptions)
+};
+const TestTraits hamming_ot_long_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(HammingOtLongOptions)
+};
+const TestTraits hamming_distr_test_traits = {
+    .is_pipelined = 1, TEST_TRAITS_SCALER(HammingDistrOptions)
+};
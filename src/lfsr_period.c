@@ -13,6 +13,7 @@
  * This software is licensed under the MIT license.
  */
 #include "smokerand/lfsr_period.h"
+#include "smokerand/threads_intf.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -511,13 +512,26 @@ LfsrPoly LfsrPoly_jumppoly_ce(const LfsrPoly *charpoly, uint64_t c, uint32_t e)
 ///// LfsrMatrix class implementation /////
 ///////////////////////////////////////////
 
+/**
+ * @brief Number of rows of the right matrix used for one lookup table
+ * in the "Method of Four Russians" multiplication.
+ */
+#define M4RM_KBITS 8
+
+/**
+ * @brief Minimal number of rows processed by one thread during the
+ * multiplication. Smaller matrices are multiplied in the main thread.
+ */
+#define M4RM_MIN_ROWS_PER_THREAD 256
+
 LfsrMatrix LfsrMatrix_create(size_t n)
 {
     LfsrMatrix obj;
+    obj.nwords = (n + 63) / 64;
     if (n > 0) {
-        obj.x = calloc(n * n, sizeof(uint8_t));
+        obj.x = calloc(n * obj.nwords, sizeof(uint64_t));
     } else {
-        obj.x = calloc(1, sizeof(uint8_t));
+        obj.x = calloc(1, sizeof(uint64_t));
     }
     if (obj.x == NULL) {
         fprintf(stderr, "***** LfsrMatrix_create: not enough memory *****\n");
@@ -527,16 +541,104 @@ LfsrMatrix LfsrMatrix_create(size_t n)
     return obj;
 }
 
+static inline const uint64_t *LfsrMatrix_row(const LfsrMatrix *obj, size_t i)
+{
+    return &obj->x[i * obj->nwords];
+}
+
 /**
- * @brief Matrix multiplication in the GF(2) field.
- * @details It uses rows and columns packing to 64-bit words, bitwise operations
- * and Hamming weights compuation to optimize the multiplication (important for
- * matrices with n >= 128).
+ * @brief A task for the multiplication thread: the [i_begin, i_end)
+ * rows block of the C = AB product.
+ */
+typedef struct {
+    const LfsrMatrix *a;
+    const LfsrMatrix *b;
+    LfsrMatrix *c;
+    size_t i_begin;
+    size_t i_end;
+} LfsrMatrixProdTask;
+
+/**
+ * @brief Computes the [i_begin, i_end) rows block of the C = AB product
+ * by the "Method of Four Russians" (M4RM).
+ * @details The i-th row of C is a XOR of the rows of B selected by the
+ * i-th row of A. Rows of B are processed by groups of 8: all 256 XOR
+ * combinations of each group are precomputed in the lookup table, so one
+ * byte of the A row requires only one XOR of packed rows. The table
+ * for the combination g is obtained from the table for g without its
+ * lowest bit, i.e. each entry costs one row XOR.
+ *
+ * References:
+ *
+ * 1. Albrecht M., Bard G., Hart W. Algorithm 898: Efficient multiplication
+ *    of dense matrices over GF(2) // ACM Transactions on Mathematical
+ *    Software. 2010. V. 37. N 1. Article 9. https://doi.org/10.1145/1644001.1644010
+ */
+static void LfsrMatrixProdTask_run(const LfsrMatrixProdTask *task)
+{
+    const LfsrMatrix *a = task->a, *b = task->b;
+    LfsrMatrix *c = task->c;
+    const size_t n = a->n, nwords = a->nwords;
+    uint64_t *tbl = calloc((1U << M4RM_KBITS) * nwords, sizeof(uint64_t));
+    if (tbl == NULL) {
+        fprintf(stderr, "***** LfsrMatrix_create_prod: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k0 = 0; k0 < n; k0 += M4RM_KBITS) {
+        // Lookup table for the [k0, k0 + kbits) rows of B
+        const unsigned int kbits = (n - k0 < M4RM_KBITS) ?
+            (unsigned int) (n - k0) : M4RM_KBITS;
+        const unsigned int tblsize = 1U << kbits;
+        for (unsigned int g = 1; g < tblsize; g++) {
+            const unsigned int g_prev = g & (g - 1);
+            unsigned int k = 0;
+            while (((g >> k) & 1) == 0) {
+                k++;
+            }
+            const uint64_t *src = &tbl[g_prev * nwords];
+            const uint64_t *brow = LfsrMatrix_row(b, k0 + k);
+            uint64_t *dst = &tbl[g * nwords];
+            for (size_t w = 0; w < nwords; w++) {
+                dst[w] = src[w] ^ brow[w];
+            }
+        }
+        // Accumulate the products
+        const size_t kw = k0 >> 6;
+        const unsigned int ksh = (unsigned int) (k0 & 0x3F);
+        for (size_t i = task->i_begin; i < task->i_end; i++) {
+            const unsigned int g = (unsigned int)
+                ((LfsrMatrix_row(a, i)[kw] >> ksh) & (tblsize - 1));
+            if (g != 0) {
+                const uint64_t *src = &tbl[g * nwords];
+                uint64_t *dst = &c->x[i * nwords];
+                for (size_t w = 0; w < nwords; w++) {
+                    dst[w] ^= src[w];
+                }
+            }
+        }
+    }
+    free(tbl);
+}
+
+static ThreadRetVal THREADFUNC_SPEC LfsrMatrixProdTask_thread(void *udata)
+{
+    LfsrMatrixProdTask_run(udata);
+    return 0;
+}
+
+/**
+ * @brief Matrix multiplication in the GF(2) field, it uses several threads
+ * for the independent blocks of rows.
+ * @details Packed rows and the "Method of Four Russians" are used, so
+ * the complexity is about \f$ n^3 / (64 \cdot 8) \f$ XOR operations on
+ * 64-bit words. Each thread has its own lookup tables.
  * @param a The first matrix.
  * @param b The second matrix.
+ * @param nthreads Number of threads (0 or 1 - compute in the current thread).
  * @return The matrix product, must be destructed by the caller.
  */
-LfsrMatrix LfsrMatrix_create_prod(const LfsrMatrix *a, const LfsrMatrix *b)
+LfsrMatrix LfsrMatrix_create_prod_mt(const LfsrMatrix *a, const LfsrMatrix *b,
+    unsigned int nthreads)
 {
     // Check the matrices size
     const size_t n = a->n;
@@ -544,51 +646,51 @@ LfsrMatrix LfsrMatrix_create_prod(const LfsrMatrix *a, const LfsrMatrix *b)
         LfsrMatrix c = LfsrMatrix_create(0);
         return c;
     }
-    // Cache rows/columns
-    // It is O(n^2) and the matrix multiplication is O(n^3)
-    size_t nwords = n / 64;
-    if (n % 64 > 0) {
-        nwords++;
+    LfsrMatrix c = LfsrMatrix_create(n);
+    if (nthreads > NTHREADS_MAX) {
+        nthreads = NTHREADS_MAX;
     }
-    uint64_t *arows = calloc(nwords * n, sizeof(uint64_t));
-    if (arows == NULL) {
-        fprintf(stderr, "***** LfsrMatrix_create_prod: not enough memory *****\n");
-        exit(EXIT_FAILURE);
+    if (nthreads > n / M4RM_MIN_ROWS_PER_THREAD) {
+        nthreads = (unsigned int) (n / M4RM_MIN_ROWS_PER_THREAD);
     }
-    uint64_t *bcols = calloc(nwords * n, sizeof(uint64_t));
-    if (bcols == NULL) {
-        fprintf(stderr, "***** LfsrMatrix_create_prod: not enough memory *****\n");
+    if (nthreads <= 1) {
+        LfsrMatrixProdTask task = {.a = a, .b = b, .c = &c,
+            .i_begin = 0, .i_end = n};
+        LfsrMatrixProdTask_run(&task);
+        return c;
+    }
+    LfsrMatrixProdTask *tasks = calloc(nthreads, sizeof(LfsrMatrixProdTask));
+    ThreadObj *thrd = calloc(nthreads, sizeof(ThreadObj));
+    if (tasks == NULL || thrd == NULL) {
+        fprintf(stderr, "***** LfsrMatrix_create_prod_mt: not enough memory *****\n");
         exit(EXIT_FAILURE);
     }
-    for (size_t i = 0; i < n; i++) {
-        for (size_t j = 0; j < n; j++) {
-            const uint64_t aij = LfsrMatrix_getbit(a, i, j);
-            const uint64_t bij = LfsrMatrix_getbit(b, i, j);
-            arows[i*nwords + (j >> 6)] |= aij << (j & 0x3FU);
-            bcols[j*nwords + (i >> 6)] |= bij << (i & 0x3FU);
-        }
-    }    
-    // The multiplication procedure
-    // It is based on the cij ^= aik & bki formula but uses bitwise
-    // operations on 64-bit words and Hamming weights for optimization.
-    LfsrMatrix c = LfsrMatrix_create(n);
-    for (size_t i = 0; i < n; i++) {
-        for (size_t j = 0; j < n; j++) {
-            uint8_t cij = 0;
-            for (size_t k = 0; k < nwords; k++) {
-                const uint64_t prods = arows[i*nwords + k] & bcols[j*nwords + k];
-                cij = (uint8_t) (cij + get_uint64_hamming_weight(prods));
-            }
-            LfsrMatrix_setbit(&c, i, j, cij & 1);
-
-        }
+    for (unsigned int i = 0; i < nthreads; i++) {
+        tasks[i].a = a; tasks[i].b = b; tasks[i].c = &c;
+        tasks[i].i_begin = n * i / nthreads;
+        tasks[i].i_end = n * (i + 1) / nthreads;
+        thrd[i] = ThreadObj_create(LfsrMatrixProdTask_thread, &tasks[i],
+            THREAD_ORD_HELPER + i);
     }
-    // Free buffers and return the resulting matrix
-    free(arows);
-    free(bcols);
+    for (unsigned int i = 0; i < nthreads; i++) {
+        ThreadObj_wait(&thrd[i]);
+    }
+    free(thrd);
+    free(tasks);
     return c;
 }
 
+/**
+ * @brief Matrix multiplication in the GF(2) field (single-threaded version).
+ * @param a The first matrix.
+ * @param b The second matrix.
+ * @return The matrix product, must be destructed by the caller.
+ */
+LfsrMatrix LfsrMatrix_create_prod(const LfsrMatrix *a, const LfsrMatrix *b)
+{
+    return LfsrMatrix_create_prod_mt(a, b, 1);
+}
+
 /**
  * @brief Check if the two matrices are equal.
  */
@@ -597,14 +699,7 @@ int LfsrMatrix_are_equal(const LfsrMatrix *a, const LfsrMatrix *b)
     if (a->n != b->n) {
         return 0;
     }
-    for (size_t i = 0; i < a->n; i++) {
-        for (size_t j = 0; j < a->n; j++) {
-            if (LfsrMatrix_getbit(a, i, j) != LfsrMatrix_getbit(b, i, j)) {
-                return 0;
-            }
-        }
-    }
-    return 1;
+    return memcmp(a->x, b->x, a->n * a->nwords * sizeof(uint64_t)) == 0;
 }
 
 /**
@@ -613,9 +708,10 @@ int LfsrMatrix_are_equal(const LfsrMatrix *a, const LfsrMatrix *b)
 int LfsrMatrix_is_eye(const LfsrMatrix *a)
 {
     for (size_t i = 0; i < a->n; i++) {
-        for (size_t j = 0; j < a->n; j++) {
-            const uint8_t dij = (i == j) ? 1 : 0;
-            if (LfsrMatrix_getbit(a, i, j) != dij) {
+        const uint64_t *row = LfsrMatrix_row(a, i);
+        for (size_t w = 0; w < a->nwords; w++) {
+            const uint64_t dw = (w == (i >> 6)) ? (1ULL << (i & 0x3FU)) : 0;
+            if (row[w] != dw) {
                 return 0;
             }
         }
@@ -630,7 +726,7 @@ LfsrMatrix LfsrMatrix_clone(const LfsrMatrix *obj)
 {
     const size_t n = obj->n;
     LfsrMatrix cpy = LfsrMatrix_create(n);
-    memcpy(cpy.x, obj->x, n*n);
+    memcpy(cpy.x, obj->x, n * obj->nwords * sizeof(uint64_t));
     return cpy;
 }
 
@@ -655,25 +751,27 @@ void LfsrMatrix_destruct(LfsrMatrix *obj)
  *
  * @param x  Matrix (base)
  * @param e  Exponent
+ * @param nthreads  Number of threads for matrix multiplication.
  * @return The matrix power, must be destructed by the caller.
  */
-LfsrMatrix LfsrMatrix_create_pow(const LfsrMatrix *x, const LargeInt *e)
+LfsrMatrix LfsrMatrix_create_pow(const LfsrMatrix *x, const LargeInt *e,
+    unsigned int nthreads)
 {
     if (LargeInt_is_u64(e, 1)) {
         return LfsrMatrix_clone(x);
     } else if (LargeInt_is_u64(e, 2)) {
-        return LfsrMatrix_create_prod(x, x);
+        return LfsrMatrix_create_prod_mt(x, x, nthreads);
     } else {
         LfsrMatrix y = LfsrMatrix_clone(x);
         const unsigned int nbits = LargeInt_get_nbits(e);
         for (unsigned int i = nbits - 1; i-- != 0; ) {
             // y = y * y
-            LfsrMatrix sq = LfsrMatrix_create_prod(&y, &y);
+            LfsrMatrix sq = LfsrMatrix_create_prod_mt(&y, &y, nthreads);
             LfsrMatrix_destruct(&y);
             y = sq;
             if (LargeInt_getbit(e, i)) {
                 // y = y * x
-                LfsrMatrix yx = LfsrMatrix_create_prod(&y, x);
+                LfsrMatrix yx = LfsrMatrix_create_prod_mt(&y, x, nthreads);
                 LfsrMatrix_destruct(&y);
                 y = yx;
             }
@@ -755,9 +853,10 @@ void LfsrMatrix_print(const LfsrMatrix *obj, const CallerAPI *intf)
 
 
 
-int LfsrMatrix_is_period_possible(const LfsrMatrix *mat, const LargeInt *period)
+int LfsrMatrix_is_period_possible(const LfsrMatrix *mat, const LargeInt *period,
+    unsigned int nthreads)
 {
-    LfsrMatrix matp = LfsrMatrix_create_pow(mat, period);
+    LfsrMatrix matp = LfsrMatrix_create_pow(mat, period, nthreads);
     const int is_possible = LfsrMatrix_is_eye(&matp);
     LfsrMatrix_destruct(&matp);
     return is_possible;
@@ -765,6 +864,8 @@ int LfsrMatrix_is_period_possible(const LfsrMatrix *mat, const LargeInt *period)
 
 /**
  * @brief Converts LFSR transition matrix to Krylov matrix.
+ * @details The (i+1)-th row is \f$ xA^{i+1} = (xA^i)A \f$, i.e. a XOR of
+ * the rows of A selected by the i-th row.
  */
 LfsrMatrix LfsrMatrix_get_krylov_matrix(const LfsrMatrix *mat)
 {
@@ -772,14 +873,14 @@ LfsrMatrix LfsrMatrix_get_krylov_matrix(const LfsrMatrix *mat)
     LfsrMatrix kmat = LfsrMatrix_create(nbits + 1);
     LfsrMatrix_setbit(&kmat, 0, 0, 1);
     for (size_t i = 0; i < nbits; i++) {
-        for (size_t j = 0; j < nbits; j++) {
-            uint8_t b = 0;
-            for (size_t k = 0; k < nbits; k++) {
-                const uint8_t u = LfsrMatrix_getbit(mat, k, j);
-                const uint8_t v = LfsrMatrix_getbit(&kmat, i, k);
-                b = (uint8_t) (b ^ (u & v));
+        uint64_t *next = &kmat.x[(i + 1) * kmat.nwords];
+        for (size_t k = 0; k < nbits; k++) {
+            if (LfsrMatrix_getbit(&kmat, i, k)) {
+                const uint64_t *row = LfsrMatrix_row(mat, k);
+                for (size_t w = 0; w < mat->nwords; w++) {
+                    next[w] ^= row[w];
+                }
             }
-            LfsrMatrix_setbit(&kmat, i + 1, j, b);
         }
     }
     return kmat;
@@ -787,7 +888,6 @@ LfsrMatrix LfsrMatrix_get_krylov_matrix(const LfsrMatrix *mat)
 
 /**
  * @brief Convert LFSR Krylov matrix to its characteristic polynomial.
- * The converted matrix will be altered by Gaussian elimination.
  * @details Krylov matrix has the \f$ (n+1)\times (n+1) \f$ size (where
  * n is the number of bits in the LFSR state) and should have the next
  * layout:
@@ -817,55 +917,91 @@ LfsrMatrix LfsrMatrix_get_krylov_matrix(const LfsrMatrix *mat)
  * \f[
  * c_0 b_0 \oplus c_1 b_1 \oplus \ldots \oplus c_n b_n = 0
  * \f]
+ *
+ * Each equation is a column of the Krylov matrix, so the matrix is
+ * transposed into the packed augmented matrix (the n-th column is
+ * the right-hand side) and Gauss-Jordan elimination is made by XORs
+ * of the packed rows. The input matrix is not altered.
+ *
+ * @return Characteristic polynomial or an empty polynomial (`nwords == 0`)
+ * if the system of equations is singular, see
+ * LfsrMatrix_try_krylov_to_charpoly.
  */
-LfsrPoly LfsrMatrix_krylov_to_charpoly(LfsrMatrix *mat)
+LfsrPoly LfsrMatrix_krylov_to_charpoly(const LfsrMatrix *mat)
 {
-    const size_t nbits = mat->n - 1;
-    // Gaussian elimination. Note: each equation is a column!
-    // a) Initialize the columns indexex for its swapping
-    size_t *cinds = calloc(nbits + 1, sizeof(size_t));
-    if (cinds == NULL) {
-        fprintf(stderr, "***** LfsrMatrix_krylov_to_charpoly: not enough memory *****\n");
-        exit(EXIT_FAILURE);
+    LfsrPoly poly;
+    size_t j_singular;
+    if (!LfsrMatrix_try_krylov_to_charpoly(mat, &poly, &j_singular)) {
+        poly.w64 = NULL;
+        poly.degree = 0;
+        poly.nwords = 0;
     }
+    return poly;
+}
+
+/**
+ * @brief Convert LFSR Krylov matrix to its characteristic polynomial, see
+ * LfsrMatrix_krylov_to_charpoly. Doesn't terminate the program if the
+ * system of equations is singular, e.g. if the minimal polynomial of the
+ * initial state has a degree less than the number of bits in the state.
+ * @param[in]  mat         Krylov matrix.
+ * @param[out] poly        Characteristic polynomial (not allocated on failure).
+ * @param[out] j_singular  The column without a pivot (on failure).
+ * @return 1 - success, 0 - the system of equations is singular.
+ */
+int LfsrMatrix_try_krylov_to_charpoly(const LfsrMatrix *mat, LfsrPoly *poly,
+    size_t *j_singular)
+{
+    const size_t nbits = mat->n - 1;
+    // a) Transpose: the j-th row is the j-th equation
+    LfsrMatrix eqs = LfsrMatrix_create(nbits + 1);
+    const size_t nwords = eqs.nwords;
     for (size_t i = 0; i < nbits + 1; i++) {
-        cinds[i] = i;
+        for (size_t j = 0; j < nbits; j++) {
+            if (LfsrMatrix_getbit(mat, i, j)) {
+                LfsrMatrix_setbit(&eqs, j, i, 1);
+            }
+        }
     }
-    // b) The method itself
+    // b) Gauss-Jordan elimination
     for (size_t j = 0; j < nbits; j++) {
         // b1) pivot
         size_t i_pivot;
         for (i_pivot = j;
-             LfsrMatrix_getbit(mat, j, cinds[i_pivot]) == 0 && i_pivot < nbits;
+             i_pivot < nbits && LfsrMatrix_getbit(&eqs, i_pivot, j) == 0;
              i_pivot++) {
-            
         }
-        if (i_pivot < nbits) {
-            const size_t ind = cinds[i_pivot];
-            cinds[i_pivot] = cinds[j];
-            cinds[j] = ind;
-        } else {
-            printf("----- internal error ----- %u\n", (unsigned int) j);
-            exit(1);
+        if (i_pivot == nbits) {
+            *j_singular = j;
+            LfsrMatrix_destruct(&eqs);
+            return 0;
+        }
+        uint64_t *row_j = &eqs.x[j * nwords];
+        if (i_pivot != j) {
+            uint64_t *row_p = &eqs.x[i_pivot * nwords];
+            for (size_t w = 0; w < nwords; w++) {
+                const uint64_t tmp = row_j[w];
+                row_j[w] = row_p[w];
+                row_p[w] = tmp;
+            }
         }
-        // b2) Elimination
-        // Note: LfsrMatrix_getbit(&mat, j, cinds[j])) is always 1
+        // b2) Elimination: the columns before j are already zero
+        // in the pivot row, so the first j/64 words may be skipped
+        const size_t w0 = j >> 6;
         for (size_t i = 0; i < nbits; i++) {
-            if (i != j && LfsrMatrix_getbit(mat, j, cinds[i]) != 0) {
-                // Add column cinds[j] to cinds[i]
-                for (size_t k = 0; k < nbits + 1; k++) {
-                    const uint8_t a = (uint8_t) (LfsrMatrix_getbit(mat, k, cinds[i]));
-                    const uint8_t b = (uint8_t) (LfsrMatrix_getbit(mat, k, cinds[j]));
-                    LfsrMatrix_setbit(mat, k, cinds[i], (uint8_t) (a ^ b));
+            if (i != j && LfsrMatrix_getbit(&eqs, i, j) != 0) {
+                uint64_t *row_i = &eqs.x[i * nwords];
+                for (size_t w = w0; w < nwords; w++) {
+                    row_i[w] ^= row_j[w];
                 }
             }
         }
     }
     // c) Restore the polynomial
-    LfsrPoly poly = LfsrPoly_create(nbits);
+    *poly = LfsrPoly_create(nbits);
     for (size_t i = 0; i < nbits; i++) {
-        if (LfsrMatrix_getbit(mat, nbits, cinds[i])) {
-            LfsrPoly_setbit(&poly, i);
+        if (LfsrMatrix_getbit(&eqs, i, nbits)) {
+            LfsrPoly_setbit(poly, i);
         }
     }
     // xorshift64: 0.13-17-43	x^64 + x^49 + x^48 + x^45 + x^44 + x^42 + x^41 + x^38 + x^37 + x^28 + x^27 + x^26 + x^25 + x^17 + x^16 + x^11 + x^6 + x^5 + 1	19
@@ -873,8 +1009,8 @@ LfsrPoly LfsrMatrix_krylov_to_charpoly(LfsrMatrix *mat)
     // https://github.com/funny-falcon/xorshift256and192/blob/master/full/256shift64/prim.txt
     // https://github.com/jj1bdx/xorshiftplus/blob/master/full/xorshift64poly.txt
     // https://prng.di.unimi.it/xorshift.php
-    free(cinds);
-    return poly;
+    LfsrMatrix_destruct(&eqs);
+    return 1;
 }
 
 
@@ -994,6 +1130,8 @@ LfsrMatrix GeneratorStateExt_get_krylov_matrix(GeneratorStateExt *obj)
 
 /**
  * @brief Restores the primitive characteristic polynomial of the LFSR.
+ * Returns an empty polynomial (`nwords == 0`) if the output doesn't
+ * determine it, e.g. for non-LFSR generators.
  */
 LfsrPoly GeneratorStateExt_get_poly(GeneratorStateExt *obj)
 {
@@ -1008,11 +1146,15 @@ LfsrPoly GeneratorStateExt_get_poly(GeneratorStateExt *obj)
 
 /**
  * @brief Restores the jump polynomial that corresponds to the jump matrix
- * of the LFSR.
+ * of the LFSR. Returns an empty polynomial if the characteristic polynomial
+ * cannot be restored.
  */
 LfsrPoly GeneratorStateExt_get_jump_poly_pow2(GeneratorStateExt *obj, unsigned int p)
 {
     LfsrPoly char_poly = GeneratorStateExt_get_poly(obj);
+    if (char_poly.nwords == 0) {
+        return char_poly;
+    }
     LfsrPoly jump_poly = LfsrPoly_jumppoly_ce(&char_poly, 1, p);
     LfsrPoly_destruct(&char_poly);
     return jump_poly;
@@ -1071,7 +1213,7 @@ int GeneratorStateExt_is_lfsr(GeneratorStateExt *obj)
     const LargeInt niters_lint = LargeInt_from_u64(niters);
     LfsrMatrix mat = GeneratorStateExt_get_matrix(obj, 1);
     LfsrMatrix matp_exp = GeneratorStateExt_get_matrix(obj, niters);
-    LfsrMatrix matp_calc = LfsrMatrix_create_pow(&mat, &niters_lint);
+    LfsrMatrix matp_calc = LfsrMatrix_create_pow(&mat, &niters_lint, 1);
 
     const int is_lfsr = LfsrMatrix_are_equal(&matp_exp, &matp_calc);
 
@@ -1160,6 +1302,67 @@ void GeneratorStateExt_destruct(GeneratorStateExt *obj)
     GeneratorState_destruct(&(obj->state));
 }
 
+/////////////////////////////////////////
+///// LfsrJump class implementation /////
+/////////////////////////////////////////
+
+/**
+ * @brief Prepares the generic jump by \f$ 2^d \f$ outputs for the generator
+ * without its own `jump` callback. The generator must be an LFSR without
+ * counters and constants in its state, its state must be allocated by one
+ * `intf->malloc` call and must be not larger than LFSR_JUMP_NBITS_MAX bits.
+ * The characteristic polynomial must have the degree equal to the number
+ * of bits in the state.
+ * @details WARNING: this function is not thread safe, see
+ * GeneratorStateExt_create.
+ * @param[out] obj        The jump to be initialized.
+ * @param[in]  gi         The generator to be analyzed.
+ * @param[in]  intf       Caller API; seeds are consumed from it.
+ * @param[in]  log2_dist  Jump distance is \f$ 2^d \f$ outputs.
+ * @return 1 if the generator is suitable, 0 otherwise (no buffers are
+ * allocated in this case).
+ */
+int LfsrJump_init(LfsrJump *obj, const GeneratorInfo *gi, const CallerAPI *intf,
+    unsigned int log2_dist)
+{
+    GeneratorStateExt ext = GeneratorStateExt_create(gi, intf);
+    obj->nbytes = ext.nbytes;
+    if (ext.nbytes == 0 || ext.nbytes * 8 > LFSR_JUMP_NBITS_MAX ||
+        GeneratorStateExt_has_counters(&ext) ||
+        !GeneratorStateExt_is_lfsr(&ext)) {
+        GeneratorStateExt_destruct(&ext);
+        return 0;
+    }
+    LfsrMatrix mat = GeneratorStateExt_get_krylov_matrix(&ext);
+    LfsrPoly char_poly;
+    size_t j_singular;
+    const int is_ok = LfsrMatrix_try_krylov_to_charpoly(&mat, &char_poly, &j_singular);
+    LfsrMatrix_destruct(&mat);
+    GeneratorStateExt_destruct(&ext);
+    if (!is_ok) {
+        return 0;
+    }
+    obj->jump_poly = LfsrPoly_jumppoly_ce(&char_poly, 1, log2_dist);
+    LfsrPoly_destruct(&char_poly);
+    return 1;
+}
+
+/**
+ * @brief Moves the generator forward by \f$ 2^d \f$ outputs. Buffered
+ * outputs of GeneratorState are not taken into account, so it should be
+ * applied only to the freshly created generator.
+ */
+void LfsrJump_apply(const LfsrJump *obj, GeneratorState *gen)
+{
+    GeneratorStateExt ext = {.state = *gen, .nbytes = obj->nbytes};
+    GeneratorStateExt_apply_jump_poly(&ext, &obj->jump_poly);
+}
+
+void LfsrJump_destruct(LfsrJump *obj)
+{
+    LfsrPoly_destruct(&obj->jump_poly);
+}
+
 ////////////////////////////////////
 ///// Battery implemenentation /////
 ////////////////////////////////////
@@ -1233,7 +1436,7 @@ LfsrPeriodResult lfsr_period_test(GeneratorStateExt *ext, const CallerAPI *intf,
     LfsrMatrix mat = GeneratorStateExt_get_matrix(ext, 1);
     intf->printf("  LFSR transition matrix layout:\n");
     LfsrMatrix_print(&mat, intf);
-    LfsrPeriodResult result = LfsrMatrix_is_period_possible(&mat, &period) ?
+    LfsrPeriodResult result = LfsrMatrix_is_period_possible(&mat, &period, opts->nthreads) ?
                               LFSR_PERIOD_MAX : LFSR_PERIOD_NOT_MAX;
     if (result == LFSR_PERIOD_MAX) {
         intf->printf("  A^period = I: passed\n");
@@ -1250,7 +1453,7 @@ LfsrPeriodResult lfsr_period_test(GeneratorStateExt *ext, const CallerAPI *intf,
         for (const LargeInt *d = lfsr_exps; !LargeInt_is_u64(d, 0); d++) {
             intf->printf("  Exponent (%4u bits): ", LargeInt_get_nbits(d));
             LargeInt_print_hex(d, intf);
-            LfsrMatrix matd = LfsrMatrix_create_pow(&mat, d);
+            LfsrMatrix matd = LfsrMatrix_create_pow(&mat, d, opts->nthreads);
             if (LfsrMatrix_is_eye(&matd)) {
                 intf->printf(" <<< FAIL\n");
                 result = LFSR_PERIOD_NOT_MAX;
@@ -1278,8 +1481,8 @@ finished:
 BatteryExitCode battery_lfsr_period(const GeneratorInfo *gen, const CallerAPI *intf,
     const BatteryOptions *opts)
 {
-    (void) opts;
-    const LfsrPeriodOptions test_opts = {.check_validity = 1};
+    const LfsrPeriodOptions test_opts = {.check_validity = 1,
+        .nthreads = opts->nthreads};
     if (gen->parent != NULL) {
         intf->printf("  LFSR period checker error: cannot analyze an enveloped generator");
         return BATTERY_ERROR;
@@ -111,26 +111,27 @@ TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts)
     //unsigned int max_nbits = opts->max_nbits;
     const size_t mat_len = n * n / 32;
     size_t min_rank = n + 1;
-    uint32_t *a = calloc(mat_len, sizeof(uint32_t));
+    uint32_t *a = TestArena_calloc(obj->arena, mat_len, sizeof(uint32_t));
+    ASSERT_MALLOC_PTR(a, "matrixrank_test")
     obj->intf->printf("Matrix rank test\n");
     obj->intf->printf("  n = %d. Number of matrices: %d; max_nbits: %u\n",
         (int) n, nmat, opts->max_nbits);
     for (int i = 0; i < nmat; i++) {
         if (opts->max_nbits == 8) {
             for (size_t j = 0; j < mat_len; j++) {
-                const uint32_t u0 = (uint32_t) obj->gi->get_bits(obj->state) & 0xFF;
-                const uint32_t u1 = (uint32_t) obj->gi->get_bits(obj->state) & 0xFF;
-                const uint32_t u2 = (uint32_t) obj->gi->get_bits(obj->state) & 0xFF;
-                const uint32_t u3 = (uint32_t) obj->gi->get_bits(obj->state) & 0xFF;
+                const uint32_t u0 = (uint32_t) GeneratorState_get_bits(obj) & 0xFF;
+                const uint32_t u1 = (uint32_t) GeneratorState_get_bits(obj) & 0xFF;
+                const uint32_t u2 = (uint32_t) GeneratorState_get_bits(obj) & 0xFF;
+                const uint32_t u3 = (uint32_t) GeneratorState_get_bits(obj) & 0xFF;
                 a[j] = u0 | (u1 << 8) | (u2 << 16) | (u3 << 24);
             }
         } else if (obj->gi->nbits == 32) {
             for (size_t j = 0; j < mat_len; j++) {
-                a[j] = (uint32_t) obj->gi->get_bits(obj->state);
+                a[j] = (uint32_t) GeneratorState_get_bits(obj);
             }
         } else if (obj->gi->nbits == 64) {
             for (size_t j = 0, pos = 0; j < mat_len / 2; j++) {
-                const uint64_t u = obj->gi->get_bits(obj->state);
+                const uint64_t u = GeneratorState_get_bits(obj);
                 a[pos++] = (uint32_t) (u & 0xFFFFFFFF);
                 a[pos++] = (uint32_t) (u >> 32);
             }
@@ -140,6 +141,7 @@ TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts)
                 (int) obj->gi->nbits,
                 (int) opts->max_nbits
             );
+            TestArena_free(obj->arena, a);
             return ans;
         }
         // Calculate matrix rank
@@ -153,7 +155,7 @@ TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts)
             min_rank = rank;
         }
     }
-    free(a);
+    TestArena_free(obj->arena, a);
     // Computation of p-value
     obj->intf->printf("  %5s %10s %10s\n", "rank", "Oi", "Ei");
     ans.x = 0.0;
@@ -177,51 +179,107 @@ TestResults matrixrank_test(GeneratorState *obj, const MatrixRankOptions *opts)
 
 
 /**
- * @brief Performs the a[i] ^= b[i] operation for the given vectors.
- * @param a    This vector (a) will be modified.
- * @param b    This vector (b) will not be modified.
- * @param len  Vectors lengths.
+ * @brief Loads 64 bits from the packed bit array starting from the
+ * arbitrary bit position `pos`. The array must contain at least one
+ * extra word after the last used one.
  */
-static inline void xorbytes(uint8_t *a, const uint8_t *b, size_t len)
+static inline uint64_t load_bits64(const uint64_t *a, size_t pos)
 {
-    for (size_t i = 0; i < len; i++) {
-        a[i] ^= b[i];
+    size_t w = pos / 64;
+    unsigned int sh = (unsigned int) (pos % 64);
+    if (sh == 0) {
+        return a[w];
+    } else {
+        return (a[w] >> sh) | (a[w + 1] << (64 - sh));
+    }
+}
+
+/**
+ * @brief Performs the a ^= (b << shift) operation for the packed bit
+ * vectors, i.e. XORs the first `b_nbits` bits of `b` into `a` starting
+ * from the `shift` bit position.
+ * @param a        This vector (a) will be modified, must contain at least
+ *                 `(shift + b_nbits) / 64 + 2` words.
+ * @param b        This vector (b) will not be modified.
+ * @param b_nbits  Number of bits in b that should be used.
+ * @param shift    Shift in bits.
+ */
+static inline void xorbits_shifted(uint64_t *a, const uint64_t *b,
+    size_t b_nbits, size_t shift)
+{
+    size_t nw = (b_nbits + 63) / 64, ws = shift / 64;
+    unsigned int sh = (unsigned int) (shift % 64);
+    uint64_t *a_ws = a + ws;
+    if (sh == 0) {
+        for (size_t i = 0; i < nw; i++) {
+            a_ws[i] ^= b[i];
+        }
+    } else {
+        for (size_t i = 0; i < nw; i++) {
+            a_ws[i] ^= b[i] << sh;
+            a_ws[i + 1] ^= b[i] >> (64 - sh);
+        }
     }
 }
 
 /**
  * @brief Berlekamp-Massey algorithm for computation of linear complexity
  * of bit sequence.
- * @param s Bit sequence, each byte corresponds to ONE bit.
- * @param n Number of bits (length of s array).
+ * @details Works with packed bit vectors, i.e. the sequence and the
+ * polynomials coefficients are stored as 64 bits per word. It allows to
+ * compute the discrepancy by AND + XOR operations for 64 coefficients
+ * at once and the single popcount at the end. To make it possible the
+ * sequence is stored in the reversed order: then \f$ s_{N - i} \f$ for
+ * \f$ i = 0, \ldots, L \f$ become a contiguous ascending range of bits.
+ * It gives about 64x speedup in comparison with the byte-per-bit version
+ * and 8x reduction of memory consumption.
+ *
+ * @param s Bit sequence, packed as 64 bits per word: the i-th bit is
+ * the `(i % 64)`-th bit of the `s[i / 64]` word.
+ * @param n Number of bits.
  * @return Linear complexity.
  */
-size_t berlekamp_massey(const uint8_t *s, size_t n)
+size_t berlekamp_massey(const uint64_t *s, size_t n)
 {
     size_t L = 0; // Complexity
     size_t N = 0; // Current position
-    long m = -1;
-    uint8_t *C = calloc(n, sizeof(uint8_t)); // Coeffs.
-    uint8_t *B = calloc(n, sizeof(uint8_t)); // Prev.coeffs.
-    uint8_t *T = calloc(n, sizeof(uint8_t)); // Temp. copy of coeffs.
-    if (C == NULL || B == NULL || T == NULL) {
+    size_t m = 0; // Position of the last L change
+    size_t L_B = 0; // Degree of B polynomial
+    const size_t nw = n / 64 + 3; // Size of arrays (with sentinels)
+    uint64_t *C = calloc(nw, sizeof(uint64_t)); // Coeffs.
+    uint64_t *B = calloc(nw, sizeof(uint64_t)); // Prev.coeffs.
+    uint64_t *T = calloc(nw, sizeof(uint64_t)); // Temp. copy of coeffs.
+    uint64_t *r = calloc(nw, sizeof(uint64_t)); // Reversed sequence.
+    if (C == NULL || B == NULL || T == NULL || r == NULL) {
         fprintf(stderr, "***** berlekamp_massey: not enough memory *****");
-        free(C); free(B); free(T);
+        free(C); free(B); free(T); free(r);
         exit(EXIT_FAILURE);
     }
+    // r[n - 1 - i] = s[i]
+    for (size_t i = 0; i < n; i++) {
+        if ((s[i / 64] >> (i % 64)) & 1) {
+            size_t j = n - 1 - i;
+            r[j / 64] |= 1ull << (j % 64);
+        }
+    }
     C[0] = 1; B[0] = 1;
     while (N < n) {
-        uint8_t d = s[N];
-        for (size_t i = 1; i <= L; i++) {
-            d ^= C[i] & s[N - i];
+        // d = sum_{i=0}^{L} C[i] s[N - i] = sum_{i=0}^{L} C[i] r[n - 1 - N + i]
+        const size_t r_offset = n - 1 - N, L_nw = L / 64 + 1;
+        uint64_t dw = 0;
+        for (size_t i = 0; i < L_nw; i++) {
+            dw ^= C[i] & load_bits64(r, r_offset + 64 * i);
         }
-        if (d == 1) {
-            memcpy(T, C, (L + 1) * sizeof(uint8_t));
-            xorbytes(&C[(long) N - m], B, (size_t) ((long) n - (long) N + m));
+        if (get_uint64_hamming_weight(dw) & 1) {
+            // m is N + 1 only before the first L change, i.e. when B = 1
+            size_t shift = (L == 0) ? (N + 1) : (N - m);
+            memcpy(T, C, L_nw * sizeof(uint64_t));
+            xorbits_shifted(C, B, L_B + 1, shift);
             if (2*L <= N) {
+                L_B = L;
                 L = N + 1 - L;
-                m = (long) N;
-                memcpy(B, T, (L + 1) * sizeof(uint8_t));
+                m = N;
+                memcpy(B, T, (L_B / 64 + 1) * sizeof(uint64_t));
             }
         }
         N++;
@@ -229,6 +287,7 @@ size_t berlekamp_massey(const uint8_t *s, size_t n)
     free(C);
     free(B);
     free(T);
+    free(r);
     return L;
 }
 
@@ -303,7 +362,7 @@ TestResults linearcomp_test(GeneratorState *obj, const LinearCompOptions *opts)
 {
     TestResults ans = TestResults_create("linearcomp");
     unsigned int bitpos = linearcomp_get_bitpos(obj, opts);
-    uint8_t *s = calloc(opts->nbits, sizeof(uint8_t));
+    uint64_t *s = calloc(opts->nbits / 64 + 1, sizeof(uint64_t));
     if (s == NULL) {
         fprintf(stderr, "***** linearcomp_test: not enough memory *****\n");
         exit(EXIT_FAILURE);
@@ -313,8 +372,8 @@ TestResults linearcomp_test(GeneratorState *obj, const LinearCompOptions *opts)
         (long long) opts->nbits, (int) bitpos);
     uint64_t mask = 1ull << bitpos;
     for (size_t i = 0; i < opts->nbits; i++) {
-        if (obj->gi->get_bits(obj->state) & mask)
-            s[i] = 1;
+        if (GeneratorState_get_bits(obj) & mask)
+            s[i / 64] |= 1ull << (i % 64);
     }
     ans.x = (double) berlekamp_massey(s, opts->nbits);
     double T;
@@ -346,3 +405,20 @@ TestResults matrixrank_test_wrap(GeneratorState *obj, const void *udata)
 {
     return matrixrank_test(obj, udata);
 }
+
+///////////////////////////////////////////////////////
+///// Memory estimations for the tests dispatcher /////
+///////////////////////////////////////////////////////
+
+/**
+ * @brief Estimated peak memory consumption of the matrix rank test, bytes.
+ */
+static size_t matrixrank_test_memory(const void *udata)
+{
+    const MatrixRankOptions *opts = udata;
+    return opts->n * opts->n / 8 + opts->n * sizeof(uint32_t *);
+}
+
+const TestTraits matrixrank_test_traits = {
+    .memory = matrixrank_test_memory
+};
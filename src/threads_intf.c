@@ -12,6 +12,9 @@
 #undef __STRICT_ANSI__
 #include <io.h>
 #endif
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // For sched_getaffinity and pthread_setaffinity_np
+#endif
 #include <fcntl.h>
 
 #include "smokerand/threads_intf.h"
@@ -20,20 +23,111 @@
 #include <string.h>
 #include <stdint.h>
 
-#define NTHREADS_MAX 256
+#if defined(__linux__) && defined(USE_PTHREADS)
+    #include <sched.h>
+    #if defined(CPU_SETSIZE) && defined(CPU_COUNT)
+    #define USE_SCHED_AFFINITY
+    #endif
+#endif
 
 #define THREAD_ID_UNKNOWN 0
 #define THREAD_ORD_UNKNOWN 0
 
-static ThreadObj threads[NTHREADS_MAX];
-static int nthreads = 0;
-DECLARE_MUTEX(thread_ord_mutex)
+/// Ordinal of the current thread, set before the thread function is called.
+static THREAD_LOCAL unsigned int current_thread_ord = THREAD_ORD_UNKNOWN;
+/// 1 for threads created by ThreadObj_create.
+static THREAD_LOCAL int current_thread_exists = 0;
+/// Called by threads after their thread functions (NULL - not used).
+static ThreadExitFuncPtr thread_exit_handler = NULL;
+
+#ifdef USE_SCHED_AFFINITY
+/// CPUs allowed for the process, saved before pinning of the first thread.
+static cpu_set_t process_cpus;
+/// 1 - `process_cpus` is saved.
+static int process_cpus_saved = 0;
+static pthread_once_t process_cpus_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Saves CPUs allowed for the process. Must be called before pinning
+ * of any thread: new threads inherit the affinity of the creating thread,
+ * so the mask of a pinned thread is not the process one.
+ */
+static void save_process_cpus(void)
+{
+    if (sched_getaffinity(0, sizeof(process_cpus), &process_cpus) == 0 &&
+        CPU_COUNT(&process_cpus) > 0) {
+        process_cpus_saved = 1;
+    }
+}
+#endif
+
+/**
+ * @brief Allows the current thread to run on all CPUs of the process.
+ * @details Used by helper threads: on Linux they inherit the affinity
+ * of the creating worker and would share its only CPU if the worker
+ * is pinned by pin_current_thread.
+ */
+static void unpin_current_thread(void)
+{
+#ifdef USE_SCHED_AFFINITY
+    (void) pthread_once(&process_cpus_once, save_process_cpus);
+    if (process_cpus_saved) {
+        (void) pthread_setaffinity_np(pthread_self(), sizeof(process_cpus), &process_cpus);
+    }
+#endif
+}
 
 
+/**
+ * @brief Initializes the threads dispatcher. Ordinals are kept in the
+ * thread-local storage, so nothing has to be done now.
+ */
 void init_thread_dispatcher(void)
 {
-    INIT_MUTEX(thread_ord_mutex);
-    nthreads = 0;
+}
+
+/**
+ * @brief Thread function and its arguments for the thread_start trampoline.
+ */
+typedef struct {
+    ThreadFuncPtr thr_func; ///< Thread function
+    void *udata; ///< User data for the thread function
+    unsigned int ord; ///< Thread ordinal
+} ThreadStartInfo;
+
+/**
+ * @brief Sets the ordinal of the new thread and calls the thread function.
+ * @details The ordinal is kept in the thread-local storage, so it is
+ * available before the first line of the thread function is executed and
+ * ThreadObj_current doesn't need any global registry or mutex.
+ */
+static ThreadRetVal THREADFUNC_SPEC thread_start(void *data)
+{
+    const ThreadStartInfo info = *(ThreadStartInfo *) data;
+    free(data);
+    current_thread_ord = info.ord;
+    current_thread_exists = 1;
+    if (info.ord >= THREAD_ORD_HELPER) {
+        unpin_current_thread();
+    }
+    const ThreadRetVal ans = info.thr_func(info.udata);
+    if (thread_exit_handler != NULL) {
+        thread_exit_handler(info.ord);
+    }
+    return ans;
+}
+
+/**
+ * @brief Sets the function that is called by each thread created by
+ * ThreadObj_create after its thread function returns. The function gets
+ * the ordinal of the finishing thread and is called from that thread.
+ * @details Must be set when there are no running threads, e.g. used by
+ * data sources that must know when their consumers finish.
+ * @param handler  Exit handler (NULL - turn off).
+ */
+void ThreadObj_set_exit_handler(ThreadExitFuncPtr handler)
+{
+    thread_exit_handler = handler;
 }
 
 /**
@@ -47,21 +141,27 @@ ThreadObj ThreadObj_create(ThreadFuncPtr thr_func, void *udata, unsigned int ord
     ThreadObj obj;
     obj.ord = ord;
     obj.exists = 1;
+    ThreadStartInfo *info = malloc(sizeof(ThreadStartInfo));
+    if (info == NULL) {
+        fprintf(stderr, "***** ThreadObj_create: not enough memory *****\n");
+        exit(EXIT_FAILURE);
+    }
+    info->thr_func = thr_func;
+    info->udata = udata;
+    info->ord = ord;
 #ifdef USE_PTHREADS
-    pthread_create(&obj.id, NULL, thr_func, udata);
-    // Get data from threads
+    pthread_create(&obj.id, NULL, thread_start, info);
 #elif defined(USE_WINTHREADS)
-    obj.handle = CreateThread(NULL, 0, thr_func, udata, 0, &obj.id);
+    obj.handle = CreateThread(NULL, 0, thread_start, info, 0, &obj.id);
 #else
+    // The "thread" is executed synchronously: restore the caller ordinal
+    const unsigned int ord_saved = current_thread_ord;
+    const int exists_saved = current_thread_exists;
     obj.id = ord;
-    thr_func(udata);
+    (void) thread_start(info);
+    current_thread_ord = ord_saved;
+    current_thread_exists = exists_saved;
 #endif
-
-    MUTEX_LOCK(thread_ord_mutex, "ThreadObj_create");
-    if (nthreads < NTHREADS_MAX) {
-        threads[nthreads++] = obj;
-    }
-    MUTEX_UNLOCK(thread_ord_mutex);
     return obj;
 }
 
@@ -86,14 +186,8 @@ void ThreadObj_wait(ThreadObj *obj)
     pthread_join(obj->id, NULL);
 #elif defined(USE_WINTHREADS)
     WaitForSingleObject(obj->handle, INFINITE);
-#else
-    (void) obj;
 #endif
-    for (int i = 0; i < nthreads; i++) {
-        if (ThreadObj_equal(obj, &threads[i]) && threads[i].exists) {
-            threads[i].exists = 0;
-        }
-    }
+    obj->exists = 0;
 }
 
 /**
@@ -109,15 +203,85 @@ ThreadObj ThreadObj_current(void)
 #else
     obj.id = THREAD_ID_UNKNOWN;
 #endif
-    for (int i = 0; i < nthreads; i++) {
-        if (ThreadObj_equal(&obj, &threads[i]) && threads[i].exists) {
-            return threads[i];
-        }
-    }
-    obj.ord = THREAD_ORD_UNKNOWN;
+    obj.ord = current_thread_ord;
+    obj.exists = current_thread_exists;
     return obj;
 }
 
+/**
+ * @brief Initializes the counting semaphore.
+ * @details Without multithreading API the semaphore is just a counter:
+ * waiting for the zero counter is an error.
+ */
+void Semaphore_init(Semaphore *obj, unsigned int value)
+{
+#ifdef USE_PTHREADS
+    pthread_mutex_init(&obj->mutex, NULL);
+    pthread_cond_init(&obj->cond, NULL);
+    obj->value = value;
+#elif defined(USE_WINTHREADS)
+    obj->handle = CreateSemaphore(NULL, (LONG) value, 0x7FFFFFFF, NULL);
+    if (obj->handle == NULL) {
+        fprintf(stderr, "***** Semaphore_init: cannot create semaphore *****\n");
+        exit(EXIT_FAILURE);
+    }
+#else
+    obj->value = value;
+#endif
+}
+
+/**
+ * @brief Decrements the semaphore counter, waits if it is zero.
+ */
+void Semaphore_wait(Semaphore *obj)
+{
+#ifdef USE_PTHREADS
+    pthread_mutex_lock(&obj->mutex);
+    while (obj->value == 0) {
+        pthread_cond_wait(&obj->cond, &obj->mutex);
+    }
+    obj->value--;
+    pthread_mutex_unlock(&obj->mutex);
+#elif defined(USE_WINTHREADS)
+    WaitForSingleObject(obj->handle, INFINITE);
+#else
+    if (obj->value == 0) {
+        fprintf(stderr, "***** Semaphore_wait: deadlock *****\n");
+        exit(EXIT_FAILURE);
+    }
+    obj->value--;
+#endif
+}
+
+/**
+ * @brief Increments the semaphore counter and wakes up one of waiting threads.
+ */
+void Semaphore_post(Semaphore *obj)
+{
+#ifdef USE_PTHREADS
+    pthread_mutex_lock(&obj->mutex);
+    obj->value++;
+    pthread_cond_signal(&obj->cond);
+    pthread_mutex_unlock(&obj->mutex);
+#elif defined(USE_WINTHREADS)
+    ReleaseSemaphore(obj->handle, 1, NULL);
+#else
+    obj->value++;
+#endif
+}
+
+void Semaphore_destruct(Semaphore *obj)
+{
+#ifdef USE_PTHREADS
+    pthread_cond_destroy(&obj->cond);
+    pthread_mutex_destroy(&obj->mutex);
+#elif defined(USE_WINTHREADS)
+    CloseHandle(obj->handle);
+#else
+    (void) obj;
+#endif
+}
+
 //-------------------------------------------------------------
 
 // Uncomment if you want to use PE32 loader instead of DXE3 loader in DJGPP
@@ -140,6 +304,13 @@ ThreadObj ThreadObj_current(void)
     #include <dos.h>
 #endif
 
+#if defined(__linux__) && !defined(USE_LOADLIBRARY)
+    #include <sys/mman.h>
+    #if defined(MAP_ANONYMOUS)
+    #define USE_MMAP_PAGES
+    #endif
+#endif
+
 
 void *dlopen_wrap(const char *libname)
 {
@@ -241,6 +412,119 @@ unsigned int get_cpu_numcores(void)
 #endif
 }
 
+#ifdef USE_SCHED_AFFINITY
+/**
+ * @brief Logical CPU and its position inside its NUMA node.
+ */
+typedef struct {
+    int cpu; ///< Logical CPU index
+    int node; ///< NUMA node (-1 if unknown)
+    int rank; ///< Position of CPU inside its NUMA node
+} CpuSlot;
+
+/**
+ * @brief Comparator for interleaving CPUs between NUMA nodes.
+ */
+static int CpuSlot_cmp(const void *aptr, const void *bptr)
+{
+    const CpuSlot *a = aptr, *b = bptr;
+    if (a->rank != b->rank) {
+        return (a->rank > b->rank) - (a->rank < b->rank);
+    } else if (a->node != b->node) {
+        return (a->node > b->node) - (a->node < b->node);
+    } else {
+        return (a->cpu > b->cpu) - (a->cpu < b->cpu);
+    }
+}
+
+/**
+ * @brief Returns NUMA node of the logical CPU (-1 if unknown). Uses sysfs:
+ * each `/sys/devices/system/cpu/cpuN` directory contains a link to its node.
+ */
+static int get_cpu_numa_node(int cpu)
+{
+    enum { NNODES_MAX = 64 };
+    char path[64];
+    for (int node = 0; node < NNODES_MAX; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (access(path, F_OK) == 0) {
+            return node;
+        }
+    }
+    return -1;
+}
+#endif
+
+/**
+ * @brief Pins the current thread to the logical CPU selected by the worker
+ * index. CPUs allowed for the process (saved before the first pinning)
+ * are interleaved between NUMA nodes: 0th CPU of node 0, 0th CPU of
+ * node 1, ..., 1st CPU of node 0 etc., so the memory bandwidth of all
+ * nodes is used even with a few threads.
+ * @details Memory allocated and touched by the thread after pinning is
+ * usually placed by OS on the local NUMA node (first-touch policy).
+ * @param[in]  ind  Worker index (0-based), taken modulo number of CPUs.
+ * @param[out] pl   Placement of the thread (CPU and NUMA node, -1 - unknown).
+ * @return 1 - success, 0 - pinning is not supported or failed.
+ */
+int pin_current_thread(unsigned int ind, ThreadPlacement *pl)
+{
+    pl->cpu = -1;
+    pl->node = -1;
+#if defined(USE_SCHED_AFFINITY)
+    (void) pthread_once(&process_cpus_once, save_process_cpus);
+    if (!process_cpus_saved) {
+        return 0;
+    }
+    cpu_set_t set = process_cpus;
+    CpuSlot *slots = calloc((size_t) CPU_COUNT(&set), sizeof(CpuSlot));
+    if (slots == NULL) {
+        return 0;
+    }
+    size_t nslots = 0;
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &set)) {
+            continue;
+        }
+        slots[nslots].cpu = (int) cpu;
+        slots[nslots].node = get_cpu_numa_node((int) cpu);
+        slots[nslots].rank = 0;
+        for (size_t i = 0; i < nslots; i++) {
+            slots[nslots].rank += (slots[i].node == slots[nslots].node);
+        }
+        nslots++;
+    }
+    qsort(slots, nslots, sizeof(CpuSlot), CpuSlot_cmp);
+    const CpuSlot *sel = &slots[ind % nslots];
+    pl->cpu = sel->cpu;
+    pl->node = sel->node;
+    free(slots);
+    CPU_ZERO(&set);
+    CPU_SET((size_t) pl->cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        pl->cpu = -1;
+        pl->node = -1;
+        return 0;
+    }
+    return 1;
+#elif defined(USE_LOADLIBRARY)
+    const unsigned int nbits = (unsigned int) (sizeof(DWORD_PTR) * 8);
+    unsigned int ncores = get_cpu_numcores();
+    if (ncores > nbits) {
+        ncores = nbits;
+    }
+    const unsigned int cpu = ind % ncores;
+    if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << cpu) == 0) {
+        return 0;
+    }
+    pl->cpu = (int) cpu;
+    return 1;
+#else
+    (void) ind;
+    return 0;
+#endif
+}
+
 ///////////////////////////////////////////////////
 ///// Functions for stdin/stdio modes control /////
 ///////////////////////////////////////////////////
@@ -373,3 +657,69 @@ int get_ram_info(RamInfo *info)
     return 0; // Failure
 #endif
 }
+
+/**
+ * @brief Allocates a large memory block directly from the OS and asks it
+ * to back the block with huge pages: explicit huge pages are tried first,
+ * then transparent huge pages (Linux) are requested. Other platforms
+ * use `malloc` without huge pages.
+ * @param[in]  len      Block size in bytes, should be a multiple of
+ *                      LARGE_PAGE_SIZE.
+ * @param[out] is_huge  1 if the huge pages request was accepted.
+ * @return Pointer to the block or NULL. Must be freed by large_pages_free.
+ */
+void *large_pages_alloc(size_t len, int *is_huge)
+{
+    *is_huge = 0;
+#ifdef USE_LOADLIBRARY
+    const SIZE_T large_page_len = GetLargePageMinimum();
+    if (large_page_len != 0 && len % large_page_len == 0) {
+        void *ptr = VirtualAlloc(NULL, len,
+            MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (ptr != NULL) {
+            *is_huge = 1;
+            return ptr;
+        }
+    }
+    return VirtualAlloc(NULL, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(USE_MMAP_PAGES)
+    void *ptr;
+#ifdef MAP_HUGETLB
+    ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        *is_huge = 1;
+        return ptr;
+    }
+#endif
+    ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    *is_huge = (madvise(ptr, len, MADV_HUGEPAGE) == 0);
+#endif
+    return ptr;
+#else
+    return malloc(len);
+#endif
+}
+
+/**
+ * @brief Frees the memory block allocated by large_pages_alloc.
+ */
+void large_pages_free(void *ptr, size_t len)
+{
+    if (ptr == NULL) {
+        return;
+    }
+#ifdef USE_LOADLIBRARY
+    (void) len;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(USE_MMAP_PAGES)
+    munmap(ptr, len);
+#else
+    (void) len;
+    free(ptr);
+#endif
+}